@@ -63,8 +63,51 @@ namespace Config {
     bool drawMesh{};
     int solveIterations = 5;
     float frictionCoeff = 0.5f;
+    //Solve independent constraint rows a SIMD gang at a time instead of one by one
+    //Off by default until the scene benchmark in SolverTest shows it ahead of the scalar solver on target hardware
+    bool wideSolver = false;
+    //Pairs whose relative transform moved less than this since their manifold was generated re-project the previous manifold
+    //instead of regenerating it. Zero disables reuse
+    float manifoldReuseTolerance = 0.001f;
+
+    struct Sleep {
+      //Islands whose bodies all stay below this speed for this many frames stop being solved. Zero frames disables sleeping
+      //Any velocity written to a sleeping body or moving it directly wakes its island
+      float velocity = 0.002f;
+      size_t frames = 0;
+    };
+    Sleep sleep;
+
+    struct LOD {
+      //Bodies further than these distances from every region of interest are stepped every reducedInterval ticks or frozen
+      //Off by default so all bodies are simulated at the full rate
+      bool enabled{};
+      float reducedDistance = 60.0f;
+      float frozenDistance = 120.0f;
+      size_t reducedInterval = 4;
+    };
+    LOD lod;
 
     struct Broadphase {
+      enum class Type : uint8_t {
+        //Fixed grid of sweep and prune cells defined by the values below
+        SweepGrid,
+        //Dynamic tree that adapts to any scene extent
+        AABBTree
+      };
+      //Read upon physics init, changing it afterwards has no effect
+      Type type{ Type::SweepGrid };
+      //Distance the tree's leaf bounds are extended by so small movements don't need to update the tree
+      float treeMargin = 0.5f;
+      //Grid bounds are extended by the margin plus a prediction of the movement and only updated once objects escape them
+      //Fewer bounds updates means less sorting and pair churn at the cost of more pairs for narrowphase
+      //Off by default so pairs exactly match object bounds
+      float gridMargin = 0.0f;
+      float gridPredictionFrames = 0.0f;
+      float gridMaxPrediction = 1.0f;
+      //Grid cells sort inline copies of the bounds and scan them with SIMD instead of sorting indirect sweep elements
+      //Read upon physics init like type
+      bool gridSoA{};
       float bottomLeftX = -200.0f;
       float bottomLeftY = -200.0f;
       float cellSizeX = 20.0f;
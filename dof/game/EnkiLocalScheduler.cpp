@@ -17,6 +17,10 @@ namespace Tasks {
   struct LocalTask : enki::TaskSet {
     using enki::TaskSet::TaskSet;
     LocalTask* next{};
+    //Tasks that must finish before this one starts, used to count them as awaited along with this
+    std::vector<LocalTask*> dependencies;
+    std::vector<OwnedDependency> enkiDependencies;
+    bool awaited{};
   };
   struct EnkiScheduler : ILocalScheduler {
     EnkiScheduler(SchedulerArgs& s)
@@ -38,20 +42,67 @@ namespace Tasks {
         set.m_SetSize = static_cast<uint32_t>(size.workItemCount);
       }
       set.m_Function = [cb{std::move(task)}, this](enki::TaskSetPartition partition, uint32_t thread) {
+        TRACE_SCOPE("scheduler", "local task");
         GameTaskArgs gta{ partition, args.getTLS ? args.getTLS(thread) : ThreadLocalData{}, thread };
         cb(gta);
       };
     }
 
-    TaskHandle queueTask(TaskCallback&& task, const AppTaskSize& size) final {
+    LocalTask& addTask(TaskCallback&& task, const AppTaskSize& size) {
       tasks.emplace_back();
       auto& t = tasks.back();
       initTaskSet(t, std::move(task), size);
       ++tasksRemaining;
+      return t;
+    }
+
+    TaskHandle queueTask(TaskCallback&& task, const AppTaskSize& size) final {
+      LocalTask& t = addTask(std::move(task), size);
       args.scheduler.mScheduler.AddTaskSetToPipe(&t);
       return wrap(t);
     }
 
+    TaskHandle createTask(TaskCallback&& task, const AppTaskSize& size) final {
+      return wrap(addTask(std::move(task), size));
+    }
+
+    TaskHandle createContinuation(const TaskHandle* dependencies, size_t count, TaskCallback&& task, const AppTaskSize& size) final {
+      LocalTask& t = addTask(std::move(task), size);
+      t.dependencies.resize(count);
+      t.enkiDependencies.resize(count);
+      for(size_t i = 0; i < count; ++i) {
+        LocalTask& dependency = unwrap(dependencies[i]);
+        //Enki requires dependencies to be set before the tasks are added to the pipe
+        assert(dependency.GetIsComplete() && "Continuations can only be added to tasks that haven't started");
+        t.dependencies[i] = &dependency;
+        t.enkiDependencies[i] = std::make_unique<enki::Dependency>();
+        t.enkiDependencies[i]->SetDependency(&dependency, &t);
+      }
+      //Enki launches the task itself once all dependencies complete
+      return wrap(t);
+    }
+
+    void startTasks(const TaskHandle* toStart, size_t count) final {
+      for(size_t i = 0; i < count; ++i) {
+        LocalTask& t = unwrap(toStart[i]);
+        assert(t.dependencies.empty() && "Continuations start when their dependencies complete");
+        args.scheduler.mScheduler.AddTaskSetToPipe(&t);
+      }
+    }
+
+    //Completion of a task implies completion of its dependencies, so mark the entire chain as awaited
+    size_t markAwaited(LocalTask& task) {
+      if(task.awaited) {
+        return 0;
+      }
+      task.awaited = true;
+      size_t result = 1;
+      for(LocalTask* dependency : task.dependencies) {
+        result += markAwaited(*dependency);
+      }
+      return result;
+    }
+
     void linkTasks(TaskHandle from, TaskHandle to, const LinkOptions&) final {
       assert(unwrap(from).next == nullptr);
       unwrap(from).next = &unwrap(to);
@@ -64,8 +115,8 @@ namespace Tasks {
         LocalTask* current = &unwrap(toAwait[i]);
         while(current) {
           args.scheduler.mScheduler.WaitforTask(current);
+          tasksFinished += markAwaited(*current);
           current = current->next;
-          ++tasksFinished;
         }
       }
       //Keep count of remaining then clear the list when it hits zero
@@ -83,14 +83,12 @@ namespace SM {
     static void onEnter(IAppBuilder& builder, const TableID& table, size_t bucket) {
       auto task = builder.createTask();
       task.setName("enter wander");
-      auto spatialQuery = SpatialQuery::createCreator(task);
       auto query = task.query<const GlobalsRow, StateRow>(table);
-      task.setCallback([query, bucket, spatialQuery](AppTaskArgs& args) mutable {
+      task.setCallback([query, bucket](AppTaskArgs& args) mutable {
         auto&& [globals, state] = query.get(0);
         IRandom* random = args.getRandom();
         for(size_t i : globals->at().buckets[bucket].entering) {
           Wander& wander = std::get<Wander>(state->at(i).currentState);
-          wander.spatialQuery = spatialQuery->createQuery({ SpatialQuery::AABB{} }, 2);
           wander.desiredDirection = random->nextDirection();
         }
       });
@@ -110,15 +108,17 @@ namespace SM {
     //Gather a vague idea of the obstructions through the contact points. This will vary in accuracy depending on what type of collision it is
     static void buildObstacles(
       std::vector<Clip::StartAndDir>& buffer,
-      SpatialQuery::IReader& spatialQueryR,
+      std::vector<SpatialQuery::Result>& results,
+      SpatialQuery::IImmediate& spatialQuery,
       const Wander& wander,
       const ElementRef& self,
       const glm::vec2& queryPos) {
-      spatialQueryR.begin(wander.spatialQuery);
+      results.clear();
+      spatialQuery.overlap(computeQueryVolume(queryPos, wander.desiredDirection), Narrowphase::CollisionMask(~0), results);
       buffer.clear();
       //Gather a vague idea of the obstructions through the contact points. This will vary in accuracy depending on what type of collision it is
-      while(const SpatialQuery::Result* q = spatialQueryR.tryIterate()) {
-        if(auto contact = std::get_if<SpatialQuery::ContactXY>(&q->contact); q->other != self && contact && contact->points.size() >= 2) {
+      for(const SpatialQuery::Result& q : results) {
+        if(auto contact = std::get_if<SpatialQuery::ContactXY>(&q.contact); q.other != self && contact && contact->points.size() >= 2) {
           Clip::StartAndDir obstacle{ .start{ contact->points[0].point } };
           obstacle.dir = contact->points[1].point - obstacle.start;
           obstacle.start += queryPos;
@@ -179,23 +179,21 @@ namespace SM {
         Constraints::JointRow,
         const Transform::WorldTransformRow
       >(table);
-      auto spatialQueryR = SpatialQuery::createReader(task);
-      auto spatialQueryW = SpatialQuery::createWriter(task);
+      auto spatialQuery = SpatialQuery::createImmediate(task);
       auto bodyResolver = PhysicsSimulation::createPhysicsBodyResolver(task);
       auto ids = task.getIDResolver();
 
-      task.setCallback([ids, query, spatialQueryR, spatialQueryW, bucket, bodyResolver](AppTaskArgs&) mutable {
+      task.setCallback([ids, query, spatialQuery, bucket, bodyResolver](AppTaskArgs&) mutable {
         auto&& [globals, state, stableRow, joints, transforms] = query.get(0);
+        std::vector<SpatialQuery::Result> results;
+        std::vector<Clip::StartAndDir> obstacles;
         for(size_t si : globals->at().buckets[bucket].updating) {
           const Transform::PackedTransform& pt = transforms->at(si);
           const ElementRef stableID = stableRow->at(si);
           const glm::vec2 pos = pt.pos2();
 
           Wander& wander = std::get<Wander>(state->at(si).currentState);
-          spatialQueryR->begin(wander.spatialQuery);
-
-          std::vector<Clip::StartAndDir> obstacles;
-          buildObstacles(obstacles, *spatialQueryR, wander, stableID, pos);
+          buildObstacles(obstacles, results, *spatialQuery, wander, stableID, pos);
           const std::optional<glm::vec2> unobstructedDir = findUnobstructedDirection(obstacles, pos, wander.desiredDirection);
 
           if(unobstructedDir) {
@@ -214,8 +212,6 @@ namespace SM {
           joint.targetVelocity = wander.desiredDirection * linearSpeed;
 
           joints->at(si) = { joint };
-
-          spatialQueryW->refreshQuery(wander.spatialQuery, { computeQueryVolume(pos, wander.desiredDirection) }, 2);
         }
       });
       builder.submitTask(std::move(task));
@@ -232,7 +228,7 @@ namespace SM {
         const StableIDRow,
         const Transform::WorldTransformRow
       >(table);
-      auto spatialQuery = SpatialQuery::createReader(task);
+      auto spatialQuery = SpatialQuery::createImmediate(task);
       auto debug = TableAdapters::getDebugLines(task);
       const bool* shouldDrawAI = getShouldDrawAI(task);
 
@@ -241,6 +237,7 @@ namespace SM {
           return;
         }
         auto&& [globals, state, stableRow, transforms] = query.get(0);
+        std::vector<SpatialQuery::Result> results;
         for(size_t si : globals->at().buckets[bucket].updating) {
           const Wander& wander = std::get<Wander>(state->at(si).currentState);
           const Transform::PackedTransform& transform = transforms->at(si);
@@ -253,7 +250,7 @@ namespace SM {
           DebugDrawer::drawAABB(debug, volume.min, volume.max, glm::vec3{ 0.5f });
 
           std::vector<Clip::StartAndDir> obstacles;
-          buildObstacles(obstacles, *spatialQuery, wander, myID, myPos);
+          buildObstacles(obstacles, results, *spatialQuery, wander, myID, myPos);
           for(const Clip::StartAndDir& o : obstacles) {
             DebugDrawer::drawLine(debug, o.start, o.start + o.dir, glm::vec3{ 0.5f, 0.1f, 1.f });
           }
@@ -266,7 +263,6 @@ namespace SM {
       builder.submitTask(std::move(task));
     }
 
-    //Cleanup of the query isn't needed because it'll expire after its lifetime
     static void onExit(IAppBuilder&, const TableID&, size_t) {
     }
   };
@@ -424,15 +420,13 @@ namespace SM {
         Narrowphase::CollisionMaskRow,
         StateRow
       >(table);
-      auto spatialQuery = SpatialQuery::createCreator(task);
 
-      task.setCallback([query, bucket, spatialQuery](AppTaskArgs&) mutable {
+      task.setCallback([query, bucket](AppTaskArgs&) mutable {
         auto&& [globals, vx, vy, collisionMask, state] = query.get(0);
 
         for(size_t i : globals->at().buckets[bucket].entering) {
           collisionMask->at(i) = Narrowphase::CollisionMask(0);
           ExitSeekHome& seek = std::get<ExitSeekHome>(state->at(i).currentState);
-          seek.spatialQuery = spatialQuery->createQuery({ SpatialQuery::AABB{ glm::vec2{ 0 }, glm::vec2{ 0 } } }, 2);
           const glm::vec2 v = TableAdapters::read(i, *vx, *vy);
           const float length = glm::length(v);
           constexpr float speed = 0.01f;
@@ -460,15 +454,14 @@ namespace SM {
         Tags::GLinImpulseXRow,
         Tags::GLinImpulseYRow
       >(table);
-      auto resolver = task.getResolver<const StateRow, const SpatialQueriesTableTag>();
+      auto resolver = task.getResolver<const StateRow>();
       auto ids = task.getIDResolver();
 
-      auto spatialQueryW = SpatialQuery::createWriter(task);
-      auto spatialQueryR = SpatialQuery::createReader(task);
-      task.setCallback([query, bucket, spatialQueryR, spatialQueryW, resolver, ids](AppTaskArgs&) mutable {
+      auto spatialQuery = SpatialQuery::createImmediate(task);
+      task.setCallback([query, bucket, spatialQuery, resolver, ids](AppTaskArgs&) mutable {
         auto&& [globals, state, stableRow, transforms, ix, iy] = query.get(0);
         CachedRow<const StateRow> stateLookup;
-        CachedRow<const SpatialQueriesTableTag> spatialQueryLookup;
+        std::vector<SpatialQuery::Result> results;
 
         for(size_t i : globals->at().buckets[bucket].updating) {
           ExitSeekHome& seek = std::get<ExitSeekHome>(state->at(i).currentState);
@@ -477,42 +470,24 @@ namespace SM {
           TableAdapters::add(i, seek.direction, *ix, *iy);
 
           const glm::vec2 myPos = transforms->at(i).pos2();
-          auto key = spatialQueryW->getKey(seek.spatialQuery);
-          if(!key) {
-            //Shouldn't happen
-            continue;
-          }
-
-          //Write the new query position, this doesn't affect  reading the results below
-          SpatialQuery::Query newQuery{ getQueryAABB(myPos) };
-          spatialQueryW->swapQuery(*key, newQuery, 2);
-          //See if the contained query had the initial zero value or a real value. If it was initial, wait until next frame
-          if(auto bb = std::get_if<SpatialQuery::AABB>(&newQuery.shape)) {
-            if(bb->min == glm::vec2{ 0 }) {
-              continue;
-            }
-          }
+          results.clear();
+          spatialQuery->overlap(getQueryAABB(myPos), Narrowphase::CollisionMask(~0), results);
 
           //If there is nothing nearby it's safe to exit the state
-          spatialQueryR->begin(seek.spatialQuery);
           const ElementRef self = stableRow->at(i);
           bool foundObstacle = false;
-          while(auto* r = spatialQueryR->tryIterate()) {
-            if(r->other == self) {
+          for(const SpatialQuery::Result& r : results) {
+            if(r.other == self) {
               continue;
             }
             //Ignore others that are also in this state
             //TODO: this probably makes mores sense to do with collision layers
-            if(auto resolved = ids->getRefResolver().tryUnpack(r->other)) {
+            if(auto resolved = ids->getRefResolver().tryUnpack(r.other)) {
               if(const auto* s = resolver->tryGetOrSwapRowElement(stateLookup, *resolved)) {
                  if(std::get_if<SeekHome>(&s->currentState) || std::get_if<ExitSeekHome>(&s->currentState)) {
                     continue;
                  }
               }
-              //Ignoer other spatial queries
-              if(resolver->tryGetOrSwapRow(spatialQueryLookup, *resolved)) {
-                continue;
-              }
               foundObstacle = true;
               break;
             }
@@ -6,6 +6,8 @@
 #include "AppBuilder.h"
 #include "GameBuilder.h"
 #include "GameScheduler.h"
+#include "GraphViz.h"
+#include "SynchronousTaskReport.h"
 #include "Scheduler.h"
 #include "ThreadLocals.h"
 
@@ -17,16 +19,30 @@ namespace Game {
   struct TaskGraphItem {
     TaskRange mt;
     std::vector<GameScheduler::SyncWorkItem> st;
+    //Only present if timings were requested and the graph is multithreaded
+    std::unique_ptr<GameScheduler::TaskTimings> timings;
   };
   struct TaskGraph {
     TaskGraphItem update;
     TaskGraphItem renderCommit;
   };
 
-  TaskGraphItem createTaskGraphItem(std::shared_ptr<AppTaskNode> appTaskNodes, ThreadLocals* tls) {
+  struct TimingOptions {
+    bool recordTimings{};
+    bool recordSynchronousAccess{};
+  };
+
+  TaskGraphItem createTaskGraphItem(std::shared_ptr<AppTaskNode> appTaskNodes, ThreadLocals* tls, const TimingOptions& ops = {}) {
     if(tls) {
+      std::unique_ptr<GameScheduler::TaskTimings> timings;
+      if(ops.recordTimings || ops.recordSynchronousAccess) {
+        timings = std::make_unique<GameScheduler::TaskTimings>();
+        timings->recordSynchronousAccess = ops.recordSynchronousAccess;
+      }
+      TaskRange range = GameScheduler::buildTasks(std::move(appTaskNodes), *tls, timings.get());
       return TaskGraphItem{
-        .mt = GameScheduler::buildTasks(std::move(appTaskNodes), *tls),
+        .mt = std::move(range),
+        .timings = std::move(timings),
       };
     }
     return TaskGraphItem{
@@ -40,8 +56,14 @@ namespace Game {
 
   void runTask(TaskGraphItem& task, Scheduler* mt) {
     if(mt) {
+      if(task.timings) {
+        task.timings->beginFrame();
+      }
       task.mt.mBegin->mTask.addToPipe(mt->mScheduler);
       mt->mScheduler.WaitforTask(task.mt.mEnd->mTask.get());
+      if(task.timings) {
+        task.timings->endFrame();
+      }
     }
     else {
       for(const auto& t : task.st) {
@@ -149,11 +171,31 @@ namespace Game {
       return GameScheduler::createAppTaskArgs(threading.tls, threadIndex);
     }
 
+    bool writeTaskGraph(const std::string& location) final {
+      const GameScheduler::TaskTimings* timings = graph.update.timings.get();
+      if(!timings || !timings->root) {
+        return false;
+      }
+      GraphViz::writeHere(location, *timings->root, timings);
+      return true;
+    }
+
+    bool writeSynchronousTaskReport(const std::string& location) final {
+      const GameScheduler::TaskTimings* timings = graph.update.timings.get();
+      return timings && SynchronousTaskReport::writeHere(location, *timings, db->getRuntime());
+    }
+
     TaskGraph buildUpdate() {
       std::unique_ptr<IAppBuilder> builder = GameBuilder::create(getDatabase(), buildEnv(AppEnvType::UpdateMain));
 
+      const bool pipelined = args.updateMode == UpdateMode::Pipelined;
       if(args.rendering) {
-        args.rendering->preSimUpdate(*builder);
+        if(pipelined) {
+          args.rendering->preSimDraw(*builder);
+        }
+        else {
+          args.rendering->preSimUpdate(*builder);
+        }
       }
       visitModules(*builder, &IAppModule::update);
 
@@ -163,18 +205,24 @@ namespace Game {
       visitModules(*builder, &IAppModule::clearEvents);
 
       if(args.rendering) {
-        args.rendering->postSimUpdate(*builder);
+        if(pipelined) {
+          //Draw tasks only touch the extracted tables so they can overlap with the simulation above.
+          //Extraction goes last so it waits for both the draw of the previous frame and the simulation of this one
+          args.rendering->postSimDraw(*builder);
+          args.rendering->postSimExtract(*builder);
+        }
+        else {
+          args.rendering->postSimUpdate(*builder);
+        }
       }
 
       std::shared_ptr<AppTaskNode> appTaskNodes = IAppBuilder::finalize(std::move(builder));
-      //TODO: put this back if I care
-      //constexpr bool outputGraph = false;
-      //if(outputGraph && appTaskNodes) {
-      //  GraphViz::writeHere("graph.gv", *appTaskNodes);
-      //}
 
       return TaskGraph{
-        .update = createTaskGraphItem(std::move(appTaskNodes), threading.tls),
+        .update = createTaskGraphItem(std::move(appTaskNodes), threading.tls, TimingOptions{
+          .recordTimings = args.recordTaskTimings,
+          .recordSynchronousAccess = args.recordSynchronousAccess,
+        }),
         .renderCommit = buildRenderUpdate(),
       };
     }
@@ -17,6 +17,11 @@ public:
   virtual void renderOnlyUpdate(IAppBuilder&) {}
   virtual void preSimUpdate(IAppBuilder&) {}
   virtual void postSimUpdate(IAppBuilder&) {}
+  //Used instead of pre and post sim update by Game::UpdateMode::Pipelined
+  //Draws the previously extracted frame in the same graph as the simulation, then extracts the result at the end of it
+  virtual void preSimDraw(IAppBuilder&) {}
+  virtual void postSimDraw(IAppBuilder&) {}
+  virtual void postSimExtract(IAppBuilder&) {}
 };
 
 struct MultithreadedDeps {
@@ -37,6 +42,15 @@ public:
 //The implementation of the game itself is intended to have minimal knowledge of the simulation details, that's the responsibility of the modules
 //Similarly, it shouldn't have knowledge of the contents of its database, although the "defaults" are exposed here for convenience
 namespace Game {
+  enum class UpdateMode : uint8_t {
+    //Extract the simulation state, simulate, and commit the extracted frame, all within one graph
+    Serial,
+    //Draw tasks for the frame extracted last update are ordered before extraction at the end of the same graph.
+    //They only touch the renderer's extracted copy so the scheduler may run them alongside this update's simulation,
+    //but both still finish within the same update call. There is no overlap across update calls
+    Pipelined,
+  };
+
   struct GameArgs {
     GameArgs();
     GameArgs(GameArgs&&);
@@ -45,6 +59,12 @@ namespace Game {
     std::unique_ptr<IRenderingModule> rendering;
     std::vector<std::unique_ptr<IAppModule>> modules;
     std::unique_ptr<IGameDatabaseReader> dbSource;
+    UpdateMode updateMode{ UpdateMode::Serial };
+    //Measure the execution and wait time of each task in the update graph so it can be written with IGame::writeTaskGraph
+    bool recordTaskTimings{};
+    //Record what synchronous tasks in the update graph touch so it can be written with IGame::writeSynchronousTaskReport.
+    //Adds overhead to every row lookup those tasks do, so intended for diagnostics only
+    bool recordSynchronousAccess{};
   };
 
   std::unique_ptr<IGame> createGame(GameArgs&& args);
@@ -183,11 +183,15 @@ namespace GameBuilder {
       node->name = meta.name;
 
       reduce(meta);
+      const bool isSynchronous = std::holds_alternative<AppTaskPinning::Synchronous>(pinning);
+      if(isSynchronous) {
+        node->synchronousDependencies = std::make_shared<const AppTaskMetadata>(meta);
+      }
       //If everything is empty add an artificial dependency on an empty type so it still gets scheduled somewhere
       if(meta.reads.empty() && meta.writes.empty() && meta.tableModifiers.empty()) {
         meta.reads.push_back(noOpAccess);
       }
-      if(std::get_if<AppTaskPinning::Synchronous>(&pinning)) {
+      if(isSynchronous) {
         for(TableDependencies& table : dependencies) {
           addTableModifier(table, node);
         }
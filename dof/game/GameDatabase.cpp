@@ -32,6 +32,7 @@
 #include <module/MassModule.h>
 #include <module/PhysicsEvents.h>
 #include <PhysicsTableBuilder.h>
+#include <PhysicsLOD.h>
 #include <transform/TransformModule.h>
 #include <math/AxisFlags.h>
 
@@ -329,7 +330,8 @@ namespace GameDatabase {
       Narrowphase::SharedThicknessRow,
       Shapes::RectangleRow,
       GameInput::PlayerInputRow,
-      GameInput::StateMachineRow
+      GameInput::StateMachineRow,
+      PhysicsLOD::RegionOfInterestRow
     >().setStable().setTableName({ "Player" });
     return table;
   }
@@ -339,7 +341,8 @@ namespace GameDatabase {
     Transform::addPosXY(table).addRows<
       Row<Camera>,
       GameInput::StateMachineRow,
-      GameInput::CameraDebugInputRow
+      GameInput::CameraDebugInputRow,
+      PhysicsLOD::RegionOfInterestRow
     >().setStable().setTableName({ "Cameras" });
     return table;
   }
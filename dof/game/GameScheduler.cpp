@@ -59,9 +59,123 @@ namespace GameScheduler {
     }
   }
 
-  void executeTask(AppTaskArgs& args, ITaskImpl& task, ProfileData& profile) {
+  void TaskTiming::onBegin(uint32_t thread) {
+    Clock::rep expected{};
+    //First range to start determines the start of the task
+    if(frameBegin.compare_exchange_strong(expected, Clock::now().time_since_epoch().count())) {
+      frameThread = thread;
+    }
+  }
+
+  void TaskTiming::onEnd() {
+    const Clock::rep now = Clock::now().time_since_epoch().count();
+    Clock::rep current = frameEnd.load();
+    while(current < now && !frameEnd.compare_exchange_weak(current, now)) {
+    }
+  }
+
+  TaskTiming::Duration TaskTiming::getAverage() const {
+    return samples ? total / samples : Duration{};
+  }
+
+  TaskTiming::Duration TaskTiming::getAverageWait() const {
+    return samples ? totalWait / samples : Duration{};
+  }
+
+  void TaskTiming::addAccesses(const AccessRecorder::Recording& recording) {
+    std::lock_guard<std::mutex> lock{ accessMutex };
+    access->rows.insert(access->rows.end(), recording.rows.begin(), recording.rows.end());
+    access->modifiedTables.insert(access->modifiedTables.end(), recording.modifiedTables.begin(), recording.modifiedTables.end());
+  }
+
+  TaskTiming* TaskTimings::tryGet(const AppTaskNode& node) {
+    auto it = nodes.find(&node);
+    return it != nodes.end() ? &it->second : nullptr;
+  }
+
+  const TaskTiming* TaskTimings::tryGet(const AppTaskNode& node) const {
+    auto it = nodes.find(&node);
+    return it != nodes.end() ? &it->second : nullptr;
+  }
+
+  void TaskTimings::beginFrame() {
+    frameBegin = TaskTiming::Clock::now().time_since_epoch().count();
+  }
+
+  void TaskTimings::endFrame() {
+    using Rep = TaskTiming::Clock::rep;
+    if(!root) {
+      return;
+    }
+    //Visit in topological order so that the time each node became ready is known before visiting it
+    std::unordered_map<const AppTaskNode*, size_t> remainingParents;
+    std::unordered_map<const AppTaskNode*, Rep> readyTime;
+    std::vector<const AppTaskNode*> todo{ root.get() };
+    for(size_t i = 0; i < todo.size(); ++i) {
+      for(const auto& child : todo[i]->children) {
+        if(!remainingParents[child.get()]++) {
+          todo.push_back(child.get());
+        }
+      }
+    }
+
+    todo.assign(1, root.get());
+    readyTime[root.get()] = frameBegin;
+    while(todo.size()) {
+      const AppTaskNode* current = todo.back();
+      todo.pop_back();
+      const Rep ready = readyTime[current];
+      Rep finished = ready;
+      if(TaskTiming* timing = tryGet(*current)) {
+        const Rep begin = timing->frameBegin.exchange(0);
+        const Rep end = timing->frameEnd.exchange(0);
+        //Tasks without work to do still run but may not have recorded anything
+        if(begin && end) {
+          const TaskTiming::Duration duration{ end - begin };
+          const TaskTiming::Duration wait{ std::max(Rep{}, begin - ready) };
+          timing->total += duration;
+          timing->max = std::max(timing->max, duration);
+          timing->totalWait += wait;
+          timing->maxWait = std::max(timing->maxWait, wait);
+          timing->lastThread = timing->frameThread;
+          ++timing->samples;
+          finished = end;
+        }
+        if(timing->access) {
+          timing->access->compact();
+        }
+      }
+
+      for(const auto& child : current->children) {
+        Rep& childReady = readyTime[child.get()];
+        childReady = std::max(childReady, finished);
+        if(!--remainingParents[child.get()]) {
+          todo.push_back(child.get());
+        }
+      }
+    }
+  }
+
+  void executeTask(AppTaskArgs& args, ITaskImpl& task, ProfileData& profile, TaskTiming* timing) {
+    TRACE_SCOPE("scheduler", profile.name);
     PROFILE_ENTER_TOKEN(profile.profileToken);
-    task.execute(args);
+    if(timing) {
+      timing->onBegin(static_cast<uint32_t>(args.threadIndex));
+    }
+    if(timing && timing->access) {
+      //Ranges of the same task may run in parallel so record locally then merge
+      AccessRecorder::Recording recording;
+      AccessRecorder::setActive(&recording);
+      task.execute(args);
+      AccessRecorder::setActive(nullptr);
+      timing->addAccesses(recording);
+    }
+    else {
+      task.execute(args);
+    }
+    if(timing) {
+      timing->onEnd();
+    }
     PROFILE_EXIT_TOKEN(profile.profileToken);
   }
 
@@ -79,10 +193,11 @@ namespace GameScheduler {
   }
 
   struct TaskAdapter : enki::ITaskSet {
-    TaskAdapter(AppTaskNode& t, ThreadLocals& tl)
+    TaskAdapter(AppTaskNode& t, ThreadLocals& tl, TaskTiming* tt)
       : task{ std::move(t.task) }
       , profile{ createProfileData(t.name) }
-      , tls{ tl }{
+      , tls{ tl }
+      , timing{ tt } {
       setConfigurableTask(*this, task.get());
       initTaskThreadLocals(task.get(), tl);
     }
@@ -90,30 +205,32 @@ namespace GameScheduler {
     void ExecuteRange(enki::TaskSetPartition range, uint32_t thread) override {
       if(task) {
         GameTaskArgs args{ range, tls, thread };
-        executeTask(args, *task, profile);
+        executeTask(args, *task, profile, timing);
       }
     }
 
     std::unique_ptr<ITaskImpl> task;
     ProfileData profile;
     ThreadLocals& tls;
+    TaskTiming* timing{};
   };
 
   struct PinnedTaskAdapter : enki::IPinnedTask {
     static constexpr size_t PINNED_THREAD = MAIN_THREAD;
-    PinnedTaskAdapter(AppTaskNode& t, ThreadLocals& tl, size_t thread)
+    PinnedTaskAdapter(AppTaskNode& t, ThreadLocals& tl, size_t thread, TaskTiming* tt)
       : enki::IPinnedTask(PINNED_THREAD)
       , task{ std::move(t.task) }
       , profile{ createProfileData(t.name) }
       , tls{ tl }
-      , pinnedThread{ thread } {
+      , pinnedThread{ thread }
+      , timing{ tt } {
       initTaskThreadLocal(task.get(), tl, pinnedThread);
     }
 
     void Execute() override {
       if(task) {
         GameTaskArgs args{ enki::TaskSetPartition{}, tls, pinnedThread };
-        executeTask(args, *task, profile);
+        executeTask(args, *task, profile, timing);
       }
     }
 
@@ -121,35 +238,48 @@ namespace GameScheduler {
     ProfileData profile;
     ThreadLocals& tls;
     size_t pinnedThread{};
+    TaskTiming* timing{};
   };
 
   struct PopulateTask {
     void operator()(AppTaskPinning::None) {
       task.dst->name = task.src->name;
-      task.dst->mTask.mTask = std::make_unique<TaskAdapter>(*task.src, tls);
+      task.dst->mTask.mTask = std::make_unique<TaskAdapter>(*task.src, tls, timing);
     }
 
     void operator()(AppTaskPinning::MainThread) {
       task.dst->name = task.src->name;
-      task.dst->mTask.mTask = std::make_unique<PinnedTaskAdapter>(*task.src, tls, MAIN_THREAD);
+      task.dst->mTask.mTask = std::make_unique<PinnedTaskAdapter>(*task.src, tls, MAIN_THREAD, timing);
     }
 
     void operator()(AppTaskPinning::ThreadID id) {
       task.dst->name = task.src->name;
-      task.dst->mTask.mTask = std::make_unique<PinnedTaskAdapter>(*task.src, tls, id.id);
+      task.dst->mTask.mTask = std::make_unique<PinnedTaskAdapter>(*task.src, tls, id.id, timing);
     }
 
     void operator()(AppTaskPinning::Synchronous) {
       //Synchronous behavior is addressed by GameBuilder.cpp
       task.dst->name = task.src->name;
-      task.dst->mTask.mTask = std::make_unique<TaskAdapter>(*task.src, tls);
+      task.dst->mTask.mTask = std::make_unique<TaskAdapter>(*task.src, tls, timing);
+      if(timing) {
+        timing->synchronous = true;
+        if(recordAccess) {
+          timing->access = std::make_unique<AccessRecorder::Recording>();
+        }
+      }
     }
 
     ConversionTask& task;
     ThreadLocals& tls;
+    TaskTiming* timing{};
+    bool recordAccess{};
   };
 
-  TaskRange buildTasks(std::shared_ptr<AppTaskNode> root, ThreadLocals& tls) {
+  TaskRange buildTasks(std::shared_ptr<AppTaskNode> root, ThreadLocals& tls, TaskTimings* timings) {
+    if(timings) {
+      timings->root = root;
+      timings->nodes.clear();
+    }
     std::deque<ConversionTask> todo;
     std::unordered_map<AppTaskNode*, std::shared_ptr<TaskNode>> visited;
     auto result = std::make_shared<TaskNode>();
@@ -159,7 +289,9 @@ namespace GameScheduler {
       todo.pop_front();
 
       //Fill in the task callback for this one
-      std::visit(PopulateTask{ current, tls }, current.src->task ? current.src->task->getPinning() : AppTaskPinning::Variant{});
+      TaskTiming* timing = timings && current.src->task ? &timings->nodes[current.src] : nullptr;
+      const bool recordAccess = timings && timings->recordSynchronousAccess;
+      std::visit(PopulateTask{ current, tls, timing, recordAccess }, current.src->task ? current.src->task->getPinning() : AppTaskPinning::Variant{});
 
       //Create empty children and add them to the todo list
       current.dst->mChildren.resize(current.src->children.size());
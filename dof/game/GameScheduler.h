@@ -1,5 +1,7 @@
 #pragma once
 
+#include "AccessRecorder.h"
+
 struct AppTaskNode;
 struct TaskNode;
 struct ThreadLocals;
@@ -11,7 +13,55 @@ namespace GameScheduler {
     std::function<void()> work;
   };
 
-  TaskRange buildTasks(std::shared_ptr<AppTaskNode> root, ThreadLocals& tls);
+  //Runtime measurements of a single task. The atomics are written by the threads executing the task during the frame
+  //then folded into the totals by TaskTimings::endFrame
+  struct TaskTiming {
+    using Clock = std::chrono::steady_clock;
+    using Duration = std::chrono::nanoseconds;
+
+    void onBegin(uint32_t thread);
+    void onEnd();
+
+    Duration getAverage() const;
+    Duration getAverageWait() const;
+    //Merge the accesses of one execution of the task into the total
+    void addAccesses(const AccessRecorder::Recording& recording);
+
+    std::atomic<Clock::rep> frameBegin{};
+    std::atomic<Clock::rep> frameEnd{};
+    uint32_t frameThread{};
+
+    Duration total{};
+    Duration max{};
+    Duration totalWait{};
+    Duration maxWait{};
+    size_t samples{};
+    uint32_t lastThread{};
+    bool synchronous{};
+    //Present for synchronous tasks if TaskTimings::recordSynchronousAccess is set
+    std::unique_ptr<AccessRecorder::Recording> access;
+    std::mutex accessMutex;
+  };
+
+  //Timings for all nodes of a graph built by buildTasks. The graph is kept alive here so it can be written out with the timings
+  struct TaskTimings {
+    TaskTiming* tryGet(const AppTaskNode& node);
+    const TaskTiming* tryGet(const AppTaskNode& node) const;
+
+    //Call before and after running the graph. Time that a task waited is from when its last dependency finished
+    //or from the start of the frame for those that only depend on the root
+    void beginFrame();
+    void endFrame();
+
+    std::shared_ptr<AppTaskNode> root;
+    std::unordered_map<const AppTaskNode*, TaskTiming> nodes;
+    TaskTiming::Clock::rep frameBegin{};
+    //Record the rows and tables that synchronous tasks access while executing, must be set before buildTasks
+    bool recordSynchronousAccess{};
+  };
+
+  //If timings are provided they are populated with an entry for every task in the graph and filled in as the tasks execute
+  TaskRange buildTasks(std::shared_ptr<AppTaskNode> root, ThreadLocals& tls, TaskTimings* timings = nullptr);
   std::vector<SyncWorkItem> buildSync(std::shared_ptr<AppTaskNode> root);
   std::unique_ptr<AppTaskArgs> createAppTaskArgs(ThreadLocals* tls, size_t threadIndex);
 };
\ No newline at end of file
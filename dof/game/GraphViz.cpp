@@ -2,9 +2,72 @@
 #include "GraphViz.h"
 
 #include "AppBuilder.h"
+#include "GameScheduler.h"
+
+#include <iomanip>
 
 namespace GraphViz {
-  void build(std::ostream& stream, const AppTaskNode& root) {
+  using Duration = GameScheduler::TaskTiming::Duration;
+
+  struct NodeInfo {
+    size_t id{};
+    //Longest path of average task durations from the root to the end of this node
+    Duration pathTime{};
+    const AppTaskNode* pathParent{};
+  };
+
+  double toMS(Duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  }
+
+  Duration getWeight(const AppTaskNode& node, const GameScheduler::TaskTimings* timings) {
+    const GameScheduler::TaskTiming* timing = timings ? timings->tryGet(node) : nullptr;
+    return timing ? timing->getAverage() : Duration{};
+  }
+
+  //Nodes in an order where all parents come before their children
+  std::vector<const AppTaskNode*> sortTopologically(const AppTaskNode& root) {
+    std::unordered_map<const AppTaskNode*, size_t> remainingParents;
+    std::vector<const AppTaskNode*> todo{ &root };
+    for(size_t i = 0; i < todo.size(); ++i) {
+      for(const auto& child : todo[i]->children) {
+        if(!remainingParents[child.get()]++) {
+          todo.push_back(child.get());
+        }
+      }
+    }
+
+    std::vector<const AppTaskNode*> result;
+    result.reserve(todo.size());
+    todo.assign(1, &root);
+    while(todo.size()) {
+      const AppTaskNode* current = todo.back();
+      todo.pop_back();
+      result.push_back(current);
+      for(const auto& child : current->children) {
+        if(!--remainingParents[child.get()]) {
+          todo.push_back(child.get());
+        }
+      }
+    }
+    return result;
+  }
+
+  void writeLabel(std::ostream& stream, const AppTaskNode& node, const GameScheduler::TaskTiming* timing) {
+    stream << "label=\"" << node.name;
+    if(timing) {
+      stream << std::fixed << std::setprecision(3)
+        << "\\navg " << toMS(timing->getAverage()) << "ms max " << toMS(timing->max) << "ms"
+        << "\\nwait avg " << toMS(timing->getAverageWait()) << "ms max " << toMS(timing->maxWait) << "ms"
+        << "\\nthread " << timing->lastThread;
+      if(timing->synchronous) {
+        stream << "\\nSYNCHRONOUS";
+      }
+    }
+    stream << "\"";
+  }
+
+  void build(std::ostream& stream, const AppTaskNode& root, const GameScheduler::TaskTimings* timings) {
     stream << R"(
       digraph mygraph {
         fontname="Helvetica,Arial,sans-serif"
@@ -12,30 +75,68 @@ namespace GraphViz {
         edge [fontname="Helvetica,Arial,sans-serif"]
         node [shape=box];
     )";
-    std::unordered_set<const AppTaskNode*> visited;
-    std::vector<const AppTaskNode*> todo;
-    todo.push_back(&root);
-    while(todo.size()) {
-      const AppTaskNode* current = todo.back();
-      todo.pop_back();
-      if(!visited.insert(current).second) {
-        continue;
+    const std::vector<const AppTaskNode*> nodes = sortTopologically(root);
+    std::unordered_map<const AppTaskNode*, NodeInfo> info;
+    for(size_t i = 0; i < nodes.size(); ++i) {
+      info[nodes[i]].id = i;
+    }
+
+    //Longest path through the graph using the average time of each task
+    const AppTaskNode* pathEnd = &root;
+    for(const AppTaskNode* node : nodes) {
+      NodeInfo& current = info[node];
+      current.pathTime += getWeight(*node, timings);
+      if(current.pathTime > info[pathEnd].pathTime) {
+        pathEnd = node;
       }
+      for(const auto& child : node->children) {
+        NodeInfo& c = info[child.get()];
+        if(!c.pathParent || c.pathTime < current.pathTime) {
+          c.pathTime = current.pathTime;
+          c.pathParent = node;
+        }
+      }
+    }
+    std::unordered_set<const AppTaskNode*> criticalPath;
+    if(timings) {
+      for(const AppTaskNode* node = pathEnd; node; node = info[node].pathParent) {
+        criticalPath.insert(node);
+      }
+      stream << std::fixed << std::setprecision(3)
+        << "  label=\"critical path " << toMS(info[pathEnd].pathTime) << "ms\"" << std::endl;
+    }
 
-      for(const auto& child : current->children) {
-        stream << "  \"" << current->name << "\" -> \"" << child->name << "\"" << std::endl;
-        todo.push_back(child.get());
+    for(const AppTaskNode* node : nodes) {
+      const GameScheduler::TaskTiming* timing = timings ? timings->tryGet(*node) : nullptr;
+      stream << "  n" << info[node].id << " [";
+      writeLabel(stream, *node, timing);
+      if(timing && timing->synchronous) {
+        stream << " style=filled fillcolor=orange";
+      }
+      if(criticalPath.contains(node)) {
+        stream << " color=red penwidth=3";
+      }
+      stream << "]" << std::endl;
+    }
+
+    for(const AppTaskNode* node : nodes) {
+      for(const auto& child : node->children) {
+        stream << "  n" << info[node].id << " -> n" << info[child.get()].id;
+        if(info[child.get()].pathParent == node && criticalPath.contains(child.get())) {
+          stream << " [color=red penwidth=3]";
+        }
+        stream << std::endl;
       }
     }
 
     stream << "}";
   }
 
-  void writeHere(const std::string& location, const AppTaskNode& root) {
+  void writeHere(const std::string& location, const AppTaskNode& root, const GameScheduler::TaskTimings* timings) {
     std::ofstream stream(location, std::ios::out);
     if(stream.good()) {
-      build(stream, root);
+      build(stream, root, timings);
       stream.flush();
     }
   }
-}
\ No newline at end of file
+}
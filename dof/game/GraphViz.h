@@ -1,10 +1,15 @@
 #pragma once
 
 struct AppTaskNode;
+namespace GameScheduler {
+  struct TaskTimings;
+}
 
 // Turn into svg:
 // dot -Tsvg graph.gv > graph.svg
 namespace GraphViz {
-  void build(std::ostream& stream, const AppTaskNode& root);
-  void writeHere(const std::string& location, const AppTaskNode& root);
-}
\ No newline at end of file
+  //If timings are provided each node is annotated with its measured times, the critical path is highlighted,
+  //and synchronous tasks that block all others are flagged
+  void build(std::ostream& stream, const AppTaskNode& root, const GameScheduler::TaskTimings* timings = nullptr);
+  void writeHere(const std::string& location, const AppTaskNode& root, const GameScheduler::TaskTimings* timings = nullptr);
+}
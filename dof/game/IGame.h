@@ -16,4 +16,8 @@ public:
   //Exposed for odd cases where something outside of the main tick calls into something that
   //requires AppTaskArgs, like tests. Should not be used during the tick while other threads might be using these locals
   virtual std::unique_ptr<AppTaskArgs> createAppTaskArgs(size_t threadIndex = 0) = 0;
+  //Write the update graph annotated with task timings as GraphViz. Requires GameArgs::recordTaskTimings and a multithreaded game
+  virtual bool writeTaskGraph(const std::string& location) = 0;
+  //Write which tables the synchronous tasks in the update graph touched and how much serial time they cost. Requires GameArgs::recordSynchronousAccess
+  virtual bool writeSynchronousTaskReport(const std::string& location) = 0;
 };
\ No newline at end of file
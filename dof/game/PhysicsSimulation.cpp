@@ -22,11 +22,27 @@ namespace PhysicsSimulation {
     auto task = builder.createTask();
     task.setName("physics debug");
     DebugLineAdapter debug = TableAdapters::getDebugLines(task);
-    auto broadphase = task.query<const SharedRow<Broadphase::SweepGrid::Grid>>();
+    auto broadphase = task.query<const SharedRow<Broadphase::SweepGrid::Grid>, const SharedRow<Broadphase::AABBTree::Tree>>();
 
     task.setCallback([debug, broadphase, &config](AppTaskArgs&) mutable {
       if(config.broadphase.draw) {
         for(size_t t = 0; t < broadphase.size(); ++t) {
+          const Broadphase::AABBTree::Tree& tree = broadphase.get<1>(t).at();
+          if(tree.enabled) {
+            //Draw the fat bounds of each leaf
+            const glm::vec3 color{ 0.0f, 1.0f, 1.0f };
+            for(uint32_t leaf : tree.leaves) {
+              if(leaf != Broadphase::AABBTree::NONE) {
+                const Broadphase::AABBTree::Node& node = tree.nodes[leaf];
+                DebugDrawer::drawLine(debug, node.min, { node.max.x, node.min.y }, color);
+                DebugDrawer::drawLine(debug, { node.max.x, node.min.y }, node.max, color);
+                DebugDrawer::drawLine(debug, node.max, { node.min.x, node.max.y }, color);
+                DebugDrawer::drawLine(debug, node.min, { node.min.x, node.max.y }, color);
+              }
+            }
+            continue;
+          }
+
           const Broadphase::SweepGrid::Grid& grid = broadphase.get<0>(t).at();
           for(size_t i = 0; i < grid.cells.size(); ++i) {
             const Broadphase::Sweep2D& sweep = grid.cells[i];
@@ -39,7 +55,7 @@ namespace PhysicsSimulation {
             DebugDrawer::drawLine(debug, max, { min.x, max.y }, color);
             DebugDrawer::drawLine(debug, min, { min.x, max.y }, color);
 
-            for(const auto& key : sweep.containedKeys) {
+            for(const auto& [key, unused] : sweep.containedKeys) {
               const auto& x = grid.objects.bounds[0][key.value];
               const auto& y = grid.objects.bounds[1][key.value];
               if(x.first == Broadphase::ObjectDB::REMOVED) {
@@ -14,6 +14,8 @@
 #include "GameMath.h"
 #include "Physics.h"
 #include "SpatialPairsStorage.h"
+#include "RayPacket.h"
+#include <math/Geometric.h>
 #include <transform/TransformModule.h>
 #include <TableName.h>
 
@@ -214,6 +216,18 @@ namespace SpatialQuery {
     CreateData createAABB, createCircle, createRaycast;
   };
 
+  //Flip is for when the query is B in the manifold, results are always from the perspective of the query
+  ContactXY toContactXY(const SP::ContactManifold& manifold, bool flip) {
+    ContactXY c;
+    c.size = static_cast<uint8_t>(manifold.size);
+    for(uint32_t i = 0; i < manifold.size; ++i) {
+      c.points[i].point = flip ? manifold[i].centerToContactB : manifold[i].centerToContactA;
+      c.points[i].normal = flip ? -manifold[i].normal : manifold[i].normal;
+      c.points[i].overlap = manifold[i].overlap;
+    }
+    return c;
+  }
+
   struct Reader : IReader {
     Reader(RuntimeDatabaseTaskBuilder& task) {
       graph = task.query<const SP::IslandGraphRow>().tryGetSingletonElement();
@@ -260,13 +274,7 @@ namespace SpatialQuery {
       }
 
       void addResults(const SP::ContactManifold& manifold) {
-        ContactXY& c = result.contact.emplace<ContactXY>();
-        c.size = static_cast<uint8_t>(manifold.size);
-        for(size_t i = 0; i < manifold.size; ++i) {
-          c.points[i].point = flipResults ? manifold[i].centerToContactB : manifold[i].centerToContactA;
-          c.points[i].normal = flipResults ? -manifold.points[i].normal : manifold[i].normal;
-          c.points[i].overlap = manifold[i].overlap;
-        }
+        result.contact = toContactXY(manifold, flipResults);
       }
 
       void addResults(const SP::ZInfo& manifold) {
@@ -384,6 +392,233 @@ namespace SpatialQuery {
     WriteData writeRay;
   };
 
+  //The query shapes as the narrowphase sees them, along with the bounds to find candidates in the broadphase
+  struct ImmediateShape {
+    ImmediateShape(const Raycast& shape)
+      : body{ static_cast<ShapeRegistry::Raycast>(shape) }
+      , bounds{ glm::min(shape.start, shape.end), glm::max(shape.start, shape.end) }
+    {}
+
+    ImmediateShape(const AABB& shape)
+      : body{ static_cast<ShapeRegistry::AABB>(shape) }
+      , bounds{ shape.min, shape.max }
+    {}
+
+    ImmediateShape(const Circle& shape)
+      : body{ static_cast<ShapeRegistry::Circle>(shape) }
+      , bounds{ shape.pos - glm::vec2{ shape.radius }, shape.pos + glm::vec2{ shape.radius } }
+    {}
+
+    ShapeRegistry::BodyType body;
+    Geo::AABB bounds;
+  };
+
+  struct Immediate : IImmediate {
+    Immediate(RuntimeDatabaseTaskBuilder& task)
+      : broadphase{ SweepNPruneBroadphase::createBroadphaseReader(task) }
+      , classifier{ ShapeRegistry::get(task)->createShapeClassifier(task) }
+      , resolver{ task.getResolver<const Transform::WorldTransformRow, const Transform::WorldInverseTransformRow, const SpatialQueriesTableTag>() }
+      , ids{ task.getIDResolver() }
+    {}
+
+    //Invoke fn with each candidate and the manifold from the query shape to it, skipping those that don't touch
+    template<class FN>
+    void forEachContact(const Query::Shape& volume, FN&& fn) {
+      ImmediateShape shape = std::visit([](const auto& s) { return ImmediateShape{ s }; }, volume);
+      const Transform::PackedTransform transform = std::visit(QueryTransform{}, volume);
+      const Transform::PackedTransform inverse = transform.inverse();
+      const ElementRefResolver refs = ids->getRefResolver();
+      SP::ContactManifold manifold;
+      for(const ElementRef& other : candidates) {
+        const auto id = refs.tryUnpack(other);
+        //Queries made through ICreator are in the broadphase too but aren't something to find
+        if(!id || resolver->tryGetOrSwapRow(queryTables, *id) || !resolver->tryGetOrSwapAllRows(*id, transforms, inverses)) {
+          continue;
+        }
+        const size_t i = id->getElementIndex();
+        ShapeRegistry::BodyType otherShape = classifier->classifyShape(*id, transforms->at(i), inverses->at(i));
+        Narrowphase::generateContacts(shape.body, transform, inverse, otherShape, transforms->at(i), inverses->at(i), tempA, tempB, manifold);
+        if(manifold.size) {
+          fn(other, manifold);
+        }
+      }
+    }
+
+    void raycast(const Raycast& ray, Narrowphase::CollisionMask mask, std::vector<RaycastResult>& results) override {
+      candidates.clear();
+      broadphase.queryRaycast(ray.start, ray.end, mask, candidates);
+      const size_t begin = results.size();
+      forEachContact(Query::Shape{ ray }, [&](const ElementRef& other, const SP::ContactManifold& manifold) {
+        //Points are relative to the start of the ray, the closest of them is the first hit
+        uint32_t closest = 0;
+        for(uint32_t i = 1; i < manifold.size; ++i) {
+          if(glm::length2(manifold[i].centerToContactA) < glm::length2(manifold[closest].centerToContactA)) {
+            closest = i;
+          }
+        }
+        results.push_back(RaycastResult{
+          .id = other,
+          .point = ray.start + manifold[closest].centerToContactA,
+          //Manifold normal points from the other shape towards the ray, which is the outward surface normal
+          .normal = manifold[closest].normal
+        });
+      });
+      std::sort(results.begin() + begin, results.end(), [&ray](const RaycastResult& l, const RaycastResult& r) {
+        return glm::distance2(ray.start, l.point) < glm::distance2(ray.start, r.point);
+      });
+    }
+
+    void raycast(std::span<const Raycast> rays, Narrowphase::CollisionMask mask, BatchRaycastResults& results) override {
+      batchHits.clear();
+      for(size_t begin = 0; begin < rays.size(); begin += RAY_PACKET_SIZE) {
+        castPacket(rays.subspan(begin, std::min(RAY_PACKET_SIZE, rays.size() - begin)), static_cast<uint32_t>(begin), mask);
+      }
+      std::sort(batchHits.begin(), batchHits.end(), [](const BatchHit& l, const BatchHit& r) {
+        return l.ray == r.ray ? l.t < r.t : l.ray < r.ray;
+      });
+
+      results.hits.clear();
+      results.offsets.clear();
+      results.offsets.reserve(rays.size() + 1);
+      size_t h = 0;
+      for(uint32_t ray = 0; ray < static_cast<uint32_t>(rays.size()); ++ray) {
+        results.offsets.push_back(static_cast<uint32_t>(results.hits.size()));
+        for(; h < batchHits.size() && batchHits[h].ray == ray; ++h) {
+          results.hits.push_back(batchHits[h].result);
+        }
+      }
+      results.offsets.push_back(static_cast<uint32_t>(results.hits.size()));
+    }
+
+    void addPacketHits(const ElementRef& other, uint32_t rayOffset) {
+      for(size_t r = 0; r < packet.size(); ++r) {
+        if(packetHits.isHit(r)) {
+          batchHits.push_back(BatchHit{
+            .ray = rayOffset + static_cast<uint32_t>(r),
+            .t = packetHits.tIn[r],
+            .result = RaycastResult{
+              .id = other,
+              .point = packet.getStart(r) + packet.getDir(r)*packetHits.tIn[r],
+              .normal = packetHits.getNormal(r)
+            }
+          });
+        }
+      }
+    }
+
+    //Shapes without a packet kernel go through the narrowphase one ray at a time like the single raycast
+    void castPacketScalar(const ElementRef& other, ShapeRegistry::BodyType& otherShape, const Transform::PackedTransform& transform, const Transform::PackedTransform& inverse, uint32_t rayOffset) {
+      SP::ContactManifold manifold;
+      for(size_t r = 0; r < packet.size(); ++r) {
+        const glm::vec2 start = packet.getStart(r);
+        const glm::vec2 dir = packet.getDir(r);
+        const ShapeRegistry::Raycast line{ .start = start, .end = start + dir };
+        ShapeRegistry::BodyType ray{ line };
+        const Transform::PackedTransform rayTransform = Shapes::toTransform(line, 0);
+        Narrowphase::generateContacts(ray, rayTransform, rayTransform.inverse(), otherShape, transform, inverse, tempA, tempB, manifold);
+        if(!manifold.size) {
+          continue;
+        }
+        uint32_t closest = 0;
+        for(uint32_t i = 1; i < manifold.size; ++i) {
+          if(glm::length2(manifold[i].centerToContactA) < glm::length2(manifold[closest].centerToContactA)) {
+            closest = i;
+          }
+        }
+        const float length2 = glm::length2(dir);
+        batchHits.push_back(BatchHit{
+          .ray = rayOffset + static_cast<uint32_t>(r),
+          .t = length2 > 0.0f ? glm::dot(manifold[closest].centerToContactA, dir)/length2 : 0.0f,
+          .result = RaycastResult{
+            .id = other,
+            .point = start + manifold[closest].centerToContactA,
+            //Outward surface normal, same as the packet kernels and the single raycast
+            .normal = manifold[closest].normal
+          }
+        });
+      }
+    }
+
+    void castPacket(std::span<const Raycast> rays, uint32_t rayOffset, Narrowphase::CollisionMask mask) {
+      packet.clear();
+      glm::vec2 min{ std::numeric_limits<float>::max() };
+      glm::vec2 max{ std::numeric_limits<float>::lowest() };
+      for(const Raycast& ray : rays) {
+        packet.push_back(ray.start, ray.end - ray.start);
+        min = glm::min(min, glm::min(ray.start, ray.end));
+        max = glm::max(max, glm::max(ray.start, ray.end));
+      }
+      candidates.clear();
+      broadphase.queryAABB(min, max, mask, candidates);
+
+      const ElementRefResolver refs = ids->getRefResolver();
+      for(const ElementRef& other : candidates) {
+        const auto id = refs.tryUnpack(other);
+        if(!id || resolver->tryGetOrSwapRow(queryTables, *id) || !resolver->tryGetOrSwapAllRows(*id, transforms, inverses)) {
+          continue;
+        }
+        const size_t i = id->getElementIndex();
+        ShapeRegistry::BodyType otherShape = classifier->classifyShape(*id, transforms->at(i), inverses->at(i));
+        //The packet is the segment from start to end, anything past 1 is beyond the end
+        if(const auto* rect = std::get_if<ShapeRegistry::Rectangle>(&otherShape.shape)) {
+          RayPacket::intersectBox(packet, rect->center, rect->right*(rect->halfWidth.x*2.0f), Geo::orthogonal(rect->right)*(rect->halfWidth.y*2.0f), 1.0f, packetHits);
+          addPacketHits(other, rayOffset);
+        }
+        else if(const auto* aabb = std::get_if<ShapeRegistry::AABB>(&otherShape.shape)) {
+          const glm::vec2 size = aabb->max - aabb->min;
+          RayPacket::intersectBox(packet, (aabb->min + aabb->max)*0.5f, glm::vec2{ size.x, 0.0f }, glm::vec2{ 0.0f, size.y }, 1.0f, packetHits);
+          addPacketHits(other, rayOffset);
+        }
+        else if(const auto* circle = std::get_if<ShapeRegistry::Circle>(&otherShape.shape)) {
+          RayPacket::intersectCircle(packet, circle->pos, circle->radius, 1.0f, packetHits);
+          addPacketHits(other, rayOffset);
+        }
+        else {
+          castPacketScalar(other, otherShape, transforms->at(i), inverses->at(i), rayOffset);
+        }
+      }
+    }
+
+    void overlap(const Query::Shape& volume, Narrowphase::CollisionMask mask, std::vector<Result>& results) override {
+      candidates.clear();
+      if(const Raycast* ray = std::get_if<Raycast>(&volume)) {
+        broadphase.queryRaycast(ray->start, ray->end, mask, candidates);
+      }
+      else {
+        const Geo::AABB bounds = std::visit([](const auto& s) { return ImmediateShape{ s }.bounds; }, volume);
+        broadphase.queryAABB(bounds.min, bounds.max, mask, candidates);
+      }
+      forEachContact(volume, [&](const ElementRef& other, const SP::ContactManifold& manifold) {
+        results.push_back(Result{
+          .other = other,
+          .contact = toContactXY(manifold, false)
+        });
+      });
+    }
+
+    SweepNPruneBroadphase::BroadphaseReader broadphase;
+    std::shared_ptr<ShapeRegistry::IShapeClassifier> classifier;
+    std::shared_ptr<ITableResolver> resolver;
+    std::shared_ptr<IIDResolver> ids;
+    CachedRow<const Transform::WorldTransformRow> transforms;
+    CachedRow<const Transform::WorldInverseTransformRow> inverses;
+    CachedRow<const SpatialQueriesTableTag> queryTables;
+    std::vector<ElementRef> candidates;
+    //Narrowphase mesh scratch reused across candidates
+    std::vector<glm::vec2> tempA, tempB;
+
+    struct BatchHit {
+      uint32_t ray{};
+      float t{};
+      RaycastResult result;
+    };
+    //Small enough that the rays of a packet stay close together, large enough to fill the vector lanes many times
+    static constexpr size_t RAY_PACKET_SIZE = 64;
+    RayPacket::Rays packet;
+    RayPacket::Hits packetHits;
+    std::vector<BatchHit> batchHits;
+  };
+
   std::shared_ptr<ICreator> createCreator(RuntimeDatabaseTaskBuilder& task) {
     return std::make_shared<Creator>(task);
   }
@@ -396,6 +631,10 @@ namespace SpatialQuery {
     return std::make_shared<Writer>(task);
   }
 
+  std::shared_ptr<IImmediate> createImmediate(RuntimeDatabaseTaskBuilder& task) {
+    return std::make_shared<Immediate>(task);
+  }
+
   void processLifetime(IAppBuilder& builder, const TableID& table) {
     auto task = builder.createTask();
     task.setName("SQ lifetimes");
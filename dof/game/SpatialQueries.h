@@ -34,6 +34,22 @@ namespace SpatialQuery {
     std::vector<RaycastResult> results;
   };
 
+  //Results of many rays cast at once. The hits of each ray are sorted by distance from its start
+  struct BatchRaycastResults {
+    const RaycastResult* tryGetFirstHit(size_t ray) const {
+      const std::span<const RaycastResult> h = getHits(ray);
+      return h.empty() ? nullptr : &h.front();
+    }
+
+    std::span<const RaycastResult> getHits(size_t ray) const {
+      return { hits.data() + offsets[ray], hits.data() + offsets[ray + 1] };
+    }
+
+    std::vector<RaycastResult> hits;
+    //Hits of ray i are [offsets[i], offsets[i + 1]) so there is one more offset than there are rays
+    std::vector<uint32_t> offsets;
+  };
+
   struct Raycast {
     operator Narrowphase::Shape::Raycast() const {
       return { start, end };
@@ -161,9 +177,25 @@ namespace SpatialQuery {
     virtual void refreshQuery(const ElementRef& index, size_t newLifetime) = 0;
   };
 
+  //Answers queries synchronously against the broadphase as it was after the last physics update
+  //Unlike ICreator nothing is added to the database and results are available right away, but each call pays for its
+  //own broadphase traversal and narrowphase. Only XY contacts are reported, thickness is ignored
+  //Each task should create its own, they only read shared data so any number can be used at the same time
+  struct IImmediate {
+    virtual ~IImmediate() = default;
+    //Shapes hit by the ray sorted by distance from the start. The point is the hit closest to the start
+    virtual void raycast(const Raycast& ray, Narrowphase::CollisionMask mask, std::vector<RaycastResult>& results) = 0;
+    //Same as casting each ray individually but rays are grouped into packets that share a single broadphase traversal
+    //and are tested against each candidate together. Grouping rays that are near each other gives the fewest candidates
+    virtual void raycast(std::span<const Raycast> rays, Narrowphase::CollisionMask mask, BatchRaycastResults& results) = 0;
+    //Shapes overlapping the volume with contacts in the same form as IReader gives for a query of that shape
+    virtual void overlap(const Query::Shape& volume, Narrowphase::CollisionMask mask, std::vector<Result>& results) = 0;
+  };
+
   std::shared_ptr<ICreator> createCreator(RuntimeDatabaseTaskBuilder& task);
   std::shared_ptr<IReader> createReader(RuntimeDatabaseTaskBuilder& task);
   std::shared_ptr<IWriter> createWriter(RuntimeDatabaseTaskBuilder& task);
+  std::shared_ptr<IImmediate> createImmediate(RuntimeDatabaseTaskBuilder& task);
 
   //Update boundaries based on query shape before they are updated in the broadphase
   void physicsUpdateBoundaries(IAppBuilder& builder);
@@ -0,0 +1,139 @@
+#include "Precompile.h"
+#include "SynchronousTaskReport.h"
+
+#include "AppBuilder.h"
+#include "GameScheduler.h"
+#include "TableName.h"
+
+#include <iomanip>
+#include <map>
+
+namespace SynchronousTaskReport {
+  using Duration = GameScheduler::TaskTiming::Duration;
+
+  struct TableUsage {
+    std::vector<DBTypeID> rows;
+    bool modified{};
+    bool declared{};
+  };
+
+  struct TaskEntry {
+    const AppTaskNode* node{};
+    const GameScheduler::TaskTiming* timing{};
+  };
+
+  double toMS(Duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  }
+
+  std::string_view getTableName(RuntimeDatabase& db, const TableID& table) {
+    RuntimeTable* t = db.tryGet(table);
+    const TableName::TableNameRow* name = t ? t->tryGet<const TableName::TableNameRow>() : nullptr;
+    return name ? std::string_view{ name->at().name } : std::string_view{};
+  }
+
+  //Combine what the task declared while building with what it was observed to use while executing
+  std::map<size_t, TableUsage> gatherUsage(const TaskEntry& entry, const DatabaseIndex& dbIndex) {
+    std::map<size_t, TableUsage> result;
+    //Accesses through thread local databases don't block the main database
+    auto isMain = [&](const TableID& t) { return t.getDatabaseIndex() == dbIndex; };
+    if(entry.timing->access) {
+      for(const AccessRecorder::RowAccess& access : entry.timing->access->rows) {
+        if(isMain(access.table)) {
+          result[access.table.getTableIndex()].rows.push_back(access.row);
+        }
+      }
+      for(const TableID& table : entry.timing->access->modifiedTables) {
+        if(isMain(table)) {
+          result[table.getTableIndex()].modified = true;
+        }
+      }
+    }
+    if(const AppTaskMetadata* declared = entry.node->synchronousDependencies.get()) {
+      auto addDeclared = [&](const TableID& table) -> TableUsage& {
+        TableUsage& usage = result[table.getTableIndex()];
+        usage.declared = true;
+        return usage;
+      };
+      for(const TableAccess& access : declared->reads) {
+        addDeclared(access.tableID).rows.push_back(access.rowType);
+      }
+      for(const TableAccess& access : declared->writes) {
+        addDeclared(access.tableID).rows.push_back(access.rowType);
+      }
+      for(const TableID& table : declared->tableModifiers) {
+        addDeclared(table).modified = true;
+      }
+    }
+    for(auto& [_, usage] : result) {
+      std::sort(usage.rows.begin(), usage.rows.end());
+      usage.rows.erase(std::unique(usage.rows.begin(), usage.rows.end()), usage.rows.end());
+    }
+    return result;
+  }
+
+  void write(std::ostream& stream, const GameScheduler::TaskTimings& timings, RuntimeDatabase& db) {
+    std::vector<TaskEntry> tasks;
+    for(const auto& [node, timing] : timings.nodes) {
+      if(timing.synchronous) {
+        tasks.push_back({ node, &timing });
+      }
+    }
+    //Most expensive first since those are the best candidates to rewrite
+    std::sort(tasks.begin(), tasks.end(), [](const TaskEntry& l, const TaskEntry& r) {
+      return l.timing->getAverage() > r.timing->getAverage();
+    });
+
+    Duration totalSerial{};
+    for(const TaskEntry& entry : tasks) {
+      totalSerial += entry.timing->getAverage();
+    }
+
+    const DatabaseIndex dbIndex = db.getDescription().dbIndex;
+    stream << std::fixed << std::setprecision(3);
+    stream << tasks.size() << " synchronous tasks costing " << toMS(totalSerial) << "ms of serial time per frame\n";
+    for(const TaskEntry& entry : tasks) {
+      const GameScheduler::TaskTiming& timing = *entry.timing;
+      const std::map<size_t, TableUsage> usage = gatherUsage(entry, dbIndex);
+      stream << "\n" << entry.node->name
+        << ": avg " << toMS(timing.getAverage()) << "ms max " << toMS(timing.max) << "ms over " << timing.samples << " frames\n";
+      if(!timing.access) {
+        stream << "  access was not recorded\n";
+        continue;
+      }
+
+      stream << "  touched " << usage.size() << " of " << db.size() << " tables\n";
+      for(const auto& [tableIndex, tableUsage] : usage) {
+        const TableID& table = db[tableIndex].getID();
+        stream << "  table " << tableIndex;
+        if(std::string_view name = getTableName(db, table); !name.empty()) {
+          stream << " \"" << name << "\"";
+        }
+        stream << " rows " << tableUsage.rows.size();
+        if(tableUsage.modified) {
+          stream << " modified";
+        }
+        if(tableUsage.declared) {
+          stream << " declared";
+        }
+        stream << "\n";
+      }
+
+      if(usage.size() < db.size()) {
+        stream << "  candidate: declare dependencies on these tables with queries and modifiers instead of using the entire database\n";
+      }
+      else {
+        stream << "  touches every table, likely needs to stay synchronous\n";
+      }
+    }
+  }
+
+  bool writeHere(const std::string& location, const GameScheduler::TaskTimings& timings, RuntimeDatabase& db) {
+    std::ofstream stream(location, std::ios::out);
+    if(!stream.good()) {
+      return false;
+    }
+    write(stream, timings, db);
+    return stream.good();
+  }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+class RuntimeDatabase;
+namespace GameScheduler {
+  struct TaskTimings;
+}
+
+//Lists the synchronous tasks in a graph along with the serial time they cost each frame and the tables they actually touched
+//so that those that only need a few tables can be rewritten with declared dependencies
+namespace SynchronousTaskReport {
+  void write(std::ostream& stream, const GameScheduler::TaskTimings& timings, RuntimeDatabase& db);
+  bool writeHere(const std::string& location, const GameScheduler::TaskTimings& timings, RuntimeDatabase& db);
+}
@@ -18,6 +18,9 @@
 #include <module/MassModule.h>
 #include "DebugDrawer.h"
 #include <transform/TransformResolver.h>
+#include "RayPacket.h"
+#include "SweepNPruneBroadphase.h"
+#include "unity.h"
 
 namespace AreaForceStatEffect {
   RuntimeTable& getTable(AppTaskArgs& args) {
@@ -122,65 +125,56 @@ namespace AreaForceStatEffect {
     float remainingPiercingDynamic{};
     float remainingPiercingTerrain{};
   };
-  //[1, 0, tx][rx, lx, 0][sx,  0, 0]
-  //[0, 1, ty][ry, ly, 0][ 0, sy, 0]
-  //[0, 0,  1][0 ,  0, 1][ 0,  0, 1]
-  //Scale*Rotation is this which is what the extents already are
-  //[rx*sx, lx*sy, tx]
-  //[ry*sx, ly*sy, ty]
-  //[    0,     0,  1]
-  glm::mat3 buildTransform(const glm::vec2& translate, const glm::vec2& extentX, const glm::vec2& extentY) {
-    glm::mat3 result;
-    result[0] = glm::vec3(extentX.x, extentX.y, 0.0f);
-    result[1] = glm::vec3(extentY.x, extentY.y, 0.0f);
-    result[2] = glm::vec3(translate.x, translate.y, 1);
-    return result;
+
+  void buildPacket(const std::vector<Ray>& rays, std::vector<size_t>& live, RayPacket::Rays& packet) {
+    live.clear();
+    packet.clear();
+    for(size_t i = 0; i < rays.size(); ++i) {
+      const Ray& ray = rays[i];
+      if(ray.remainingPiercingDynamic >= 0.0f && ray.remainingPiercingTerrain >= 0.0f) {
+        live.push_back(i);
+        packet.push_back(ray.origin, ray.direction);
+      }
+    }
   }
 
   void castRays(std::vector<Ray>& rays, std::vector<ShapeResult>& shapes, std::vector<HitResult>& hits) {
+    //All rays that can still pierce are tested against each shape at once, rebuilt only when a ray runs out
+    std::vector<size_t> live;
+    RayPacket::Rays packet;
+    RayPacket::Hits packetHits;
+    buildPacket(rays, live, packet);
+
     //Iterate over shapes sorted from closest to furthest
     //Using a heap can save time if the search stopped early due to the rays not piercing through all results
     std::make_heap(shapes.begin(), shapes.end());
-    while(!shapes.empty()) {
+    while(!shapes.empty() && !live.empty()) {
       ShapeResult shape = shapes.front();
       std::pop_heap(shapes.begin(), shapes.end());
       shapes.pop_back();
 
       HitResult hit;
       hit.id = shape.id;
-      //Transform rays into local space using this transform so that all intersections can be computed as aabb to line
-      const glm::mat3 transform = buildTransform(shape.pos, shape.extentX, shape.extentY);
-      const glm::mat3 invTransform = glm::affineInverse(transform);
+      //Rays are unbounded so any distance along them is a hit
+      RayPacket::intersectBox(packet, shape.pos, shape.extentX, shape.extentY, std::numeric_limits<float>::max(), packetHits);
 
-      bool anyRaysLeft = false;
-      for(Ray& ray : rays) {
-        if(ray.remainingPiercingDynamic < 0.0f || ray.remainingPiercingTerrain < 0.0f) {
+      bool anyRaysStopped = false;
+      for(size_t r = 0; r < live.size(); ++r) {
+        if(!packetHits.isHit(r)) {
           continue;
         }
-        anyRaysLeft = true;
-        const glm::vec2 localRayBegin = Math::transformPoint(invTransform, ray.origin);
-        const glm::vec2 localRayDirection = Math::transformVector(invTransform, ray.direction);
-
-        float tMin, tMax;
-        if(Math::unitAABBLineIntersect(localRayBegin, localRayDirection, &tMin, &tMax)) {
-          //I think due to scale the t values are only valid in local space, so the results need to be transformed back out
-          hit.hitPoint += Math::transformPoint(transform, localRayBegin + localRayDirection*tMin);
-          //Kind of like transforming the hit point, the exit point, getting their distance, but all in one step
-          const float piercedAmount = glm::length(Math::transformVector(transform, localRayDirection*(tMax - tMin)));
-
-          if(shape.isTerrain) {
-            ray.remainingPiercingTerrain -= piercedAmount;
-          }
-          else {
-            ray.remainingPiercingDynamic -= piercedAmount;
-          }
-          ++hit.hitCount;
-
-          hit.impulse += ray.direction;
-        }
+        Ray& ray = rays[live[r]];
+        hit.hitPoint += ray.origin + ray.direction*packetHits.tIn[r];
+        const float piercedAmount = (packetHits.tOut[r] - packetHits.tIn[r])*glm::length(ray.direction);
+        float& remaining = shape.isTerrain ? ray.remainingPiercingTerrain : ray.remainingPiercingDynamic;
+        remaining -= piercedAmount;
+        anyRaysStopped = anyRaysStopped || remaining < 0.0f;
+        ++hit.hitCount;
+
+        hit.impulse += ray.direction;
       }
-      if(!anyRaysLeft) {
-        break;
+      if(anyRaysStopped) {
+        buildPacket(rays, live, packet);
       }
       //If something hit, add it to the results after averaging the values
       if(hit.hitCount) {
@@ -208,68 +202,93 @@ namespace AreaForceStatEffect {
     }
   }
 
+  //Candidates for the cone come from the broadphase so the cost scales with the objects in the area rather than all objects
   struct ShapesQuery {
-    UnpackedDatabaseElementID table;
-    const Transform::WorldTransformRow* transform{};
-    FloatRow<Tags::GLinImpulse, Tags::X>* impulseX{};
-    FloatRow<Tags::GLinImpulse, Tags::Y>* impulseY{};
-    FloatRow<Tags::GAngImpulse, Tags::Angle>* impulseA{};
-    const MassModule::IsImmobile* isImmobile{};
+    SweepNPruneBroadphase::BroadphaseReader& broadphase;
+    ITableResolver& resolver;
+    ElementRefResolver ids;
+    CachedRow<const Transform::WorldTransformRow> transforms;
+    CachedRow<const IsFragment> isFragment;
+    CachedRow<const MassModule::IsImmobile> isImmobile;
+    std::vector<ElementRef> candidates;
+    std::vector<ShapeResult> candidateShapes;
+    std::vector<float> posX, posY, distance2;
+    std::vector<uint8_t> inside;
   };
 
-  //TODO: replace with SpatialQueries
-  //Gather an unsorted list of objects that are inside or touching the shape
-  void gatherResultsInShape(const Command& command, const Command::Cone& cone, ShapesQuery& query, std::vector<ShapeResult>& results) {
-    const bool isTerrain = query.isImmobile != nullptr;
-    const glm::vec2& coneBase = command.origin;
-    const glm::vec2& coneDir = command.direction;
+  //Bounds of the cone's sector which are the origin, the ends of both edges, and the furthest points of the arc on any axis it crosses
+  void computeConeBounds(const Command& command, const Command::Cone& cone, float padding, glm::vec2& min, glm::vec2& max) {
+    min = max = command.origin;
+    auto add = [&](const glm::vec2& dir) {
+      const glm::vec2 p = command.origin + dir*cone.length;
+      min = glm::min(min, p);
+      max = glm::max(max, p);
+    };
+    add(Math::rotate(command.direction, -cone.halfAngle));
+    add(Math::rotate(command.direction, cone.halfAngle));
     const float inConeAngle = std::cos(cone.halfAngle);
-    const float sinConeAngle = std::abs(std::sin(cone.halfAngle));
+    for(const glm::vec2& axis : { glm::vec2{ 1, 0 }, glm::vec2{ -1, 0 }, glm::vec2{ 0, 1 }, glm::vec2{ 0, -1 } }) {
+      if(glm::dot(axis, command.direction) >= inConeAngle) {
+        add(axis);
+      }
+    }
+    min -= glm::vec2{ padding };
+    max += glm::vec2{ padding };
+  }
+
+  //Gather an unsorted list of fragments that are inside or touching the shape
+  void gatherResultsInShape(const Command& command, const Command::Cone& cone, ShapesQuery& query, std::vector<ShapeResult>& results) {
     //Objects outside of this length are discarded, so add a half extent's worth to that length so
     //objects touching the back edge are still included
     constexpr float objSize = 0.5f;
-    constexpr float objSize2 = objSize*objSize;
-    const float paddedConeLength = cone.length + 0.5f;
-    const float coneLength2 = paddedConeLength*paddedConeLength;
-
-    for(size_t i = 0; i < query.transform->size(); ++i) {
-      const Transform::PackedTransform& transform = query.transform->at(i);
-      const glm::vec2 pos{ transform.pos2() };
-      const glm::vec2 toTarget = pos - coneBase;
-      const float len2 = glm::length2(toTarget);
-      if(len2 > coneLength2) {
+    glm::vec2 min, max;
+    computeConeBounds(command, cone, objSize, min, max);
+    query.candidates.clear();
+    query.broadphase.queryAABB(min, max, Broadphase::QueryMask::all(), query.candidates);
+
+    query.candidateShapes.clear();
+    query.posX.clear();
+    query.posY.clear();
+    for(const ElementRef& candidate : query.candidates) {
+      const auto id = query.ids.tryUnpack(candidate);
+      if(!id || !query.resolver.tryGetOrSwapAllRows(*id, query.transforms, query.isFragment)) {
         continue;
       }
-      //If object is within objSize2 then it is inside the origin of the cone and should be included in results
-      if(len2 > objSize2) {
-        const float targetDot = glm::dot(toTarget, coneDir);
-        const glm::vec2 targetDir = toTarget * (1.0f/std::sqrt(len2));
-        //Cos of the angle is the dot product times the length of both, length of cone dir is one
-        const float targetAngle = targetDot/std::sqrt(len2);
-        //If the mid point isn't in the cone
-        if(targetAngle < inConeAngle) {
-          //Get the projection of the object onto the line through the center of the cone
-          //Since coneDir is normalized this means it's also the distance along the cone,
-          //which is the length of the adjecent edge of the triangle. The length of the opposite
-          //edge is how far away this object can be to still be touching the cone
-          const glm::vec2 projOnConeLine = coneDir*targetDot;
-          const float distToConeLine2 = glm::length2(projOnConeLine - toTarget);
-          //Get the length of the opposite edge of the triangle at the distance using the length obtained
-          //from the adjacent edge
-          const float allowedDistance = sinConeAngle*targetDot + objSize;
-          if(distToConeLine2 > allowedDistance) {
-            continue;
-          }
-        }
+      const Transform::PackedTransform& transform = query.transforms->at(id->getElementIndex());
+      ShapeResult shape;
+      shape.id = *id;
+      shape.pos = transform.pos2();
+      shape.extentX = transform.basisX();
+      shape.extentY = transform.basisY();
+      shape.isTerrain = query.resolver.tryGetOrSwapRow(query.isImmobile, *id);
+      query.candidateShapes.push_back(shape);
+      query.posX.push_back(shape.pos.x);
+      query.posY.push_back(shape.pos.y);
+    }
+
+    const size_t count = query.candidateShapes.size();
+    query.inside.resize(count);
+    query.distance2.resize(count);
+    ispc::gatherInCone(query.posX.data(),
+      query.posY.data(),
+      command.origin.x,
+      command.origin.y,
+      command.direction.x,
+      command.direction.y,
+      std::cos(cone.halfAngle),
+      std::abs(std::sin(cone.halfAngle)),
+      cone.length + objSize,
+      objSize,
+      query.inside.data(),
+      query.distance2.data(),
+      static_cast<uint32_t>(count)
+    );
+    for(size_t i = 0; i < count; ++i) {
+      if(query.inside[i]) {
+        ShapeResult& shape = query.candidateShapes[i];
+        shape.distance = query.distance2[i];
+        results.push_back(shape);
       }
-      ShapeResult hit;
-      hit.id = query.table.remakeElement(i);
-      hit.pos = pos;
-      hit.extentX = transform.basisX();
-      hit.extentY = transform.basisY();
-      hit.isTerrain = isTerrain;
-      hit.distance = len2;
-      results.push_back(hit);
     }
   }
 
@@ -298,13 +317,11 @@ namespace AreaForceStatEffect {
     >();
     DebugLineAdapter debug = TableAdapters::getDebugLines(task);
     using namespace Tags;
-    auto shapesQuery = task.query<
-      const Transform::WorldTransformRow,
-      const IsFragment
-    >();
+    SweepNPruneBroadphase::BroadphaseReader broadphase = SweepNPruneBroadphase::createBroadphaseReader(task);
     auto resolver = task.getResolver<
       const MassModule::IsImmobile,
       const Transform::WorldTransformRow,
+      const IsFragment,
       FloatRow<GLinImpulse, X>, FloatRow<GLinImpulse, Y>,
       FloatRow<GAngImpulse, Angle>,
       const StableIDRow,
@@ -313,7 +330,8 @@ namespace AreaForceStatEffect {
     >();
     const TableID fragmentTable = builder.queryTables<FragmentGoalFoundRow>()[0];
 
-    task.setCallback([ids, query, debug, shapesQuery, resolver, fragmentTable](AppTaskArgs& args) mutable {
+    task.setCallback([ids, query, debug, broadphase, resolver, fragmentTable](AppTaskArgs& args) mutable {
+      ShapesQuery shapesQuery{ broadphase, *resolver, ids->getRefResolver() };
       std::vector<ShapeResult> shapes;
       std::vector<HitResult> hits;
       std::vector<Ray> rays;
@@ -332,16 +350,9 @@ namespace AreaForceStatEffect {
           shapes.clear();
           hits.clear();
           rays.clear();
-          for(size_t s = 0; s < shapesQuery.size(); ++s) {
-            auto&& [transforms, f] = shapesQuery.get(s);
-            const UnpackedDatabaseElementID table = shapesQuery[s];
-            ShapesQuery shapeTable {
-              table, transforms.get(), nullptr, nullptr, nullptr, resolver->tryGetRow<const MassModule::IsImmobile>(table)
-            };
-            std::visit([&](const auto& shape) {
-              gatherResultsInShape(command, shape, shapeTable, shapes);
-            }, command.shape);
-          }
+          std::visit([&](const auto& shape) {
+            gatherResultsInShape(command, shape, shapesQuery, shapes);
+          }, command.shape);
 
           std::visit([&](const auto& shape) {
             buildRaysForShape(command, shape, rays);
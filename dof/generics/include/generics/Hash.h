@@ -1,6 +1,17 @@
 #pragma once
 
 namespace gnx::Hash {
+  //Murmur3 finalizer. Use for keys like indices where std::hash is the identity,
+  //since open addressing tables mask off the low bits and would otherwise cluster
+  constexpr uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+  }
+
   constexpr size_t combineHashes(size_t hashA, size_t hashB) {
     return hashA ^ (hashB << 1);
   }
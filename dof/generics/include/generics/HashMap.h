@@ -79,7 +79,11 @@ namespace gnx {
       return values.begin();
     }
 
-    CIterator cbegin() {
+    CIterator begin() const {
+      return values.cbegin();
+    }
+
+    CIterator cbegin() const {
       return values.cbegin();
     }
 
@@ -87,7 +91,11 @@ namespace gnx {
       return values.end();
     }
 
-    CIterator cend() {
+    CIterator end() const {
+      return values.cend();
+    }
+
+    CIterator cend() const {
       return values.cend();
     }
 
@@ -6,6 +6,7 @@
 #include "Renderer.h"
 #include "ImguiModule.h"
 #include "TableAdapters.h"
+#include "Trace.h"
 
 namespace DebugModule {
   void debugWindow(IAppBuilder& builder) {
@@ -19,6 +20,16 @@ namespace DebugModule {
       }
       ImGui::Begin("Debug");
       ImGui::Checkbox("Draw Fragment AI", &config->fragment.drawAI);
+      bool tracing = Trace::isEnabled();
+      if(ImGui::Checkbox("Trace", &tracing)) {
+        Trace::setEnabled(tracing);
+      }
+      if(tracing) {
+        ImGui::SameLine();
+        if(ImGui::Button("Dump Trace")) {
+          Trace::writeChromeTrace("trace.json", 10);
+        }
+      }
       ImGui::End();
     });
     builder.submitTask(std::move(task));
@@ -12,6 +12,7 @@
 #include "DebugDrawer.h"
 #include "Narrowphase.h"
 #include "Physics.h"
+#include "PhysicsLOD.h"
 #include "SpatialPairsStorage.h"
 #include "ThreadLocals.h"
 #include "Random.h"
@@ -137,7 +138,7 @@ namespace PhysicsModule {
 
           if(mesh.points.size()) {
             //Not all implementations write to buffer, put them here so they can be transformed
-            buffer = mesh.points;
+            buffer.assign(mesh.points.begin(), mesh.points.end());
             for(glm::vec2& p : buffer) {
               p = transform.transformPoint(p);
             }
@@ -173,8 +174,10 @@ namespace PhysicsModule {
     task.setName("Imgui Physics").setPinning(AppTaskPinning::MainThread{});
     Config::PhysicsConfig* config = TableAdapters::getPhysicsConfigMutable(task);
     const bool* enabled = ImguiModule::queryIsEnabled(task);
+    auto cacheStats = task.query<const SP::ManifoldCacheStatsRow>();
+    auto lodStats = task.query<const PhysicsLOD::StatsRow>();
     assert(config);
-    task.setCallback([config, enabled](AppTaskArgs&) mutable {
+    task.setCallback([config, enabled, cacheStats, lodStats](AppTaskArgs&) mutable {
       if(!*enabled) {
         return;
       }
@@ -190,6 +193,24 @@ namespace PhysicsModule {
       ImGui::SliderFloat("Angular Drag", &config->angularDragMultiplier, 0.5f, 1.0f);
       ImGui::SliderFloat("Friction Coefficient", &config->frictionCoeff, 0.0f, 1.0f);
       ImGui::InputInt("Solve Iterations", &config->solveIterations);
+      ImGui::Checkbox("Wide Solver", &config->wideSolver);
+      ImGui::SliderFloat("Manifold Reuse Tolerance", &config->manifoldReuseTolerance, 0.0f, 0.01f, "%.4f");
+      if(const SP::ManifoldCacheStats* stats = cacheStats.tryGetSingletonElement()) {
+        const uint32_t reused = stats->reused;
+        const uint32_t total = reused + stats->generated;
+        ImGui::Text("Manifolds reused %u/%u (%.1f%%)", reused, total, total ? 100.0f*static_cast<float>(reused)/static_cast<float>(total) : 0.0f);
+      }
+      ImguiExt::inputSizeT("Sleep Frames", &config->sleep.frames);
+      ImGui::SliderFloat("Sleep Velocity", &config->sleep.velocity, 0.0f, 0.05f);
+      ImGui::Checkbox("Level of Detail", &config->lod.enabled);
+      if(config->lod.enabled) {
+        ImGui::SliderFloat("Reduced Distance", &config->lod.reducedDistance, 0.0f, 200.0f);
+        ImGui::SliderFloat("Frozen Distance", &config->lod.frozenDistance, 0.0f, 400.0f);
+        ImguiExt::inputSizeT("Reduced Interval", &config->lod.reducedInterval);
+        if(const PhysicsLOD::Stats* stats = lodStats.tryGetSingletonElement()) {
+          ImGui::Text("Bodies full %u reduced %u frozen %u", stats->full, stats->reduced, stats->frozen);
+        }
+      }
       ImGui::Checkbox("Draw Collision Pairs", &config->drawCollisionPairs);
       ImGui::Checkbox("Draw Contacts", &config->drawContacts);
       ImGui::Checkbox("Draw Broadphase", &config->broadphase.draw);
@@ -31,6 +31,12 @@ namespace Geo {
       return result;
     }
 
+    //Touching edges count as overlapping
+    constexpr bool overlaps(const AABB& other) const {
+      return min.x <= other.max.x && other.min.x <= max.x &&
+        min.y <= other.max.y && other.min.y <= max.y;
+    }
+
     constexpr std::array<glm::vec2, 4> points() const {
       return {
         min,
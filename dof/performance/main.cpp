@@ -9,14 +9,101 @@
 #include "TableAdapters.h"
 #include "ThreadLocals.h"
 #include "Profile.h"
+#include "Trace.h"
 #include "Game.h"
 #include "IGame.h"
 #include "IAppModule.h"
 #include <transform/TransformRows.h>
+#include "RuntimeDatabase.h"
+#include "Table.h"
 
 //TODO: this doesn't make much sense anymore
 //Better approach is likely to measure performance of particular imported scenes using the default game db
 namespace Performance {
+  //Stand-in for the renderer that extracts positions into its own table and then "draws" them on the main thread
+  //so that extraction and commit costs show up in the frame rate without needing a graphics device
+  namespace HeadlessRenderer {
+    struct ExtractedPositionsRow : Row<glm::vec2> {};
+    struct DrawResultRow : SharedRow<float> {};
+    using ExtractedTable = Table<ExtractedPositionsRow, DrawResultRow>;
+
+    void extract(IAppBuilder& builder) {
+      auto task = builder.createTask();
+      task.setName("headless extract");
+      auto src = task.query<const Transform::WorldTransformRow>();
+      auto dst = task.query<ExtractedPositionsRow>();
+      std::shared_ptr<ITableModifier> modifier = task.getModifierForTable(dst[0]);
+      task.setCallback([src, dst, modifier](AppTaskArgs&) mutable {
+        size_t total{};
+        for(size_t t = 0; t < src.size(); ++t) {
+          total += src.get<0>(t).size();
+        }
+        modifier->resize(total);
+        ExtractedPositionsRow& positions = dst.get<0>(0);
+        size_t i = 0;
+        src.forEachElement([&](const Transform::PackedTransform& transform) {
+          positions.at(i++) = transform.pos2();
+        });
+      });
+      builder.submitTask(std::move(task));
+    }
+
+    void draw(IAppBuilder& builder) {
+      auto task = builder.createTask();
+      task.setName("headless draw").setPinning(AppTaskPinning::MainThread{});
+      auto q = task.query<const ExtractedPositionsRow, DrawResultRow>();
+      task.setCallback([q](AppTaskArgs&) mutable {
+        auto [positions, result] = q.get(0);
+        //Arbitrary per-element work roughly in the ballpark of building draw data
+        float sum{};
+        for(const glm::vec2& p : *positions) {
+          sum += std::sin(p.x) * std::cos(p.y);
+        }
+        result->at() = sum;
+      });
+      builder.submitTask(std::move(task));
+    }
+
+    void commit(IAppBuilder& builder) {
+      auto task = builder.createTask();
+      task.setName("headless commit").setPinning(AppTaskPinning::MainThread{});
+      auto q = task.query<DrawResultRow>();
+      task.setCallback([q](AppTaskArgs&) mutable {
+        q.get<0>(0).at() = 0.0f;
+      });
+      builder.submitTask(std::move(task));
+    }
+
+    //Mirrors the phases of the real renderer so the serial and pipelined update modes are comparable
+    class Module : public IRenderingModule {
+    public:
+      void createDatabase(RuntimeDatabaseArgs& args) final {
+        DBReflect::addTable<ExtractedTable>(args);
+      }
+
+      void preSimUpdate(IAppBuilder& builder) final {
+        extract(builder);
+        draw(builder);
+      }
+
+      void postSimUpdate(IAppBuilder& builder) final {
+        commit(builder);
+      }
+
+      void preSimDraw(IAppBuilder& builder) final {
+        draw(builder);
+      }
+
+      void postSimDraw(IAppBuilder& builder) final {
+        commit(builder);
+      }
+
+      void postSimExtract(IAppBuilder& builder) final {
+        extract(builder);
+      }
+    };
+  }
+
   struct App {
     std::unique_ptr<IGame> game;
     std::unique_ptr<IAppBuilder> builder;
@@ -24,9 +111,15 @@ namespace Performance {
     std::unique_ptr<ThreadLocalData> data = std::make_unique<ThreadLocalData>();
   };
 
-  App createApp() {
+  //Diagnostics add overhead to every task and row lookup so they are left off for the timed runs
+  App createApp(Game::UpdateMode mode, bool recordDiagnostics) {
     Performance::App app;
-    app.game = Game::createGame(GameDefaults::createDefaultGameArgs());
+    Game::GameArgs args = GameDefaults::createDefaultGameArgs();
+    args.rendering = std::make_unique<HeadlessRenderer::Module>();
+    args.updateMode = mode;
+    args.recordTaskTimings = recordDiagnostics;
+    args.recordSynchronousAccess = recordDiagnostics;
+    app.game = Game::createGame(std::move(args));
 
     app.game->init();
 
@@ -89,37 +182,81 @@ namespace Performance {
     result.average = result.total / timings.size();
     return result;
   }
+
+  struct RunResult {
+    Duration firstUpdate{};
+    TimeStats stats;
+  };
+
+  RunResult run(Game::UpdateMode mode, bool printFrames) {
+    App app = createApp(mode, false);
+
+    initStaticScene(*app.builder, *app.args);
+    constexpr size_t iterations = 1000;
+    std::vector<Duration> timings(iterations);
+
+    //Initial update is way more expensive so track it separately so it doesn't throw off the average
+    RunResult result;
+    result.firstUpdate = update(app);
+
+    for(size_t i = 0; i < iterations; ++i) {
+      timings[i] = update(app);
+      if(printFrames) {
+        printf("%s\n", std::to_string(timings[i]).c_str());
+      }
+    }
+
+    result.stats = computeStats(timings);
+    return result;
+  }
+
+  //Separate untimed run with diagnostics enabled, written to files prefixed with name
+  void writeDiagnostics(Game::UpdateMode mode, const char* name) {
+    App app = createApp(mode, true);
+    initStaticScene(*app.builder, *app.args);
+    constexpr size_t iterations = 10;
+    for(size_t i = 0; i < iterations; ++i) {
+      update(app);
+    }
+    app.game->writeTaskGraph(std::string{ name } + "_graph.gv");
+    app.game->writeSynchronousTaskReport(std::string{ name } + "_synchronous.txt");
+  }
+
+  void printResult(const char* name, const RunResult& result) {
+    const TimeStats& stats = result.stats;
+    const double fps = stats.average ? 1000000000.0 / static_cast<double>(stats.average) : 0.0;
+    printf("Results %s\n"
+      "Start %s\n"
+      "Total %s\n"
+      "Min %s\n"
+      "Max %s\n"
+      "Avg %s\n"
+      "FPS %.2f\n",
+      name,
+      std::to_string(result.firstUpdate).c_str(),
+      std::to_string(stats.total).c_str(),
+      std::to_string(stats.min).c_str(),
+      std::to_string(stats.max).c_str(),
+      std::to_string(stats.average).c_str(),
+      fps
+    );
+  }
 };
 
 int main() {
   using namespace Performance;
   printf("Starting performance test...\n");
-  App app = createApp();
 
-  initStaticScene(*app.builder, *app.args);
-  constexpr size_t iterations = 1000;
-  std::vector<Duration> timings(iterations);
+  const RunResult serial = run(Game::UpdateMode::Serial, true);
+  const RunResult pipelined = run(Game::UpdateMode::Pipelined, false);
 
-  //Initial update is way more expensive so track it separately so it doesn't throw off the average
-  const Duration firstUpdate = update(app);
+  printResult("serial", serial);
+  printResult("pipelined", pipelined);
 
-  for(size_t i = 0; i < 1000; ++i) {
-    timings[i] = update(app);
-    printf("%s\n", std::to_string(timings[i]).c_str());
-  }
+  //Last few frames of the pipelined run, viewable in chrome://tracing or Perfetto
+  Trace::writeChromeTrace("performance_trace.json", 10);
 
-  const auto stats = computeStats(timings);
-  printf("Results\n"
-    "Start %s\n"
-    "Total %s\n"
-    "Min %s\n"
-    "Max %s\n"
-    "Avg %s\n",
-    std::to_string(firstUpdate).c_str(),
-    std::to_string(stats.total).c_str(),
-    std::to_string(stats.min).c_str(),
-    std::to_string(stats.max).c_str(),
-    std::to_string(stats.average).c_str()
-  );
+  writeDiagnostics(Game::UpdateMode::Serial, "performance_serial");
+  writeDiagnostics(Game::UpdateMode::Pipelined, "performance_pipelined");
   return 0;
-}
\ No newline at end of file
+}
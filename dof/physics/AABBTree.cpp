@@ -0,0 +1,447 @@
+#include "Precompile.h"
+#include "AABBTree.h"
+
+#include <cassert>
+
+#include "glm/common.hpp"
+#include "Profile.h"
+#include "AppBuilder.h"
+#include "SweepNPruneBroadphase.h"
+
+namespace Broadphase {
+  namespace AABBTree {
+    struct Bounds {
+      glm::vec2 min{};
+      glm::vec2 max{};
+    };
+
+    Bounds combine(const Node& a, const Node& b) {
+      return { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+    }
+
+    Bounds combine(const Bounds& a, const Node& b) {
+      return { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+    }
+
+    //Perimeter is the 2D equivalent of surface area for the insertion cost heuristic
+    float perimeter(const Bounds& b) {
+      const glm::vec2 size = b.max - b.min;
+      return 2.0f*(size.x + size.y);
+    }
+
+    float perimeter(const Node& n) {
+      return perimeter(Bounds{ n.min, n.max });
+    }
+
+    bool contains(const Bounds& outer, const Bounds& inner) {
+      return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y &&
+        outer.max.x >= inner.max.x && outer.max.y >= inner.max.y;
+    }
+
+    //Touching counts as overlapping to match SweepNPrune
+    bool isOverlapping(const Node& a, const Node& b) {
+      return a.min.x <= b.max.x && b.min.x <= a.max.x &&
+        a.min.y <= b.max.y && b.min.y <= a.max.y;
+    }
+
+    uint32_t allocateNode(Tree& tree) {
+      if(tree.freeList != NONE) {
+        const uint32_t result = tree.freeList;
+        tree.freeList = tree.nodes[result].parent;
+        tree.nodes[result] = Node{};
+        return result;
+      }
+      tree.nodes.emplace_back();
+      return static_cast<uint32_t>(tree.nodes.size() - 1);
+    }
+
+    void freeNode(Tree& tree, uint32_t index) {
+      Node& node = tree.nodes[index];
+      node.parent = tree.freeList;
+      node.left = node.right = NONE;
+      node.height = -1;
+      tree.freeList = index;
+    }
+
+    void replaceChild(Tree& tree, uint32_t parent, uint32_t oldChild, uint32_t newChild) {
+      if(parent == NONE) {
+        tree.root = newChild;
+      }
+      else if(tree.nodes[parent].left == oldChild) {
+        tree.nodes[parent].left = newChild;
+      }
+      else {
+        tree.nodes[parent].right = newChild;
+      }
+    }
+
+    void refit(Tree& tree, uint32_t index) {
+      Node& node = tree.nodes[index];
+      const Node& l = tree.nodes[node.left];
+      const Node& r = tree.nodes[node.right];
+      node.min = glm::min(l.min, r.min);
+      node.max = glm::max(l.max, r.max);
+      node.height = 1 + std::max(l.height, r.height);
+    }
+
+    //Promote the taller child of A to take its place. Of the promoted node's children the taller one stays and the
+    //shorter one moves down to A in place of the promoted node
+    uint32_t rotateUp(Tree& tree, uint32_t iA, bool rightIsTaller) {
+      Node& a = tree.nodes[iA];
+      const uint32_t iUp = rightIsTaller ? a.right : a.left;
+      Node& up = tree.nodes[iUp];
+      const uint32_t iF = up.left;
+      const uint32_t iG = up.right;
+
+      up.left = iA;
+      up.parent = a.parent;
+      a.parent = iUp;
+      replaceChild(tree, up.parent, iA, iUp);
+
+      const bool fTaller = tree.nodes[iF].height > tree.nodes[iG].height;
+      const uint32_t iKeep = fTaller ? iF : iG;
+      const uint32_t iMove = fTaller ? iG : iF;
+      up.right = iKeep;
+      (rightIsTaller ? a.right : a.left) = iMove;
+      tree.nodes[iMove].parent = iA;
+
+      refit(tree, iA);
+      refit(tree, iUp);
+      return iUp;
+    }
+
+    //Rotate if the children differ in height by more than one, returning the new root of this subtree
+    uint32_t balance(Tree& tree, uint32_t iA) {
+      const Node& a = tree.nodes[iA];
+      if(a.isLeaf() || a.height < 2) {
+        return iA;
+      }
+      const int32_t diff = tree.nodes[a.right].height - tree.nodes[a.left].height;
+      if(diff > 1) {
+        return rotateUp(tree, iA, true);
+      }
+      if(diff < -1) {
+        return rotateUp(tree, iA, false);
+      }
+      return iA;
+    }
+
+    void refitUpwards(Tree& tree, uint32_t index) {
+      while(index != NONE) {
+        index = balance(tree, index);
+        refit(tree, index);
+        index = tree.nodes[index].parent;
+      }
+    }
+
+    uint32_t findBestSibling(const Tree& tree, const Bounds& leaf) {
+      uint32_t index = tree.root;
+      while(!tree.nodes[index].isLeaf()) {
+        const Node& node = tree.nodes[index];
+        const float area = perimeter(node);
+        const float combinedArea = perimeter(combine(leaf, node));
+        //Cost of creating a new parent for this node and the new leaf
+        const float cost = 2.0f*combinedArea;
+        //Minimum cost of pushing the leaf further down the tree
+        const float inheritanceCost = 2.0f*(combinedArea - area);
+
+        auto descendCost = [&](uint32_t child) {
+          const Node& c = tree.nodes[child];
+          const float enlarged = perimeter(combine(leaf, c));
+          return (c.isLeaf() ? enlarged : enlarged - perimeter(c)) + inheritanceCost;
+        };
+        const float leftCost = descendCost(node.left);
+        const float rightCost = descendCost(node.right);
+
+        if(cost < leftCost && cost < rightCost) {
+          break;
+        }
+        index = leftCost < rightCost ? node.left : node.right;
+      }
+      return index;
+    }
+
+    void insertLeaf(Tree& tree, uint32_t leaf) {
+      if(tree.root == NONE) {
+        tree.root = leaf;
+        tree.nodes[leaf].parent = NONE;
+        return;
+      }
+
+      const uint32_t sibling = findBestSibling(tree, Bounds{ tree.nodes[leaf].min, tree.nodes[leaf].max });
+      //Allocation may invalidate references so everything below goes through the indices
+      const uint32_t newParent = allocateNode(tree);
+      const uint32_t oldParent = tree.nodes[sibling].parent;
+      tree.nodes[newParent].parent = oldParent;
+      tree.nodes[newParent].left = sibling;
+      tree.nodes[newParent].right = leaf;
+      replaceChild(tree, oldParent, sibling, newParent);
+      tree.nodes[sibling].parent = newParent;
+      tree.nodes[leaf].parent = newParent;
+
+      refitUpwards(tree, newParent);
+    }
+
+    void removeLeaf(Tree& tree, uint32_t leaf) {
+      if(leaf == tree.root) {
+        tree.root = NONE;
+        return;
+      }
+      const uint32_t parent = tree.nodes[leaf].parent;
+      const uint32_t grandParent = tree.nodes[parent].parent;
+      const uint32_t sibling = tree.nodes[parent].left == leaf ? tree.nodes[parent].right : tree.nodes[parent].left;
+
+      //Sibling takes the place of the parent
+      replaceChild(tree, grandParent, parent, sibling);
+      tree.nodes[sibling].parent = grandParent;
+      freeNode(tree, parent);
+
+      refitUpwards(tree, grandParent);
+    }
+
+    void setFatBounds(Tree& tree, Node& leaf, const Bounds& tight) {
+      const glm::vec2 margin{ tree.margin };
+      leaf.min = tight.min - margin;
+      leaf.max = tight.max + margin;
+    }
+
+    //Calls fn with the index of every leaf that overlaps with the given node
+    template<class FN>
+    void foreachOverlap(Tree& tree, const Node& node, FN&& fn) {
+      if(tree.root == NONE) {
+        return;
+      }
+      std::vector<uint32_t>& stack = tree.traversal;
+      stack.clear();
+      stack.push_back(tree.root);
+      while(!stack.empty()) {
+        const uint32_t current = stack.back();
+        stack.pop_back();
+        const Node& c = tree.nodes[current];
+        if(!isOverlapping(c, node)) {
+          continue;
+        }
+        if(c.isLeaf()) {
+          fn(current);
+        }
+        else {
+          stack.push_back(c.left);
+          stack.push_back(c.right);
+        }
+      }
+    }
+
+    void insertRange(Tree& tree,
+      const UserKey* userKeys,
+      BroadphaseKey* outKeys,
+      size_t count) {
+      //Assign the keys a slot but don't create leaves yet since bounds aren't known
+      //This will happen during updateBoundaries
+      Broadphase::insertRange(tree.objects, userKeys, outKeys, count);
+      tree.leaves.resize(tree.objects.userKey.size(), NONE);
+    }
+
+    void eraseRange(Tree& tree,
+      const BroadphaseKey* keys,
+      size_t count) {
+      Broadphase::eraseRange(tree.objects, keys, count);
+      //Leaves can be removed immediately because pair losses are found through the tracked pairs
+      //UserKey gets removed at the end of the next update upon processing pending removals
+      for(size_t i = 0; i < count; ++i) {
+        uint32_t& leaf = tree.leaves[keys[i].value];
+        if(leaf != NONE) {
+          removeLeaf(tree, leaf);
+          freeNode(tree, leaf);
+          leaf = NONE;
+        }
+      }
+    }
+
+    void updateBoundaries(Tree& tree,
+      const float* minX,
+      const float* maxX,
+      const float* minY,
+      const float* maxY,
+      const BroadphaseKey* keys,
+      size_t count) {
+      Broadphase::updateBoundaries(tree.objects, minX, maxX, minY, maxY, keys, count);
+      const glm::vec2 hugeMargin{ tree.margin*4.0f };
+      for(size_t i = 0; i < count; ++i) {
+        //Bounds check mainly for default constructed EMPTY_KEY used for elements that haven't been inserted into broadphase yet
+        const BroadphaseKey key = keys[i];
+        if(key.value >= tree.leaves.size()) {
+          continue;
+        }
+        const Bounds tight{ glm::vec2{ minX[i], minY[i] }, glm::vec2{ maxX[i], maxY[i] } };
+        uint32_t& leaf = tree.leaves[key.value];
+        if(leaf == NONE) {
+          leaf = allocateNode(tree);
+        }
+        else {
+          const Node& existing = tree.nodes[leaf];
+          const Bounds fat{ existing.min, existing.max };
+          //Leave it alone if the fat bounds still contain the object and haven't become excessively large compared to it
+          //The size check is what causes shrinking objects to eventually lose pairs
+          if(contains(fat, tight) && contains(Bounds{ tight.min - hugeMargin, tight.max + hugeMargin }, fat)) {
+            continue;
+          }
+          removeLeaf(tree, leaf);
+        }
+
+        Node& node = tree.nodes[leaf];
+        node.key = key;
+        setFatBounds(tree, node, tight);
+        node.left = node.right = NONE;
+        node.height = 0;
+        if(!node.moved) {
+          node.moved = true;
+          tree.moved.push_back(key);
+        }
+        insertLeaf(tree, leaf);
+      }
+    }
+
+    void queryAABB(const Tree& tree, const glm::vec2& min, const glm::vec2& max, const QueryMask& mask, std::vector<uint32_t>& stack, std::vector<BroadphaseKey>& results) {
+      if(tree.root == NONE) {
+        return;
+      }
+      //Tree's traversal stack is only for the broadphase update, the caller's keeps this safe to call concurrently
+      const Node bounds{ .min = min, .max = max };
+      stack.clear();
+      stack.push_back(tree.root);
+      while(!stack.empty()) {
+        const uint32_t current = stack.back();
+        stack.pop_back();
+        const Node& c = tree.nodes[current];
+        if(!isOverlapping(c, bounds)) {
+          continue;
+        }
+        if(c.isLeaf()) {
+          if(c.key.value < tree.objects.filters.size() && mask.matches(tree.objects.filters[c.key.value].mask)) {
+            results.push_back(c.key);
+          }
+        }
+        else {
+          stack.push_back(c.left);
+          stack.push_back(c.right);
+        }
+      }
+    }
+
+    void recomputeCandidates(Tree& tree, IntermediateLog& log) {
+      PROFILE_SCOPE("physics", "aabbTreeCandidates");
+      //Tracked pairs are lost if either side was removed or either moved and they no longer overlap
+      if(!tree.moved.empty() || !tree.objects.pendingRemoval.empty()) {
+        for(const auto& entry : tree.pairs.trackedPairs) {
+          const SweepKeyPair& pair = entry.first;
+          const uint32_t a = tree.leaves[pair.a.value];
+          const uint32_t b = tree.leaves[pair.b.value];
+          if(a == NONE || b == NONE) {
+            log.losses.push_back(pair);
+          }
+          else if((tree.nodes[a].moved || tree.nodes[b].moved) && !isOverlapping(tree.nodes[a], tree.nodes[b])) {
+            log.losses.push_back(pair);
+          }
+        }
+      }
+
+      for(const BroadphaseKey& key : tree.moved) {
+        const uint32_t leaf = tree.leaves[key.value];
+        //Removed after it moved
+        if(leaf == NONE) {
+          continue;
+        }
+        const Node& self = tree.nodes[leaf];
+        foreachOverlap(tree, self, [&](uint32_t other) {
+          const Node& o = tree.nodes[other];
+          //Skip self and let only one side of a pair of moved leaves report the pair
+          if(other == leaf || (o.moved && o.key < key)) {
+            return;
+          }
+          const SweepKeyPair pair{ key, o.key };
+          if(!tree.pairs.trackedPairs.contains(pair)) {
+            log.gains.push_back(pair);
+          }
+        });
+      }
+
+      for(const BroadphaseKey& key : tree.moved) {
+        if(const uint32_t leaf = tree.leaves[key.value]; leaf != NONE) {
+          tree.nodes[leaf].moved = false;
+        }
+      }
+      tree.moved.clear();
+    }
+
+    void recomputePairs(Tree& tree, SwapLog& output) {
+      IntermediateLog log{ tree.keyGains, tree.keyLosses };
+      log.gains.clear();
+      log.losses.clear();
+      recomputeCandidates(tree, log);
+      Broadphase::logFilterChanges(tree.objects, tree.pairs, output);
+      Broadphase::logPendingRemovals(tree.objects, log, tree.pairs);
+      Broadphase::logChangedPairs(tree.objects, tree.pairs, ConstIntermediateLog{ log.gains, log.losses }, output);
+      Broadphase::processPendingRemovals(tree.objects);
+    }
+
+    void recomputePairs(IAppBuilder& builder) {
+      auto task = builder.createTask();
+      task.setName("recompute broadphase tree pairs");
+      auto& tree = *task.query<SharedRow<Tree>>().tryGetSingletonElement();
+      auto& finalResults = *task.query<SharedRow<SweepNPruneBroadphase::PairChanges>>().tryGetSingletonElement();
+      task.setCallback([&tree, &finalResults](AppTaskArgs&) {
+        //When disabled the results are coming from SweepGrid
+        if(!tree.enabled) {
+          return;
+        }
+        finalResults.mGained.clear();
+        finalResults.mLost.clear();
+        SwapLog results{ finalResults.mGained, finalResults.mLost };
+        recomputePairs(tree, results);
+      });
+      builder.submitTask(std::move(task));
+    }
+  }
+
+  namespace Debug {
+    bool isValidTree(const AABBTree::Tree& tree) {
+      using namespace AABBTree;
+      if(tree.root == NONE) {
+        return std::all_of(tree.leaves.begin(), tree.leaves.end(), [](uint32_t leaf) { return leaf == NONE; });
+      }
+      if(tree.nodes[tree.root].parent != NONE) {
+        return false;
+      }
+      size_t leafCount{};
+      std::vector<uint32_t> stack{ tree.root };
+      while(!stack.empty()) {
+        const uint32_t current = stack.back();
+        stack.pop_back();
+        const Node& node = tree.nodes[current];
+        if(node.isLeaf()) {
+          //Leaf must be the one mapped to its key
+          if(node.height != 0 || node.key.value >= tree.leaves.size() || tree.leaves[node.key.value] != current) {
+            return false;
+          }
+          ++leafCount;
+          continue;
+        }
+        const Node& l = tree.nodes[node.left];
+        const Node& r = tree.nodes[node.right];
+        if(l.parent != current || r.parent != current) {
+          return false;
+        }
+        if(node.height != 1 + std::max(l.height, r.height)) {
+          return false;
+        }
+        if(node.min != glm::min(l.min, r.min) || node.max != glm::max(l.max, r.max)) {
+          return false;
+        }
+        stack.push_back(node.left);
+        stack.push_back(node.right);
+      }
+      //All leaves must be reachable from the root
+      return leafCount == static_cast<size_t>(std::count_if(tree.leaves.begin(), tree.leaves.end(), [](uint32_t leaf) { return leaf != NONE; }));
+    }
+  }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "SweepNPrune.h"
+
+class IAppBuilder;
+
+namespace Broadphase {
+  //Dynamic bounding volume tree as an alternative to SweepGrid that doesn't need a predefined extent or cell size
+  //Leaves store bounds fattened by a margin so that small movements don't need to modify the tree
+  //Pairs are tracked based on overlap of the fat bounds, narrowphase is responsible for the exact test
+  namespace AABBTree {
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    struct Node {
+      bool isLeaf() const {
+        return left == NONE;
+      }
+
+      glm::vec2 min{};
+      glm::vec2 max{};
+      //Parent for nodes in the tree, next free node for those in the free list
+      uint32_t parent{ NONE };
+      uint32_t left{ NONE };
+      uint32_t right{ NONE };
+      //Leaf height is zero, free nodes are -1
+      int32_t height{};
+      //Only meaningful for leaves
+      BroadphaseKey key{};
+      //Leaf was inserted or reinserted since the last recomputePairs
+      bool moved{};
+    };
+
+    struct Tree {
+      ObjectDB objects;
+      PairTracker pairs;
+      std::vector<Node> nodes;
+      //Leaf node index for each BroadphaseKey or NONE if it's not in the tree
+      std::vector<uint32_t> leaves;
+      std::vector<BroadphaseKey> moved;
+      std::vector<uint32_t> traversal;
+      std::vector<SweepKeyPair> keyGains, keyLosses;
+      uint32_t root{ NONE };
+      uint32_t freeList{ NONE };
+      //Amount the leaf bounds are extended by in each direction
+      float margin = 0.5f;
+      //Tree is only updated by the broadphase tasks when enabled, otherwise SweepGrid is used
+      bool enabled{};
+    };
+
+    void insertRange(Tree& tree,
+      const UserKey* userKeys,
+      BroadphaseKey* outKeys,
+      size_t count);
+
+    void eraseRange(Tree& tree,
+      const BroadphaseKey* keys,
+      size_t count);
+
+    //Writes the new bounds and reinserts leaves whose bounds escaped their fat bounds
+    void updateBoundaries(Tree& tree,
+      const float* minX,
+      const float* maxX,
+      const float* minY,
+      const float* maxY,
+      const BroadphaseKey* keys,
+      size_t count);
+
+    //Appends the keys of every leaf whose fat bounds overlap the given bounds and pass the mask of Broadphase::isQueryOverlap
+    //Only reads the tree so any number of threads can query as long as nothing is modifying it
+    //The stack is traversal scratch owned by the caller so repeated queries don't allocate
+    void queryAABB(const Tree& tree, const glm::vec2& min, const glm::vec2& max, const QueryMask& mask, std::vector<uint32_t>& stack, std::vector<BroadphaseKey>& results);
+
+    //Compares moved and removed leaves against the tracked pairs and the tree to log gains and losses
+    void recomputeCandidates(Tree& tree, IntermediateLog& log);
+    //Computes changes since the last call, updates tracked pairs, outputs the resulting events, and processes removals
+    void recomputePairs(Tree& tree, SwapLog& output);
+    void recomputePairs(IAppBuilder& builder);
+  }
+
+  namespace Debug {
+    bool isValidTree(const AABBTree::Tree& tree);
+  }
+}
@@ -291,7 +291,10 @@ namespace Narrowphase {
   }
 
   void boxBox(SP::ContactManifold& manifold, const BoxPair& pair) {
-    const SeparatingAxis bestAxis = getLeastOverlappingAxis(pair);
+    boxBox(manifold, pair, getLeastOverlappingAxis(pair));
+  }
+
+  void boxBox(SP::ContactManifold& manifold, const BoxPair& pair, const SeparatingAxis& bestAxis) {
     if(bestAxis.overlap < 0) {
       return;
     }
@@ -35,4 +35,6 @@ namespace Narrowphase {
   void storeResult(const ClipResult& result, glm::vec2 normal, const glm::vec2& posA, const glm::vec2& posB, bool isOnA, SP::ContactManifold& manifold);
 
   void boxBox(SP::ContactManifold& manifold, const BoxPair& pair);
+  //Generate contacts from an axis already found by getLeastOverlappingAxis
+  void boxBox(SP::ContactManifold& manifold, const BoxPair& pair, const SeparatingAxis& bestAxis);
 };
\ No newline at end of file
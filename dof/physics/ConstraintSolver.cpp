@@ -5,6 +5,7 @@
 #include "PGSSolver.h"
 #include "PGSSolver1D.h"
 #include "Physics.h"
+#include "PhysicsLOD.h"
 #include "SpatialPairsStorage.h"
 #include <math/Geometric.h>
 #include <bitset>
@@ -23,6 +24,7 @@ namespace ConstraintSolver {
       CachedRow<const MassModule::MassRow> individualMass;
       CachedRow<const ConstraintMaskRow> constraintMask;
       CachedRow<const SharedMaterialRow> material;
+      CachedRow<const PhysicsLOD::BodyLODRow> lod;
     };
     struct ShapeResolverCache {
       ShapeResolverCommonCache common;
@@ -53,7 +55,8 @@ namespace ConstraintSolver {
         return task.getResolver<
           const MassModule::MassRow,
           const SharedMaterialRow,
-          const ConstraintMaskRow
+          const ConstraintMaskRow,
+          const PhysicsLOD::BodyLODRow
         >();
       }
 
@@ -98,6 +101,12 @@ namespace ConstraintSolver {
       return ctx.resolver.resolver->tryGetOrSwapRowElement(ctx.cache.linVelZ, id);
     }
 
+    //Bodies without a level of detail are always stepped
+    std::optional<bool> resolveIsStepping(CommonShapeResolverContext& ctx, const UnpackedDatabaseElementID& id) {
+      const PhysicsLOD::BodyLOD* result = ctx.resolver.tryGetOrSwapRowElement(ctx.cache.lod, id);
+      return result ? std::make_optional(result->isStepping()) : std::nullopt;
+    }
+
     ConstraintMask resolveConstraintMask(CommonShapeResolverContext& ctx, const UnpackedDatabaseElementID& id) {
       const ConstraintMask* result = ctx.resolver.tryGetOrSwapRowElement(ctx.cache.constraintMask, id);
       return result ? *result : ConstraintMask{};
@@ -165,6 +174,7 @@ namespace ConstraintSolver {
     SP::ManifoldRow& manifolds;
     SP::ConstraintRow& constraintManifolds;
     const SP::PairTypeRow& pairTypes;
+    SP::IsSleepingRow& sleepingPairs;
     bool bodiesChanged{};
     bool constraintsChanged{};
     bool anyChanged{};
@@ -260,26 +270,38 @@ namespace ConstraintSolver {
       return result;
     }
 
+    //Batches within a color share no dynamic bodies so they can be solved in parallel
+    AppTaskSize getTaskSizeForColor(size_t color) const {
+      AppTaskSize result;
+      result.batchSize = 1;
+      result.workItemCount = coloring.colorBegins[color + 1] - coloring.colorBegins[color];
+      return result;
+    }
+
+    size_t getFirstBatchOfColor(size_t color) const {
+      return coloring.colorBegins[color];
+    }
+
+    size_t colorCount() const {
+      return coloring.colorCount();
+    }
+
     gnx::IndexRangeT<ConstraintIndex> getBatchConstraintRange(size_t batch) const {
-      const ConstraintIndex begin = MAX_CONSTRAINTS_PER_EDGE*static_cast<ConstraintIndex>(initBatchSize*batch);
+      const ConstraintIndex begin = MAX_CONSTRAINTS_PER_EDGE*static_cast<ConstraintIndex>(coloring.batchBegins[batch]);
       return gnx::makeIndexRange(begin, constraintEndIndices[batch]);
     }
 
-    gnx::IndexRange getBatchEdgeRange(size_t batchIndex, size_t edgeCount) {
-      const size_t begin = batchIndex*initBatchSize;
-      return gnx::makeIndexRange(std::min(begin, edgeCount), std::min(begin + initBatchSize, edgeCount));
+    gnx::IndexRange getBatchEdgeRange(size_t batchIndex) const {
+      return gnx::makeIndexRange(coloring.batchBegins[batchIndex], coloring.batchBegins[batchIndex + 1]);
     }
 
     static constexpr ConstraintIndex getMaxConstraintCount(size_t edgeCount) {
       return edgeCount*MAX_CONSTRAINTS_PER_EDGE;
     }
 
-    size_t getNoOfBatches(size_t edgeCount) const {
-      return edgeCount/initBatchSize + 1;
-    }
-
-    void resizeForEdges(size_t edgeCount) {
-      constraintEndIndices.resize(getNoOfBatches(edgeCount));
+    void resizeForBatches() {
+      constraintEndIndices.resize(coloring.batchCount());
+      batchRows.resize(coloring.batchCount());
     }
 
     void setEndIndex(size_t batch, ConstraintIndex end) {
@@ -292,6 +314,20 @@ namespace ConstraintSolver {
 
     size_t initBatchSize{ 200 };
     std::vector<ConstraintIndex> constraintEndIndices;
+    //Batches of edges grouped by color. Created along with the cached edges, which are then sorted to match
+    PGS::BatchColoring coloring;
+    std::vector<std::pair<BodyIndex, BodyIndex>> edgeBodies;
+    std::vector<CachedEdge> sortedEdges;
+    //Constraint rows of each batch grouped for the wide solver if it was enabled when setting up this frame
+    std::vector<PGS::IndependentRows> batchRows;
+    bool useWideSolver{};
+  };
+  struct SleepState {
+    //Consecutive frames where all bodies in the island were below the sleep velocity
+    size_t restingFrames{};
+    bool isAsleep{};
+    //Constraints are driven by gameplay without changing the island, so islands with them never sleep
+    bool hasConstraints{};
   };
   struct IslandSolver {
     void clear() {
@@ -300,6 +336,7 @@ namespace ConstraintSolver {
       contactMappings.clear();
       islandToBodyIndex.clear();
       solver.clear();
+      sleep = {};
     }
 
     //Weird mix of clear and resize because some use push back and some into index directly
@@ -338,6 +375,11 @@ namespace ConstraintSolver {
     PGS::SolverStorage solver;
     std::vector<CachedEdge> cachedEdges;
     std::vector<PGS::SolveResult> solveResults;
+    //Fastest body seen by each thread while storing velocities
+    std::vector<float> maxSpeeds;
+    //Scratch for grouping independent rows on each thread
+    std::vector<std::vector<uint32_t>> bodyLevels;
+    SleepState sleep;
   };
   struct ZSolverPair {
     BodyIndex a{};
@@ -373,9 +415,28 @@ namespace ConstraintSolver {
 
   struct IslandTaskData {
     IslandGraph::IslandIndex islandIndex{};
+    //Edges and nodes in the island, used as an estimate of how long it takes to solve
+    uint32_t cost{};
   };
   struct IslandSolverCollection {
+    //Islands that are at least this expensive get a task of their own, smaller ones are packed together up to this cost
+    static constexpr uint32_t SMALL_ISLAND_BATCH_COST = 200;
+
+    AppTaskSize getTaskSize() const {
+      AppTaskSize result;
+      result.batchSize = 1;
+      result.workItemCount = batchBegins.size() ? batchBegins.size() - 1 : 0;
+      return result;
+    }
+
+    gnx::IndexRange getBatchIslandRange(size_t batch) const {
+      return gnx::makeIndexRange(batchBegins[batch], batchBegins[batch + 1]);
+    }
+
+    //Sorted from most to least expensive so the largest islands start first and the small ones fill in the gaps at the end
     std::vector<IslandTaskData> tasks;
+    //Ranges of tasks solved by each work item
+    std::vector<size_t> batchBegins;
   };
 
   Material combineMaterials(const Material& a, const Material& b) {
@@ -649,18 +710,31 @@ namespace ConstraintSolver {
     task.setCallback([graph, collection, solverConfig](AppTaskArgs&) {
       IslandGraph::rebuildIslands(*graph);
 
-      //Assign a task for each island, and split into multiple tasks if island is huge
-      //TODO: probably smarter way to reuse this
+      //Large islands get a work item of their own and are split further internally, small ones are packed together
+      //so that they don't each pay the cost of a scheduler task
       collection->tasks.clear();
       for(IslandGraph::IslandIndex i = 0; i < static_cast<IslandGraph::IslandIndex>(graph->islands.getValues().size()); ++i) {
         if(!graph->islands.isFree(i) && graph->islands[i].size()) {
-          collection->tasks.push_back({ i });
+          const IslandGraph::Island& island = graph->islands[i];
+          collection->tasks.push_back({ i, island.edgeCount + island.nodeCount });
         }
       }
+      std::sort(collection->tasks.begin(), collection->tasks.end(), [](const IslandTaskData& l, const IslandTaskData& r) {
+        return l.cost == r.cost ? l.islandIndex < r.islandIndex : l.cost > r.cost;
+      });
+      collection->batchBegins.clear();
+      uint32_t batchCost = IslandSolverCollection::SMALL_ISLAND_BATCH_COST;
+      for(size_t i = 0; i < collection->tasks.size(); ++i) {
+        const uint32_t cost = collection->tasks[i].cost;
+        if(batchCost + cost > IslandSolverCollection::SMALL_ISLAND_BATCH_COST) {
+          collection->batchBegins.push_back(i);
+          batchCost = 0;
+        }
+        batchCost += cost;
+      }
+      collection->batchBegins.push_back(collection->tasks.size());
 
-      AppTaskSize taskSize;
-      taskSize.batchSize = 1;
-      taskSize.workItemCount = collection->tasks.size();
+      const AppTaskSize taskSize = collection->getTaskSize();
       for(auto& config : solverConfig) {
         config->setSize(taskSize);
       }
@@ -852,50 +926,88 @@ namespace ConstraintSolver {
       };
       auto resolver = ids->getRefResolver();
       auto [manifolds, constraints, pairTypes] = pairs.get(0);
-      for(size_t i = args.begin; i < args.end; ++i) {
-        const IslandTaskData& task = collection->tasks[i];
-        const IslandGraph::Island& island = graph->islands[task.islandIndex];
-
-        ZIslandSolver& solver = static_cast<IslandStorage&>(*island.userdata).zSolver;
-        //TODO: only clear what has a chance of being untouched by the initialization below
-        solver.clear();
-        //This will likely overshoot because they won't all be overlapping
-        solver.solver.resize(static_cast<BodyIndex>(island.nodeCount + 1), static_cast<ConstraintIndex>(island.edgeCount));
-        insertInfiniteMassBody(solver);
-        ConstraintIndex constraintIndex{};
-
-        uint32_t currentEdge = island.edges;
-        while(currentEdge != IslandGraph::INVALID) {
-          const IslandGraph::Edge& e = graph->edges[currentEdge];
-          insertConstraintType(e, *pairTypes, *manifolds, *constraints, *graph, solver, shapeContext, resolver, globals, constraintIndex);
-          currentEdge = e.islandNext;
-        }
+      for(size_t batch = args.begin; batch < args.end; ++batch) {
+        for(size_t i : collection->getBatchIslandRange(batch)) {
+          const IslandTaskData& task = collection->tasks[i];
+          const IslandGraph::Island& island = graph->islands[task.islandIndex];
+
+          ZIslandSolver& solver = static_cast<IslandStorage&>(*island.userdata).zSolver;
+          //TODO: only clear what has a chance of being untouched by the initialization below
+          solver.clear();
+          //This will likely overshoot because they won't all be overlapping
+          solver.solver.resize(static_cast<BodyIndex>(island.nodeCount + 1), static_cast<ConstraintIndex>(island.edgeCount));
+          insertInfiniteMassBody(solver);
+          ConstraintIndex constraintIndex{};
+
+          uint32_t currentEdge = island.edges;
+          while(currentEdge != IslandGraph::INVALID) {
+            const IslandGraph::Edge& e = graph->edges[currentEdge];
+            insertConstraintType(e, *pairTypes, *manifolds, *constraints, *graph, solver, shapeContext, resolver, globals, constraintIndex);
+            currentEdge = e.islandNext;
+          }
+
+          //Remove any excess. This could be since multiple objects mapped to the infinite mass index, some data was not present,
+          //or their constraint masks indicated they don't want to solve against each-other
+          solver.solver.resize(static_cast<BodyIndex>(solver.bodies.size()), constraintIndex);
+
+          solver.solver.premultiply();
+          //Should always be easy to solve so cap doesn't need to be low
+          solver.solver.maxIterations = 100;
+          PGS1D::SolveContext context{ solver.solver.createContext() };
+          //TODO: consider skipping when there is no warm start. Maybe it's uncommon enough not to be worth it
+          PGS1D::warmStart(context);
+          PGS1D::SolveResult solveResult;
+          do {
+            solveResult = PGS1D::advancePGS(context);
+          } while(!solveResult.isFinished);
 
-        //Remove any excess. This could be since multiple objects mapped to the infinite mass index, some data was not present,
-        //or their constraint masks indicated they don't want to solve against each-other
-        solver.solver.resize(static_cast<BodyIndex>(solver.bodies.size()), constraintIndex);
-
-        solver.solver.premultiply();
-        //Should always be easy to solve so cap doesn't need to be low
-        solver.solver.maxIterations = 100;
-        PGS1D::SolveContext context{ solver.solver.createContext() };
-        //TODO: consider skipping when there is no warm start. Maybe it's uncommon enough not to be worth it
-        PGS1D::warmStart(context);
-        PGS1D::SolveResult solveResult;
-        do {
-          solveResult = PGS1D::advancePGS(context);
-        } while(!solveResult.isFinished);
-
-        //Write out the solved velocities
-        for(ZIslandBody& body : solver.bodies) {
-          if(body) {
-            *body.velocity = context.velocity.getBody(body.solverIndex).linear;
+          //Write out the solved velocities
+          for(ZIslandBody& body : solver.bodies) {
+            if(body) {
+              *body.velocity = context.velocity.getBody(body.solverIndex).linear;
+            }
           }
         }
       }
     });
   }
 
+  bool isWideSolverEnabled(const SolverGlobals& globals) {
+    return globals.useWideSolver && *globals.useWideSolver;
+  }
+
+  //Sorts the cached edges into batches where edges of the same color don't share any dynamic bodies
+  void colorEdges(IslandSolver& solver) {
+    PROFILE_SCOPE("physics", "colorEdges");
+    ConstraintInitData& init = solver.initData;
+    std::vector<CachedEdge>& edges = solver.cachedEdges;
+    //Islands that fit in a single batch are solved on a single thread so there's nothing to race with
+    if(edges.size() <= init.initBatchSize) {
+      init.coloring.batchBegins.assign({ size_t{}, edges.size() });
+      init.coloring.colorBegins.assign({ size_t{}, size_t{ 1 } });
+      return;
+    }
+
+    init.edgeBodies.clear();
+    for(const CachedEdge& edge : edges) {
+      init.edgeBodies.emplace_back(getBodyMapping(edge.bodyA, solver).solverIndex, getBodyMapping(edge.bodyB, solver).solverIndex);
+    }
+    //The infinite mass body can be shared since its velocity is never changed by the constraints
+    PGS::colorBatches(init.coloring,
+      init.edgeBodies.data(),
+      init.edgeBodies.size(),
+      static_cast<BodyIndex>(solver.bodies.size()),
+      init.initBatchSize,
+      INFINITE_MASS_INDEX
+    );
+
+    init.sortedEdges.clear();
+    for(uint32_t i : init.coloring.order) {
+      init.sortedEdges.push_back(edges[i]);
+    }
+    edges.swap(init.sortedEdges);
+  }
+
   //Creates body mappings and caches edges used for creating constraints
   //For the case where bodies were the same caches the edges anyway
   void initCreateBodyMappings(SolveContext& context) {
@@ -908,10 +1020,14 @@ namespace ConstraintSolver {
     if(context.anyChanged) {
       uint32_t currentEdge = context.island.edges;
       context.solver.cachedEdges.clear();
+      context.solver.sleep.hasConstraints = false;
       while(currentEdge != IslandGraph::INVALID) {
         const IslandGraph::Edge& e = context.graph.edges[currentEdge];
         //Use the edge to get the manifold to see if there is anything to solve
         if(e.data < context.manifolds.size()) {
+          if(e.data < context.pairTypes.size() && !SP::isContactPair(context.pairTypes.at(e.data))) {
+            context.solver.sleep.hasConstraints = true;
+          }
           const IslandGraph::NodeUserdata uA = context.graph.nodes[e.nodeA].data;
           const IslandGraph::NodeUserdata uB = context.graph.nodes[e.nodeB].data;
           //TODO: can anything be done to skip non-collisions here? I think not since they need to be checked next time
@@ -924,125 +1040,164 @@ namespace ConstraintSolver {
         }
         currentEdge = e.islandNext;
       }
+      colorEdges(context.solver);
     }
   }
 
-  void initSolvingConstraints(AppTaskArgs& args, SolveContext& context) {
+  //Sizes constraint storage for the cached edges. Done by the caller before any tasks are created so that sizes
+  //of subsequent tasks are known up front and the whole setup can be queued as one chain
+  void initConstraintStorage(SolveContext& context) {
     PROFILE_SCOPE("physics", "initconstraints");
     //In theory something could be reused but the number of contact points might have changed so this needs to be cleared anyway
     context.solver.resetForConstraints(ConstraintInitData::getMaxConstraintCount(context.solver.cachedEdges.size()));
+    context.solver.initData.resizeForBatches();
+  }
 
-    AppTaskSize taskSize;
-    taskSize.batchSize = 1;
-    context.solver.initData.resizeForEdges(context.solver.cachedEdges.size());
-    taskSize.workItemCount = context.solver.initData.size();
-
-    Tasks::TaskHandle t = args.getScheduler()->queueTask([&context](AppTaskArgs& args) {
-      PROFILE_SCOPE("physics", "insertManifold");
-      for(size_t batchIndex = args.begin; batchIndex < args.end; ++batchIndex) {
-        ConstraintIndex currentConstraint = *context.solver.initData.getBatchConstraintRange(batchIndex).begin();
-        for(size_t e : context.solver.initData.getBatchEdgeRange(batchIndex, context.solver.cachedEdges.size())) {
-          const CachedEdge& edge = context.solver.cachedEdges[e];
-          insertConstraintType(context, edge.manifoldIndex, currentConstraint, edge.bodyA, edge.bodyB);
-        }
-        context.solver.initData.setEndIndex(batchIndex, currentConstraint);
+  void insertManifolds(SolveContext& context, size_t begin, size_t end) {
+    PROFILE_SCOPE("physics", "insertManifold");
+    for(size_t batchIndex = begin; batchIndex < end; ++batchIndex) {
+      ConstraintIndex currentConstraint = *context.solver.initData.getBatchConstraintRange(batchIndex).begin();
+      for(size_t e : context.solver.initData.getBatchEdgeRange(batchIndex)) {
+        const CachedEdge& edge = context.solver.cachedEdges[e];
+        insertConstraintType(context, edge.manifoldIndex, currentConstraint, edge.bodyA, edge.bodyB);
       }
-    }, taskSize);
-
-    args.getScheduler()->awaitTasks(&t, 1, {});
+      context.solver.initData.setEndIndex(batchIndex, currentConstraint);
+    }
   }
 
   void initSolving(SolveContext& context) {
-    //If bodies didn't change then refetching their velocities can be done while constraints are built
-    //Otherwise, bodies are built as constraints are traversed
-
     //Fills in the body mapping information needed to fill constraints but not the body velocity information
     initCreateBodyMappings(context);
+    initConstraintStorage(context);
+  }
+
+  void premultiplyBatches(SolveContext& context, PGS::SolveContext& pgsContext, size_t begin, size_t end, size_t threadIndex) {
+    PROFILE_SCOPE("physics", "premultiply");
+    const bool wide = context.solver.initData.useWideSolver;
+    std::vector<uint32_t>& bodyLevels = context.solver.bodyLevels[threadIndex];
+    if(wide && bodyLevels.size() < pgsContext.bodies) {
+      bodyLevels.resize(pgsContext.bodies);
+    }
+    for(size_t i = begin; i < end; ++i) {
+      const auto range = context.solver.initData.getBatchConstraintRange(i);
+      PGS::premultiply(context.solver.solver.constraints, context.solver.solver.bodies, *range.begin(), *range.end());
+      if(wide) {
+        PGS::groupIndependentRows(context.solver.initData.batchRows[i], pgsContext, *range.begin(), *range.end(), bodyLevels);
+      }
+    }
+  }
+
+  void warmStartBatches(SolveContext& context, PGS::SolveContext& pgsContext) {
+    PROFILE_SCOPE("physics", "warm start");
+    for(size_t i = 0; i < context.solver.initData.size(); ++i) {
+      const auto range = context.solver.initData.getBatchConstraintRange(i);
+      PGS::warmStartWithoutPremultiplied(pgsContext, *range.begin(), *range.end());
+    }
+  }
+
+  //Queues everything needed before solver iterations as a single chain of continuations so that no worker
+  //blocks on an intermediate step. The returned tasks must be awaited before solving
+  std::array<Tasks::TaskHandle, 2> queueSolverSetup(SolveContext& context, PGS::SolveContext& pgsContext) {
+    AppTaskSize insertSize;
+    insertSize.batchSize = 1;
+    insertSize.workItemCount = context.solver.initData.size();
     //Fill in constraints and body velocity in parallel
-    std::array initSteps{
-      context.scheduler.queueTask([&](AppTaskArgs& args) { fillIslandBodies(context.solver, context.shapeContext.resolver, context.resolver, args.begin, args.end); }, context.solver.getTaskSizeForBodies()),
-      context.scheduler.queueTask([&](AppTaskArgs& args) { initSolvingConstraints(args, context); }, {})
+    const std::array initSteps{
+      context.scheduler.createTask([&context](AppTaskArgs& args) {
+        fillIslandBodies(context.solver, context.shapeContext.resolver, context.resolver, args.begin, args.end);
+      }, context.solver.getTaskSizeForBodies()),
+      context.scheduler.createTask([&context](AppTaskArgs& args) { insertManifolds(context, args.begin, args.end); }, insertSize)
     };
-    context.scheduler.awaitTasks(initSteps.data(), initSteps.size(), {});
-  }
 
-  void solveIterations(SolveContext& context) {
     const AppTaskSize taskByInitBatches = context.solver.initData.getTaskSizeForBatches();
-    Tasks::TaskHandle setupTasks;
-    {
+    context.solver.bodyLevels.resize(context.scheduler.getThreadCount());
+    context.solver.initData.useWideSolver = isWideSolverEnabled(context.globals);
+    const std::array setupSteps{
       //Premultiply steps write to unrelated constraint rows so can run in parallel with each-other
       //It can also run in parallel to warm start which doesn't use the premultiplied rows
-      setupTasks = context.scheduler.queueTask([&context](AppTaskArgs& args) {
-        PROFILE_SCOPE("physics", "premultiply");
-        for(size_t i = args.begin; i < args.end; ++i) {
-          const auto range = context.solver.initData.getBatchConstraintRange(i);
-          PGS::premultiply(context.solver.solver.constraints, context.solver.solver.bodies, *range.begin(), *range.end());
-        }
-      }, taskByInitBatches);
-    }
-    PGS::SolveContext pgsContext{ context.solver.solver.createContext() };
-    //TODO: consider skipping when there is no warm start. Maybe it's uncommon enough not to be worth it
-    {
+      context.scheduler.createContinuation(initSteps.data(), initSteps.size(), [&context, &pgsContext](AppTaskArgs& args) {
+        premultiplyBatches(context, pgsContext, args.begin, args.end, args.threadIndex);
+      }, taskByInitBatches),
+      //TODO: consider skipping when there is no warm start. Maybe it's uncommon enough not to be worth it
       //Solving is in parallel batches for large enough islands, warm start tries to be more correct by avoiding that race condition
-      const auto t = context.scheduler.queueTask([&context, &pgsContext](AppTaskArgs&) {
-        PROFILE_SCOPE("physics", "warm start");
-        for(size_t i = 0; i < context.solver.initData.size(); ++i) {
-          const auto range = context.solver.initData.getBatchConstraintRange(i);
-          PGS::warmStartWithoutPremultiplied(pgsContext, *range.begin(), *range.end());
+      context.scheduler.createContinuation(initSteps.data(), initSteps.size(), [&context, &pgsContext](AppTaskArgs&) {
+        warmStartBatches(context, pgsContext);
+      }, AppTaskSize{})
+    };
+    context.scheduler.startTasks(initSteps.data(), initSteps.size());
+    return setupSteps;
+  }
+
+  void solveBatches(SolveContext& context, PGS::SolveContext& pgsContext, size_t begin, size_t end, PGS::SolveResult& result) {
+    PROFILE_SCOPE("physics", "solveStep");
+    const ConstraintInitData& initData = context.solver.initData;
+    for(size_t batch = begin; batch < end; ++batch) {
+      const auto range = initData.getBatchConstraintRange(batch);
+      auto res = initData.useWideSolver ? PGS::advancePGSWide(pgsContext, initData.batchRows[batch]) : PGS::advancePGS(pgsContext, *range.begin(), *range.end());
+      //Max like advancePGS does within a range so the total doesn't depend on how batches were split across threads
+      result.remainingError = std::max(result.remainingError, res.remainingError);
+    }
+  }
+
+  void updateFrictionBounds(SolveContext& context, PGS::SolveContext& pgsContext) {
+    if(context.globals.useConstantFriction) {
+      return;
+    }
+    for(size_t i = 0; i < context.solver.contactMappings.size(); ++i) {
+      const ContactMapping& mapping = context.solver.contactMappings[i];
+      mapping.visit([&](const ContactMapping::Indices& indices) {
+        if(indices.frictionIndex) {
+          //Friction force is proportional to normal force, update the bounds based on the currently
+          //applied normal force
+          const float normalForce = std::abs(pgsContext.lambda[indices.contactIndex])*mapping.combinedMaterial.frictionCoefficient;
+          context.solver.solver.setLambdaBounds(*indices.frictionIndex, -normalForce, normalForce);
         }
-      }, AppTaskSize{});
-      context.scheduler.linkTasks(setupTasks, t, {});
+      });
     }
+  }
+
+  void solveIterations(SolveContext& context, PGS::SolveContext& pgsContext, std::array<Tasks::TaskHandle, 2>& setupTasks) {
+    const ConstraintInitData& initData = context.solver.initData;
     PGS::SolveResult solveResult;
-    //Process giant islands in ranges. This is not physically correct but allows still spreading out the work
-    //even if many objects end up in a single island. This will be a race condition for the bodies that happen
-    //to be on the boundary of both threads. If we're lucky they happen to not overlap
+    //Giant islands are split into batches colored so that batches of the same color don't share any dynamic bodies
+    //Each color is solved in parallel then the next color starts. Since no body is written by two batches at once
+    //the result doesn't depend on the thread count or the order the batches happen to run in
     context.solver.solveResults.clear();
     context.solver.solveResults.resize(context.scheduler.getThreadCount());
 
-    context.scheduler.awaitTasks(&setupTasks, 1, {});
+    context.scheduler.awaitTasks(setupTasks.data(), setupTasks.size(), {});
 
     do {
-      Tasks::TaskHandle solveIteration = context.scheduler.queueTask([&](AppTaskArgs& args) {
-        PROFILE_SCOPE("physics", "solveStep");
-        PGS::SolveResult& result = context.solver.solveResults[args.threadIndex];
-        for(size_t i = args.begin; i < args.end; ++i) {
-          const auto range = context.solver.initData.getBatchConstraintRange(i);
-          auto res = PGS::advancePGS(pgsContext, *range.begin(), *range.end());
-          result.remainingError += res.remainingError;
-        }
-      }, taskByInitBatches);
+      for(size_t color = 0; color < initData.colorCount(); ++color) {
+        const size_t firstBatch = initData.getFirstBatchOfColor(color);
+        Tasks::TaskHandle solveColor = context.scheduler.queueTask([&, firstBatch](AppTaskArgs& args) {
+          solveBatches(context, pgsContext, firstBatch + args.begin, firstBatch + args.end, context.solver.solveResults[args.threadIndex]);
+        }, initData.getTaskSizeForColor(color));
 
-      context.scheduler.awaitTasks(&solveIteration, 1, {});
+        context.scheduler.awaitTasks(&solveColor, 1, {});
+      }
 
       for(PGS::SolveResult& threadResult : context.solver.solveResults) {
-        solveResult.remainingError += threadResult.remainingError;
+        solveResult.remainingError = std::max(solveResult.remainingError, threadResult.remainingError);
         threadResult.remainingError = 0;
       }
       PGS::advanceIteration(pgsContext, solveResult);
-
-      if(!context.globals.useConstantFriction) {
-        for(size_t i = 0; i < context.solver.contactMappings.size(); ++i) {
-          const ContactMapping& mapping = context.solver.contactMappings[i];
-          mapping.visit([&](const ContactMapping::Indices& indices) {
-            if(indices.frictionIndex) {
-              //Friction force is proportional to normal force, update the bounds based on the currently
-              //applied normal force
-              const float normalForce = std::abs(pgsContext.lambda[indices.contactIndex])*mapping.combinedMaterial.frictionCoefficient;
-              context.solver.solver.setLambdaBounds(*indices.frictionIndex, -normalForce, normalForce);
-            }
-          });
-        }
-      }
+      updateFrictionBounds(context, pgsContext);
     } while(!solveResult.isFinished);
   }
 
-  void storeBodyVelocities(AppTaskArgs& args, SolveContext& context, PGS::SolveContext& pgsContext) {
+  //Linear and angular speed are compared against the same threshold
+  float getSleepSpeed(const glm::vec2& linear, float angular) {
+    return std::max(glm::length(linear), std::abs(angular));
+  }
+
+  void storeBodyVelocities(SolveContext& context, PGS::SolveContext& pgsContext, size_t begin, size_t end, size_t threadIndex) {
     PROFILE_SCOPE("physics", "storeVelocities");
-    for(size_t i = args.begin; i < args.end; ++i) {
+    float& maxSpeed = context.solver.maxSpeeds[threadIndex];
+    for(size_t i = begin; i < end; ++i) {
       if(IslandBody& body = context.solver.bodies[i]) {
         PGS::BodyVelocity v = pgsContext.velocity.getBody(body.solverIndex);
-        //TODO: accumulate this energy to check for sleep elligibility
+        maxSpeed = std::max(maxSpeed, getSleepSpeed(v.linear, v.angular));
         *body.velocityX = v.linear.x;
         *body.velocityY = v.linear.y;
         *body.angularVelocity = v.angular;
@@ -1050,9 +1205,9 @@ namespace ConstraintSolver {
     }
   }
 
-  void storeWarmStarts(AppTaskArgs& args, SolveContext& context) {
+  void storeWarmStarts(SolveContext& context, size_t begin, size_t end) {
     PROFILE_SCOPE("physics", "storeWarmStarts");
-    for(size_t b = args.begin; b < args.end; ++b) {
+    for(size_t b = begin; b < end; ++b) {
       for(ConstraintIndex c : context.solver.initData.getBatchConstraintRange(b)) {
         if(float* storage = context.solver.warmStartStorage[c]) {
           *storage = context.solver.solver.constraints.lambda[c];
@@ -1061,6 +1216,179 @@ namespace ConstraintSolver {
     }
   }
 
+  bool isSleepEnabled(const SolverGlobals& globals) {
+    return globals.sleepVelocity && globals.sleepFrames && *globals.sleepFrames;
+  }
+
+  void setPairsSleeping(SolveContext& context, bool isSleeping) {
+    for(const CachedEdge& edge : context.solver.cachedEdges) {
+      if(edge.manifoldIndex < context.sleepingPairs.size()) {
+        context.sleepingPairs.at(edge.manifoldIndex) = static_cast<uint8_t>(isSleeping);
+      }
+    }
+  }
+
+  //Visits the velocity of every body with mass in the island. Solver bodies can't be used for this since they are only
+  //created for bodies reached through edges, which excludes islands that are a single node
+  template<class Func>
+  void forEachIslandVelocity(SolveContext& context, const Func& func) {
+    Resolver::CommonShapeResolverContext common{ Resolver::CommonShapeResolverContext::create(context.shapeContext) };
+    for(uint32_t n = context.island.nodes; n != IslandGraph::INVALID; n = context.graph.nodes[n].islandNext) {
+      if(auto resolved = context.resolver.tryUnpack(context.graph.nodes[n].data)) {
+        if(BodyVelocity v = Resolver::resolveBodyVelocity(context.shapeContext, *resolved); v && Resolver::resolveBodyMass(common, *resolved)) {
+          func(v);
+        }
+      }
+    }
+  }
+
+  void zeroVelocities(SolveContext& context) {
+    forEachIslandVelocity(context, [](BodyVelocity& v) {
+      *v.linearX = *v.linearY = *v.angular = 0.0f;
+    });
+  }
+
+  //Used when there were no constraints to solve so the speeds weren't gathered while storing the solved velocities
+  float getMaxSpeed(SolveContext& context) {
+    float result{};
+    forEachIslandVelocity(context, [&result](BodyVelocity& v) {
+      result = std::max(result, getSleepSpeed({ *v.linearX, *v.linearY }, *v.angular));
+    });
+    return result;
+  }
+
+  //Sleeping bodies had their velocities zeroed when they fell asleep, so anything nonzero now was written since then
+  //by gameplay, impulses, or acceleration. Narrowphase clears the sleeping flag of pairs whose bodies were moved directly
+  bool shouldWake(SolveContext& context) {
+    PROFILE_SCOPE("physics", "checkSleeping");
+    bool result{};
+    forEachIslandVelocity(context, [&result](BodyVelocity& v) {
+      result = result || *v.linearX != 0.0f || *v.linearY != 0.0f || *v.angular != 0.0f;
+    });
+    for(const CachedEdge& edge : context.solver.cachedEdges) {
+      if(edge.manifoldIndex < context.sleepingPairs.size() && !context.sleepingPairs.at(edge.manifoldIndex)) {
+        result = true;
+      }
+    }
+    return result;
+  }
+
+  void wakeUp(SolveContext& context) {
+    context.solver.sleep.isAsleep = false;
+    context.solver.sleep.restingFrames = 0;
+    //Also needed for awake islands that changed since they may have absorbed edges from a sleeping one
+    setPairsSleeping(context, false);
+  }
+
+  void updateSleep(SolveContext& context, float maxSpeed) {
+    SleepState& sleep = context.solver.sleep;
+    if(!isSleepEnabled(context.globals) || sleep.hasConstraints) {
+      return;
+    }
+    if(maxSpeed > *context.globals.sleepVelocity) {
+      sleep.restingFrames = 0;
+    }
+    else if(++sleep.restingFrames >= *context.globals.sleepFrames) {
+      sleep.isAsleep = true;
+      zeroVelocities(context);
+      setPairsSleeping(context, true);
+    }
+  }
+
+  //For islands that fit in a single batch of constraints and bodies the scheduler overhead of the parallel steps
+  //costs more than the work itself
+  bool shouldSolveInline(const IslandSolver& solver) {
+    return solver.initData.size() <= 1 && solver.bodies.size() <= solver.getTaskSizeForBodies().batchSize;
+  }
+
+  //Same steps as queueSolverSetup and solveIterations but all on the calling thread
+  void solveInline(SolveContext& context, PGS::SolveContext& pgsContext, size_t threadIndex) {
+    PROFILE_SCOPE("physics", "solveInline");
+    IslandSolver& solver = context.solver;
+    const size_t batchCount = solver.initData.size();
+    fillIslandBodies(solver, context.shapeContext.resolver, context.resolver, 0, solver.bodies.size());
+    insertManifolds(context, 0, batchCount);
+    solver.bodyLevels.resize(context.scheduler.getThreadCount());
+    solver.initData.useWideSolver = isWideSolverEnabled(context.globals);
+    premultiplyBatches(context, pgsContext, 0, batchCount, threadIndex);
+    warmStartBatches(context, pgsContext);
+    if(!solver.solver.constraintCount()) {
+      updateSleep(context, getMaxSpeed(context));
+      return;
+    }
+
+    PGS::SolveResult solveResult;
+    do {
+      solveBatches(context, pgsContext, 0, batchCount, solveResult);
+      PGS::advanceIteration(pgsContext, solveResult);
+      updateFrictionBounds(context, pgsContext);
+    } while(!solveResult.isFinished);
+
+    solver.maxSpeeds.assign(context.scheduler.getThreadCount(), 0.0f);
+    storeBodyVelocities(context, pgsContext, 0, solver.bodies.size(), threadIndex);
+    storeWarmStarts(context, 0, batchCount);
+    updateSleep(context, solver.maxSpeeds[threadIndex]);
+  }
+
+  //Islands where every body is waiting for its next reduced level of detail step keep their velocities until then
+  bool isWaitingForLODStep(SolveContext& context) {
+    Resolver::CommonShapeResolverContext common{ Resolver::CommonShapeResolverContext::create(context.shapeContext) };
+    bool result{};
+    for(uint32_t n = context.island.nodes; n != IslandGraph::INVALID; n = context.graph.nodes[n].islandNext) {
+      if(auto resolved = context.resolver.tryUnpack(context.graph.nodes[n].data)) {
+        if(std::optional<bool> stepping = Resolver::resolveIsStepping(common, *resolved)) {
+          if(*stepping) {
+            return false;
+          }
+          result = true;
+        }
+      }
+    }
+    return result;
+  }
+
+  void solveXYIsland(SolveContext& context, size_t threadIndex) {
+    //Sleeping islands are skipped entirely until something changes. Their velocities are still zero from falling asleep
+    if(context.solver.sleep.isAsleep && isSleepEnabled(context.globals) && !context.anyChanged && !shouldWake(context)) {
+      return;
+    }
+    //Islands that changed were assigned their level of detail before they did so are solved to be safe
+    if(!context.anyChanged && isWaitingForLODStep(context)) {
+      return;
+    }
+
+    //Storage is sized up front so the context pointers remain valid for all tasks in the chain
+    initSolving(context);
+    if(context.solver.sleep.isAsleep || context.anyChanged) {
+      wakeUp(context);
+    }
+    PGS::SolveContext pgsContext{ context.solver.solver.createContext() };
+    if(shouldSolveInline(context.solver)) {
+      solveInline(context, pgsContext, threadIndex);
+      return;
+    }
+    std::array<Tasks::TaskHandle, 2> setupTasks = queueSolverSetup(context, pgsContext);
+    if(!context.solver.solver.constraintCount()) {
+      //Nothing to solve but the chain still needs to finish before the storage is reused
+      context.scheduler.awaitTasks(setupTasks.data(), setupTasks.size(), {});
+      updateSleep(context, getMaxSpeed(context));
+      return;
+    }
+
+    solveIterations(context, pgsContext, setupTasks);
+
+    {
+      //Write out the solved velocities
+      context.solver.maxSpeeds.assign(context.scheduler.getThreadCount(), 0.0f);
+      std::array storeTasks{
+        context.scheduler.queueTask([&](AppTaskArgs& args) { storeBodyVelocities(context, pgsContext, args.begin, args.end, args.threadIndex); }, context.solver.getTaskSizeForBodies()),
+        context.scheduler.queueTask([&](AppTaskArgs& args) { storeWarmStarts(context, args.begin, args.end); }, context.solver.initData.getTaskSizeForBatches())
+      };
+      context.scheduler.awaitTasks(storeTasks.data(), storeTasks.size(), {});
+    }
+    updateSleep(context, *std::max_element(context.solver.maxSpeeds.begin(), context.solver.maxSpeeds.end()));
+  }
+
   void solveIsland(IAppBuilder& builder, const SolverGlobals& globals) {
     auto task = builder.createTask();
     task.setName("solve islands");
@@ -1077,7 +1405,8 @@ namespace ConstraintSolver {
     auto pairs = task.query<
       SP::ManifoldRow,
       SP::ConstraintRow,
-      const SP::PairTypeRow
+      const SP::PairTypeRow,
+      SP::IsSleepingRow
     >();
     Resolver::ShapeResolver shapes{ Resolver::ShapeResolver::createXYResolver(task) };
     auto ids = task.getIDResolver();
@@ -1085,43 +1414,29 @@ namespace ConstraintSolver {
     task.setCallback([shapes, pairs, graph, collection, ids, globals](AppTaskArgs& args) mutable {
       Resolver::ShapeResolverCache cache;
       Resolver::ShapeResolverContext shapeContext{ shapes, cache };
-      auto [manifolds, constraints, pairTypes] = pairs.get(0);
+      auto [manifolds, constraints, pairTypes, sleepingPairs] = pairs.get(0);
       auto resolver = ids->getRefResolver();
-      for(size_t i = args.begin; i < args.end; ++i) {
-        const IslandTaskData& task = collection->tasks[i];
-        const IslandGraph::Island& island = graph->islands[task.islandIndex];
-        SolveContext context {
-          island,
-          *graph,
-          globals,
-          *args.getScheduler(),
-          shapeContext,
-          resolver,
-          static_cast<IslandStorage&>(*island.userdata).xySolver,
-          *manifolds,
-          *constraints,
-          *pairTypes,
-          graph->publishedIslandNodesChanged[task.islandIndex],
-          graph->publishedIslandEdgesChanged[task.islandIndex]
-        };
-        context.anyChanged = context.bodiesChanged || context.constraintsChanged;
-
-        initSolving(context);
-        if(!context.solver.solver.constraintCount()) {
-          continue;
-        }
-
-        solveIterations(context);
-
-        PGS::SolveContext pgsContext{ context.solver.solver.createContext() };
-
-        {
-          //Write out the solved velocities
-          std::array storeTasks{
-            args.getScheduler()->queueTask([&](AppTaskArgs& args) { storeBodyVelocities(args, context, pgsContext); }, context.solver.getTaskSizeForBodies()),
-            args.getScheduler()->queueTask([&](AppTaskArgs& args) { storeWarmStarts(args, context); }, context.solver.initData.getTaskSizeForBatches())
+      for(size_t batch = args.begin; batch < args.end; ++batch) {
+        for(size_t i : collection->getBatchIslandRange(batch)) {
+          const IslandTaskData& task = collection->tasks[i];
+          const IslandGraph::Island& island = graph->islands[task.islandIndex];
+          SolveContext context {
+            island,
+            *graph,
+            globals,
+            *args.getScheduler(),
+            shapeContext,
+            resolver,
+            static_cast<IslandStorage&>(*island.userdata).xySolver,
+            *manifolds,
+            *constraints,
+            *pairTypes,
+            *sleepingPairs,
+            graph->publishedIslandNodesChanged[task.islandIndex],
+            graph->publishedIslandEdgesChanged[task.islandIndex]
           };
-          args.getScheduler()->awaitTasks(storeTasks.data(), storeTasks.size(), {});
+          context.anyChanged = context.bodiesChanged || context.constraintsChanged;
+          solveXYIsland(context, args.threadIndex);
         }
       }
     });
@@ -17,6 +17,13 @@ namespace ConstraintSolver {
     //Not physically accurate but more stabile and cheaper
     //Uses a constant friction value rather than being a proportion of the normal force
     bool useConstantFriction = true;
+    //Islands are put to sleep after all their bodies are below sleepVelocity for sleepFrames in a row
+    //and woken by island changes, any velocity written to their bodies, or their bodies being moved. Null or zero frames disables sleeping
+    const float* sleepVelocity{};
+    const size_t* sleepFrames{};
+    //Solves rows that don't share bodies simultaneously with SIMD, otherwise one at a time
+    //Results are equivalent within a small tolerance since the wide kernel may fuse multiply-adds
+    const bool* useWideSolver{};
   };
   struct Material {
     //Proportion of the normal force that is used to negate motion orthogonal to the normal
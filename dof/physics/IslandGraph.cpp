@@ -77,11 +77,18 @@ namespace IslandGraph {
 
       for(const Island& island : graph.islands) {
         uint32_t ei = island.edges;
+        uint32_t prev = IslandGraph::INVALID;
+        uint32_t count = 0;
         const IslandIndex islandIndex = static_cast<IslandIndex>(&island - graph.islands.getValues().data());
         while(ei != IslandGraph::INVALID) {
           if(!graph.edges.isValid(ei)) {
             return returnNotValid("Invalid edge on island");
           }
+          if(graph.edges[ei].islandPrev != prev) {
+            return returnNotValid("Incorrect previous edge in island");
+          }
+          prev = ei;
+          ++count;
 
           //Validate the edge itself
           const Edge& e = graph.edges[ei];
@@ -120,8 +127,14 @@ namespace IslandGraph {
           ei = e.islandNext;
         }
 
+        if(count != island.edgeCount) {
+          return returnNotValid("Incorrect edge count");
+        }
+
         //Make sure that all the nodes found in edge traversal are also found in node traversal
         uint32_t ni = island.nodes;
+        prev = IslandGraph::INVALID;
+        count = 0;
         //Root is always expected and may not show up in any edges if this node is by itself in an island
         nodesInIsland.insert(&graph.nodes[ni]);
         while(ni != IslandGraph::INVALID) {
@@ -129,6 +142,11 @@ namespace IslandGraph {
             return returnNotValid("Invalid node in island");
           }
           const Node& n = graph.nodes[ni];
+          if(n.islandPrev != prev) {
+            return returnNotValid("Incorrect previous node in island");
+          }
+          prev = ni;
+          ++count;
           if(n.propagation) {
             //Erase from node list so final count can be validated
             if(!nodesInIsland.erase(&n)) {
@@ -146,6 +164,9 @@ namespace IslandGraph {
         if(nodesInIsland.size()) {
           return returnNotValid("Node in edge list but not in node list");
         }
+        if(count != island.nodeCount) {
+          return returnNotValid("Incorrect node count");
+        }
         nodesInIsland.clear();
       }
 
@@ -216,242 +237,368 @@ namespace IslandGraph {
     return false;
   }
 
-  constexpr uint32_t NOT_VISITED = std::numeric_limits<uint32_t>::max() - 2;
-
-  bool populateIsland(Graph& graph, Island& island, IslandIndex islandIndex) {
-    bool didChange = false;
-    std::vector<uint32_t>& nodesTodo = graph.scratchBuffer;
-    std::vector<uint32_t>& oldNoPropagateNodes = graph.scratchIslands;
-    oldNoPropagateNodes.clear();
-    const uint32_t islandRootIndex = island.nodes;
-    const uint32_t oldCount = island.nodeCount;
-    island.edgeCount = island.nodeCount = 0;
-    island.edges = INVALID;
-    island.nodes = INVALID;
-    island.noPropagateNodes.swap(oldNoPropagateNodes);
-    if(islandRootIndex == INVALID) {
-      return didChange;
-    }
-
-    //If this was already traversed from a previous island skip it
-    if(graph.visitedNodes[islandRootIndex]) {
-      return didChange;
-    }
-
-    nodesTodo.push_back(islandRootIndex);
-    Island& currentIsland = island;
-    uint32_t* lastNode = &currentIsland.nodes;
-    uint32_t* lastEdge = &currentIsland.edges;
-
-    //For each node in the island
-    while(nodesTodo.size()) {
-      const size_t currentIndex = nodesTodo.back();
-      Node& node = graph.nodes.getValues()[currentIndex];
-      nodesTodo.pop_back();
-      //Nodes without propagation are only visited from others. So they'll show up in the island
-      //if another node has an edge to it but edges between two non-propagating nodes won't
-      if(graph.visitedNodes[currentIndex] || graph.nodes.isFree(currentIndex)) {
-        continue;
-      }
+  //Nodes and edges are both in doubly linked lists for their island using islandNext and islandPrev
+  template<class T>
+  void pushIslandList(gnx::VectorFreeList<T>& values, uint32_t& head, uint32_t& count, uint32_t index) {
+    T& value = values[index];
+    value.islandPrev = INVALID;
+    value.islandNext = head;
+    if(head != INVALID) {
+      values[head].islandPrev = index;
+    }
+    head = index;
+    ++count;
+  }
 
-      if(!node.propagation) {
-        //Sorted insert without duplicates
-        auto it = std::lower_bound(island.noPropagateNodes.begin(), island.noPropagateNodes.end(), currentIndex);
-        if(it == island.noPropagateNodes.end() || *it != currentIndex) {
-          island.noPropagateNodes.insert(it, currentIndex);
-        }
-        continue;
-      }
-      //Add node to linked list for this island
-      node.islandNext = *lastNode;
-      graph.visitedNodes[currentIndex] = true;
-      *lastNode = currentIndex;
-
-      currentIsland.nodeCount++;
-
-      //Skip entries for nodes that don't propagate
-      if(node.propagation) {
-        if(node.islandIndex != islandIndex) {
-          node.islandIndex = islandIndex;
-          didChange = true;
-        }
-        uint32_t currentEntry = node.edges;
-        //Iterate over all edges connected to the current node
-        while(currentEntry != INVALID) {
-          const EdgeEntry& entry = graph.edgeEntries.getValues()[currentEntry];
-          Edge& edge = graph.edges.getValues()[entry.edge];
-          //Add edge to linked list if it hasn't been traversed already
-          if(!graph.visitedEdges[entry.edge]) {
-            //Add the other node for visitation
-            nodesTodo.push_back(edge.nodeA == currentIndex ? edge.nodeB : edge.nodeA);
-            currentIsland.edgeCount++;
-
-            edge.islandNext = *lastEdge;
-            graph.visitedEdges[entry.edge] = true;
-            *lastEdge = entry.edge;
-            lastEdge = &edge.islandNext;
-          }
-          currentEntry = entry.nextEntry;
-        }
-      }
-      else {
-        //No island ownership for nodes that don't propagate as they can be on the border of multiple islands
-        node.islandIndex = INVALID_ISLAND;
-      }
+  template<class T>
+  void eraseIslandList(gnx::VectorFreeList<T>& values, uint32_t& head, uint32_t& count, uint32_t index) {
+    T& value = values[index];
+    if(value.islandPrev != INVALID) {
+      values[value.islandPrev].islandNext = value.islandNext;
     }
-    if(oldCount != island.nodeCount || oldNoPropagateNodes != island.noPropagateNodes) {
-      didChange = true;
+    else {
+      head = value.islandNext;
     }
-    return didChange;
+    if(value.islandNext != INVALID) {
+      values[value.islandNext].islandPrev = value.islandPrev;
+    }
+    value.islandNext = value.islandPrev = INVALID;
+    --count;
   }
 
   void addNewIsland(Graph& graph, IslandIndex islandIndex) {
     assert(graph.islands.getValues().size() < INVALID_ISLAND);
     assert(graph.changedIslands.size() == islandIndex);
     graph.changedIslands.push_back(false);
-    graph.publishedIslandEdgesChanged.push_back(true);
-    graph.publishedIslandNodesChanged.push_back(true);
-    graph.forceChangedIslands.push_back(false);
+    graph.changedIslandNodes.push_back(false);
   }
 
-  void rebuildIslands(Graph& graph) {
-    graph.scratchBuffer.clear();
-
-    graph.visitedNodes.clear();
-    graph.visitedNodes.resize(graph.nodes.getValues().size(), false);
-    graph.visitedEdges.clear();
-    graph.visitedEdges.resize(graph.edges.getValues().size(), false);
-
-    {
-      const size_t islandCount = graph.islands.getValues().size();
-      graph.publishedIslandEdgesChanged.clear();
-      graph.publishedIslandEdgesChanged.resize(islandCount, false);
-      graph.publishedIslandNodesChanged.clear();
-      graph.publishedIslandNodesChanged.resize(islandCount, false);
-    }
-
-    //Iterate over each non-visited node and visit all in that island. This likely means a large amount
-    //of skipped nodes after each edge traversal
-    //for(auto islandRoot = graph.nodes.begin(); islandRoot != graph.nodes.end(); ++islandRoot) {
-    for(size_t i = 0; i < graph.changedIslands.size(); ++i) {
-      if(!graph.changedIslands[i]) {
-        continue;
-      }
-      graph.changedIslands[i] = false;
+  void logIslandChanged(Graph& graph, IslandIndex islandIndex, bool nodesChanged) {
+    graph.changedIslands[islandIndex] = true;
+    if(nodesChanged) {
+      graph.changedIslandNodes[islandIndex] = true;
+    }
+  }
 
-      Island& island = graph.islands[i];
-      //If the island is invalid then something unexpected happened with the change tracking to mark
-      //an old island as changed. This is a bit of a hack since it indicates something wrong happened earlier
-      if(graph.islands.isFree(i)) {
-        continue;
-      }
+  IslandIndex createIsland(Graph& graph) {
+    const IslandIndex islandIndex = graph.islands.newIndex();
+    if(islandIndex >= graph.changedIslands.size()) {
+      addNewIsland(graph, islandIndex);
+    }
+    //New islands are considered entirely changed
+    logIslandChanged(graph, islandIndex, true);
+    return islandIndex;
+  }
 
-      const bool nodesChanged = populateIsland(graph, island, static_cast<IslandIndex>(i));
-      //If island is now empty, add it to the free list if it isn't already
-      if(!island.size()) {
-        island.clear();
-        graph.islands.deleteIndex(static_cast<IslandIndex>(i));
-      }
-      else {
-        //Edges must have changed or this wouldn't have been marked as a changed island
-        graph.publishedIslandEdgesChanged[i] = true;
-        const bool publishEvent = std::invoke([&] {
-          if(nodesChanged) {
-            return true;
-          }
-          //Check the force flag if this didn't naturally emit an event.
-          //Avoids needing to check the flag most of the time.
-          if(graph.forceChangedIslands[i]) {
-            graph.forceChangedIslands[i] = false;
-            return true;
-          }
-          return false;
-        });
-        if(publishEvent) {
-          graph.publishedIslandNodesChanged[i] = true;
-        }
-      }
+  void freeIsland(Graph& graph, IslandIndex islandIndex) {
+    graph.islands[islandIndex].clear();
+    graph.islands.deleteIndex(islandIndex);
+    graph.changedIslands[islandIndex] = graph.changedIslandNodes[islandIndex] = false;
+  }
+
+  void addNoPropagateEdges(Graph& graph, IslandIndex islandIndex, uint32_t node, uint32_t count) {
+    Island& island = graph.islands[islandIndex];
+    auto it = std::lower_bound(island.noPropagateNodes.begin(), island.noPropagateNodes.end(), node);
+    const size_t i = static_cast<size_t>(it - island.noPropagateNodes.begin());
+    if(it == island.noPropagateNodes.end() || *it != node) {
+      island.noPropagateNodes.insert(it, node);
+      island.noPropagateEdgeCounts.insert(island.noPropagateEdgeCounts.begin() + i, 0);
+      logIslandChanged(graph, islandIndex, true);
     }
+    island.noPropagateEdgeCounts[i] += count;
+  }
 
-    //Iterate over all newly created nodes. If they added an edge with an existing island they would have
-    //been traversed above
-    //Otherwise, they must form new islands
-    for(uint32_t newNode : graph.newNodes) {
-      if(graph.visitedNodes[newNode] || !graph.nodes[newNode].propagation) {
-        continue;
+  void removeNoPropagateEdge(Graph& graph, IslandIndex islandIndex, uint32_t node) {
+    Island& island = graph.islands[islandIndex];
+    auto it = std::lower_bound(island.noPropagateNodes.begin(), island.noPropagateNodes.end(), node);
+    assert(it != island.noPropagateNodes.end() && *it == node);
+    const size_t i = static_cast<size_t>(it - island.noPropagateNodes.begin());
+    if(!--island.noPropagateEdgeCounts[i]) {
+      island.noPropagateNodes.erase(it);
+      island.noPropagateEdgeCounts.erase(island.noPropagateEdgeCounts.begin() + i);
+      logIslandChanged(graph, islandIndex, true);
+    }
+  }
+
+  //Moves everything in the smaller island to the larger one and returns the one that remains
+  IslandIndex mergeIslands(Graph& graph, IslandIndex a, IslandIndex b) {
+    if(a == b) {
+      return a;
+    }
+    if(graph.islands[a].nodeCount + graph.islands[a].edgeCount < graph.islands[b].nodeCount + graph.islands[b].edgeCount) {
+      std::swap(a, b);
+    }
+    Island& dst = graph.islands[a];
+    Island& src = graph.islands[b];
+    for(uint32_t n = src.nodes; n != INVALID;) {
+      Node& node = graph.nodes[n];
+      const uint32_t next = node.islandNext;
+      node.islandIndex = a;
+      pushIslandList(graph.nodes, dst.nodes, dst.nodeCount, n);
+      n = next;
+    }
+    for(uint32_t e = src.edges; e != INVALID;) {
+      const uint32_t next = graph.edges[e].islandNext;
+      pushIslandList(graph.edges, dst.edges, dst.edgeCount, e);
+      e = next;
+    }
+    for(size_t i = 0; i < src.noPropagateNodes.size(); ++i) {
+      addNoPropagateEdges(graph, a, src.noPropagateNodes[i], src.noPropagateEdgeCounts[i]);
+    }
+    logIslandChanged(graph, a, true);
+    freeIsland(graph, b);
+    return a;
+  }
+
+  void addToIsland(Graph& graph, IslandIndex islandIndex, uint32_t nodeIndex) {
+    Island& island = graph.islands[islandIndex];
+    graph.nodes[nodeIndex].islandIndex = islandIndex;
+    pushIslandList(graph.nodes, island.nodes, island.nodeCount, nodeIndex);
+    logIslandChanged(graph, islandIndex, true);
+  }
+
+  //Propagating nodes get an island upon their first edge or in rebuildIslands if they don't have any
+  void addToNewIsland(Graph& graph, uint32_t nodeIndex) {
+    addToIsland(graph, createIsland(graph), nodeIndex);
+  }
+
+  //Adds the edge to the island of its propagating nodes, merging their islands if they differ
+  //Edges between two non-propagating nodes aren't in any island
+  void attachEdge(Graph& graph, uint32_t edgeIndex) {
+    const Edge& edge = graph.edges[edgeIndex];
+    const Node& a = graph.nodes[edge.nodeA];
+    const Node& b = graph.nodes[edge.nodeB];
+    if(!a.propagation && !b.propagation) {
+      return;
+    }
+    IslandIndex islandIndex{};
+    if(a.propagation && b.propagation) {
+      if(a.islandIndex == INVALID_ISLAND && b.islandIndex == INVALID_ISLAND) {
+        addToNewIsland(graph, edge.nodeA);
       }
-      const IslandIndex islandIndex = graph.islands.newIndex();
-      Island& newIsland = graph.islands.getValues()[islandIndex];
-      newIsland.nodes = newNode;
-      populateIsland(graph, newIsland, islandIndex);
-      if(newIsland.size()) {
-        if(!newIsland.userdata && graph.userdataFactory) {
-          newIsland.userdata = graph.userdataFactory->create();
-        }
-        //Ensure there's a matching entry for the changed islands bitset.
-        //No action needed if island was from the free list since it would already be non-changed
-        if(islandIndex >= graph.changedIslands.size()) {
-          addNewIsland(graph, islandIndex);
-        }
-        else {
-          //These are new islands so everything is considered "changed"
-          graph.publishedIslandEdgesChanged[islandIndex] = true;
-          graph.publishedIslandNodesChanged[islandIndex] = true;
-        }
+      if(a.islandIndex == INVALID_ISLAND) {
+        addToIsland(graph, b.islandIndex, edge.nodeA);
       }
-      else {
-        //Didn't actually want to make this island after-all, put it back in the free list
-        newIsland.clear();
-        graph.islands.deleteIndex(islandIndex);
+      else if(b.islandIndex == INVALID_ISLAND) {
+        addToIsland(graph, a.islandIndex, edge.nodeB);
       }
+      islandIndex = mergeIslands(graph, a.islandIndex, b.islandIndex);
     }
-    graph.newNodes.clear();
+    else {
+      const uint32_t propagating = a.propagation ? edge.nodeA : edge.nodeB;
+      if(graph.nodes[propagating].islandIndex == INVALID_ISLAND) {
+        addToNewIsland(graph, propagating);
+      }
+      islandIndex = graph.nodes[propagating].islandIndex;
+      addNoPropagateEdges(graph, islandIndex, a.propagation ? edge.nodeB : edge.nodeA, 1);
+    }
+    Island& island = graph.islands[islandIndex];
+    pushIslandList(graph.edges, island.edges, island.edgeCount, edgeIndex);
+    logIslandChanged(graph, islandIndex, false);
   }
 
-  void logChangedNode(Graph& graph, const Node& node) {
-    if(node.islandIndex != INVALID_ISLAND) {
-      graph.changedIslands[node.islandIndex] = true;
+  //Removes the edge from its island. If it was between two propagating nodes the island may have split, which is checked in rebuildIslands
+  void detachEdge(Graph& graph, uint32_t edgeIndex) {
+    const Edge& edge = graph.edges[edgeIndex];
+    const Node& a = graph.nodes[edge.nodeA];
+    const Node& b = graph.nodes[edge.nodeB];
+    if(!a.propagation && !b.propagation) {
+      return;
+    }
+    const IslandIndex islandIndex = a.propagation ? a.islandIndex : b.islandIndex;
+    Island& island = graph.islands[islandIndex];
+    eraseIslandList(graph.edges, island.edges, island.edgeCount, edgeIndex);
+    if(a.propagation && b.propagation) {
+      graph.splitSeeds.push_back(edge.nodeA);
+      graph.splitSeeds.push_back(edge.nodeB);
+    }
+    else {
+      removeNoPropagateEdge(graph, islandIndex, a.propagation ? edge.nodeB : edge.nodeA);
+    }
+    logIslandChanged(graph, islandIndex, false);
+  }
+
+  //Takes the node out of its island, freeing the island if it is now empty. Edges are expected to have been detached already
+  void removeFromIsland(Graph& graph, uint32_t nodeIndex) {
+    Node& node = graph.nodes[nodeIndex];
+    if(node.islandIndex == INVALID_ISLAND) {
+      return;
+    }
+    const IslandIndex islandIndex = node.islandIndex;
+    Island& island = graph.islands[islandIndex];
+    eraseIslandList(graph.nodes, island.nodes, island.nodeCount, nodeIndex);
+    node.islandIndex = INVALID_ISLAND;
+    if(!island.nodeCount) {
+      freeIsland(graph, islandIndex);
+    }
+    else {
+      logIslandChanged(graph, islandIndex, true);
     }
   }
 
-  void logAddedNode(Graph& graph, const Node& node) {
-    logChangedNode(graph, node);
+  //Moves the nodes and everything connected to them from one island to a new one
+  void moveToNewIsland(Graph& graph, IslandIndex from, const std::vector<uint32_t>& nodes) {
+    const IslandIndex to = createIsland(graph);
+    Island& src = graph.islands[from];
+    Island& dst = graph.islands[to];
+    for(uint32_t n : nodes) {
+      eraseIslandList(graph.nodes, src.nodes, src.nodeCount, n);
+      pushIslandList(graph.nodes, dst.nodes, dst.nodeCount, n);
+      graph.nodes[n].islandIndex = to;
+    }
+    for(uint32_t n : nodes) {
+      for(uint32_t entry = graph.nodes[n].edges; entry != INVALID; entry = graph.edgeEntries[entry].nextEntry) {
+        const uint32_t e = graph.edgeEntries[entry].edge;
+        const Edge& edge = graph.edges[e];
+        const uint32_t other = edge.nodeA == n ? edge.nodeB : edge.nodeA;
+        if(!graph.nodes[other].propagation) {
+          removeNoPropagateEdge(graph, from, other);
+          addNoPropagateEdges(graph, to, other, 1);
+        }
+        //Both nodes are in this list, only move the edge once
+        else if(edge.nodeA != n) {
+          continue;
+        }
+        eraseIslandList(graph.edges, src.edges, src.edgeCount, e);
+        pushIslandList(graph.edges, dst.edges, dst.edgeCount, e);
+      }
+    }
+    logIslandChanged(graph, from, true);
   }
 
-  void logMaybeSplitIslandNode(Graph& graph, const Node& node) {
-    if(node.islandIndex != INVALID_ISLAND) {
-      graph.changedIslands[node.islandIndex] = true;
-      const auto nodeIndex = static_cast<uint32_t>(&node - graph.nodes.getValues().data());
-      graph.newNodes.push_back(nodeIndex);
+  uint32_t findSearchRoot(std::vector<SplitSearch>& searches, uint32_t search) {
+    while(searches[search].parent != search) {
+      searches[search].parent = searches[searches[search].parent].parent;
+      search = searches[search].parent;
     }
+    return search;
   }
 
-  //Removing a node could split any number of islands from any of the edges on it
-  //This only marks the island it was in for reevaluation, potentially reassigning the head
-  //The caller then logs all the removed edges as a result
-  //If this results in an empty island the next rebuildIslands will add it to the free list
-  void logRemovedNode(Graph& graph, const Node& node) {
-    if(node.islandIndex != INVALID_ISLAND) {
-      graph.changedIslands[node.islandIndex] = true;
-      const auto nodeIndex = static_cast<uint32_t>(&node - graph.nodes.getValues().data());
-      //Reassign head if this was the start of the island
-      if(graph.islands[node.islandIndex].nodes == nodeIndex) {
-        graph.islands[node.islandIndex].nodes = node.islandNext;
+  //Searches from all seeds a node at a time each. Searches that meet are merged and a search that runs out of nodes
+  //before meeting any others found a separate island. Stops once a single search remains, which keeps the original island
+  void splitIsland(Graph& graph, IslandIndex islandIndex, const uint32_t* seeds, size_t seedCount) {
+    std::vector<SplitSearch>& searches = graph.splitSearches;
+    std::vector<uint32_t>& nodeSearches = graph.nodeSearches;
+    std::vector<uint32_t>& active = graph.activeSearches;
+    nodeSearches.resize(graph.nodes.addressableSize(), INVALID);
+    active.clear();
+    if(searches.size() < seedCount) {
+      searches.resize(seedCount);
+    }
+    for(size_t i = 0; i < seedCount; ++i) {
+      const uint32_t id = static_cast<uint32_t>(active.size());
+      SplitSearch& search = searches[id];
+      search.parent = id;
+      search.todo.assign(1, seeds[i]);
+      search.visited.assign(1, seeds[i]);
+      nodeSearches[seeds[i]] = id;
+      active.push_back(id);
+    }
+    const size_t searchCount = active.size();
+
+    size_t remaining = searchCount;
+    while(remaining > 1) {
+      for(size_t i = 0; i < active.size() && remaining > 1; ++i) {
+        const uint32_t id = active[i];
+        //Skip searches that were absorbed or split off
+        if(id == INVALID || searches[id].parent != id) {
+          continue;
+        }
+        SplitSearch& search = searches[id];
+        if(search.todo.empty()) {
+          //Everything reachable was found without meeting another search so this is a new island
+          moveToNewIsland(graph, islandIndex, search.visited);
+          active[i] = INVALID;
+          --remaining;
+          continue;
+        }
+
+        const uint32_t current = search.todo.back();
+        search.todo.pop_back();
+        for(uint32_t entry = graph.nodes[current].edges; entry != INVALID; entry = graph.edgeEntries[entry].nextEntry) {
+          const Edge& edge = graph.edges[graph.edgeEntries[entry].edge];
+          const uint32_t other = edge.nodeA == current ? edge.nodeB : edge.nodeA;
+          //Islands don't connect through non-propagating nodes
+          if(!graph.nodes[other].propagation) {
+            continue;
+          }
+          uint32_t& found = nodeSearches[other];
+          if(found == INVALID) {
+            found = id;
+            search.todo.push_back(other);
+            search.visited.push_back(other);
+          }
+          else if(const uint32_t root = findSearchRoot(searches, found); root != id) {
+            //Met another search so they're the same island, continue as one
+            SplitSearch& absorbed = searches[root];
+            absorbed.parent = id;
+            search.todo.insert(search.todo.end(), absorbed.todo.begin(), absorbed.todo.end());
+            search.visited.insert(search.visited.end(), absorbed.visited.begin(), absorbed.visited.end());
+            absorbed.todo.clear();
+            absorbed.visited.clear();
+            --remaining;
+          }
+        }
+      }
+    }
+
+    for(size_t i = 0; i < searchCount; ++i) {
+      for(uint32_t n : searches[i].visited) {
+        nodeSearches[n] = INVALID;
       }
     }
   }
 
-  //If an edge is added then traversal needs to visit the islands both are in
-  void logAddedEdge(Graph& graph, const Node& a, const Node& b) {
-    logChangedNode(graph, a);
-    logChangedNode(graph, b);
+  void splitIslands(Graph& graph) {
+    std::vector<uint32_t>& seeds = graph.splitSeeds;
+    //Nodes that were removed or left their island since their edge was removed don't need to be searched from
+    std::erase_if(seeds, [&graph](uint32_t n) {
+      return !graph.nodes.isValid(n) || !graph.nodes[n].propagation || graph.nodes[n].islandIndex == INVALID_ISLAND;
+    });
+    std::sort(seeds.begin(), seeds.end(), [&graph](uint32_t l, uint32_t r) {
+      const IslandIndex il = graph.nodes[l].islandIndex;
+      const IslandIndex ir = graph.nodes[r].islandIndex;
+      return il == ir ? l < r : il < ir;
+    });
+    seeds.erase(std::unique(seeds.begin(), seeds.end()), seeds.end());
+    for(size_t begin = 0; begin < seeds.size();) {
+      const IslandIndex islandIndex = graph.nodes[seeds[begin]].islandIndex;
+      size_t end = begin + 1;
+      while(end < seeds.size() && graph.nodes[seeds[end]].islandIndex == islandIndex) {
+        ++end;
+      }
+      //A single node can't split from anything
+      if(end - begin > 1) {
+        splitIsland(graph, islandIndex, seeds.data() + begin, end - begin);
+      }
+      begin = end;
+    }
+    seeds.clear();
   }
 
-  //If an edge is removed traversal needs to visit the island both were in, which is presumably the same
-  //It then also needs to visit both nodes in case this removal split the island in two
-  void logRemovedEdge(Graph& graph, const Node& a, const Node& b) {
-    logMaybeSplitIslandNode(graph, a);
-    logMaybeSplitIslandNode(graph, b);
+  void rebuildIslands(Graph& graph) {
+    splitIslands(graph);
+
+    //New nodes that didn't gain any edges are islands by themselves
+    for(uint32_t newNode : graph.newNodes) {
+      if(graph.nodes.isValid(newNode) && graph.nodes[newNode].propagation && graph.nodes[newNode].islandIndex == INVALID_ISLAND) {
+        addToNewIsland(graph, newNode);
+      }
+    }
+    graph.newNodes.clear();
+
+    graph.publishedIslandEdgesChanged.assign(graph.changedIslands.begin(), graph.changedIslands.end());
+    graph.publishedIslandNodesChanged.assign(graph.changedIslandNodes.begin(), graph.changedIslandNodes.end());
+    for(size_t i = 0; i < graph.changedIslandNodes.size(); ++i) {
+      if(graph.changedIslandNodes[i] && graph.userdataFactory) {
+        Island& island = graph.islands[i];
+        if(!island.userdata) {
+          island.userdata = graph.userdataFactory->create();
+        }
+      }
+    }
+    std::fill(graph.changedIslands.begin(), graph.changedIslands.end(), false);
+    std::fill(graph.changedIslandNodes.begin(), graph.changedIslandNodes.end(), false);
   }
 
   uint32_t addEdge(Graph& graph, const NodeUserdata& a, const NodeUserdata& b) {
@@ -470,7 +617,6 @@ namespace IslandGraph {
 
     Node& nodeA = graph.nodes.getValues()[newEdge.nodeA];
     Node& nodeB = graph.nodes.getValues()[newEdge.nodeB];
-    logAddedEdge(graph, nodeA, nodeB);
 
     //Create space for edge entries of A and B
     const size_t entryIndexA = graph.edgeEntries.newIndex();
@@ -478,6 +624,7 @@ namespace IslandGraph {
 
     addToLinkedList(nodeA.edges, entryIndexA, graph.edgeEntries.getValues()[entryIndexA], edgeIndex);
     addToLinkedList(nodeB.edges, entryIndexB, graph.edgeEntries.getValues()[entryIndexB], edgeIndex);
+    attachEdge(graph, edgeIndex);
     return edgeIndex;
   }
 
@@ -508,7 +655,7 @@ namespace IslandGraph {
     const uint32_t edge = removeFromLinkedList(nodeA.edges, mappingsB->second.node, graph.edgeEntries, graph.edges.getValues());
     assert(edge != INVALID);
     Node& nodeB = graph.nodes.getValues()[mappingsB->second.node];
-    logRemovedEdge(graph, nodeA, nodeB);
+    detachEdge(graph, edge);
     //Remove the entry pointing at the edge found in A from the list of entries in B
     [[maybe_unused]] const bool removed = removeFromLinkedList(nodeB.edges, edge, graph.edgeEntries);
     assert(removed);
@@ -520,17 +667,11 @@ namespace IslandGraph {
     const Edge& edge = graph.edges[it.edge];
     Node& a = graph.nodes[edge.nodeA];
     Node& b = graph.nodes[edge.nodeB];
-    logRemovedEdge(graph, a, b);
-    Graph orig = graph;
-    Node origA = a;
-    Node origB = b;
+    detachEdge(graph, it.edge);
     [[maybe_unused]] const bool removedA = removeFromLinkedList(a.edges, it.edge, graph.edgeEntries);
     [[maybe_unused]] const bool removedB = removeFromLinkedList(b.edges, it.edge, graph.edgeEntries);
     assert(removedA && removedB);
-    if(!(removedA && removedB)) {
-      removeFromLinkedList(origA.edges, it.edge, orig.edgeEntries);
-      removeFromLinkedList(origB.edges, it.edge, orig.edgeEntries);
-    }
+    graph.edges.deleteIndex(it.edge, graph.edges.getVersion(it.edge));
   }
 
   void addNode(Graph& graph, const NodeUserdata& data, IslandPropagationMask propagation) {
@@ -555,18 +696,18 @@ namespace IslandGraph {
     graph.nodeMappings.erase(mappings);
 
     Node& node = graph.nodes.getValues()[toRemove];
-    logRemovedNode(graph, node);
     uint32_t current = node.edges;
     //Go through all edges this was connected to and remove them from the other
     while(current != INVALID) {
       EdgeEntry& entry = graph.edgeEntries[current];
       Edge& edge = graph.edges[entry.edge];
 
+      //Any of the other nodes might be split from each-other now, which is checked from the edge's nodes
+      detachEdge(graph, entry.edge);
+
       //Remove entry for edge in other object
       const uint32_t other = edge.nodeA == toRemove ? edge.nodeB : edge.nodeA;
       Node& otherNode = graph.nodes[other];
-      //Any edge outgoing from the removed node might need to split into a new island, mark them for evaluation
-      logMaybeSplitIslandNode(graph, otherNode);
       removeFromLinkedList(otherNode.edges, entry.edge, graph.edgeEntries);
 
       //Remove the edge itself
@@ -577,14 +718,19 @@ namespace IslandGraph {
       current = entry.nextEntry;
       graph.edgeEntries.deleteIndex(entryToRemove);
     }
+    node.edges = INVALID;
 
     //All edges have been removed, remove the node itself
+    removeFromIsland(graph, toRemove);
     graph.nodes.deleteIndex(toRemove);
   }
 
   void notifyNodeChanged(Graph& graph, Graph::NodeIterator it) {
     if(it != graph.nodesEnd()) {
-      logChangedNode(graph, graph.nodes[it.node]);
+      const Node& node = graph.nodes[it.node];
+      if(node.islandIndex != INVALID_ISLAND) {
+        logIslandChanged(graph, node.islandIndex, false);
+      }
     }
   }
 
@@ -592,8 +738,7 @@ namespace IslandGraph {
     if(it != graph.nodesEnd()) {
       const Node& node = graph.nodes[it.node];
       if(node.islandIndex != INVALID_ISLAND) {
-        logChangedNode(graph, node);
-        graph.forceChangedIslands[node.islandIndex] = true;
+        logIslandChanged(graph, node.islandIndex, true);
       }
     }
   }
@@ -601,23 +746,18 @@ namespace IslandGraph {
   void setPropagation(Graph& graph, Graph::NodeIterator it, const PropagationOps& ops) {
     if(it != graph.nodesEnd()) {
       Node& node = graph.nodes[it.node];
-      //If this is going from a propagating node to non-propagating it can no longer be the root
-      //of any islands nor store an island index
-      if(node.propagation && !ops.mask) {
-        //This will mark as changed and move the head of the island
-        logRemovedNode(graph, node);
-        uint32_t current = node.edges;
-        //Go through all edges this was connected to and notify potential split
-        while(current != INVALID) {
-          EdgeEntry& entry = graph.edgeEntries[current];
-          Edge& edge = graph.edges[entry.edge];
-
-          //Remove entry for edge in other object
-          const uint32_t other = edge.nodeA == it.node ? edge.nodeB : edge.nodeA;
-          Node& otherNode = graph.nodes[other];
-          //Any edge outgoing from the changed node might need to split into a new island, mark them for evaluation
-          logMaybeSplitIslandNode(graph, otherNode);
-          current = entry.nextEntry;
+      //Island membership of the node and all its edges depends on propagation, so take them out and put them back
+      if(!node.propagation != !ops.mask) {
+        for(uint32_t entry = node.edges; entry != INVALID; entry = graph.edgeEntries[entry].nextEntry) {
+          detachEdge(graph, graph.edgeEntries[entry].edge);
+        }
+        removeFromIsland(graph, it.node);
+        node.propagation = ops.mask;
+        if(node.propagation) {
+          graph.newNodes.push_back(it.node);
+        }
+        for(uint32_t entry = node.edges; entry != INVALID; entry = graph.edgeEntries[entry].nextEntry) {
+          attachEdge(graph, graph.edgeEntries[entry].edge);
         }
       }
       //For any other propagation changes they can get picked up by marking as changed
@@ -38,6 +38,7 @@ namespace IslandGraph {
     //Root of linked list of EdgeEntry
     uint32_t edges{ INVALID };
     uint32_t islandNext{ INVALID };
+    uint32_t islandPrev{ INVALID };
   };
   //This is the element of a linked list for all edges going out of a single node
   struct EdgeEntry {
@@ -53,6 +54,7 @@ namespace IslandGraph {
     uint32_t nodeB{};
     EdgeUserdata data{};
     uint32_t islandNext{ INVALID };
+    uint32_t islandPrev{ INVALID };
   };
   struct NodeMappings {
     uint32_t node{};
@@ -81,9 +83,19 @@ namespace IslandGraph {
     //Tracks all of them on the island since the node might belong to multiple islands
     //Hopefully there are few per island
     std::vector<uint32_t> noPropagateNodes;
+    //Number of edges in this island to the node at the same index in noPropagateNodes
+    std::vector<uint32_t> noPropagateEdgeCounts;
     std::shared_ptr<IIslandUserdata> userdata;
   };
   constexpr static uint32_t FREE_INDEX = std::numeric_limits<uint32_t>::max() - 1;
+
+  //Traversal from one of the nodes that might have been split from the rest of its island
+  struct SplitSearch {
+    std::vector<uint32_t> todo;
+    std::vector<uint32_t> visited;
+    //Searches that meet are merged, this points at the one that absorbed this one, or itself if it wasn't
+    uint32_t parent{};
+  };
 }
 
 namespace gnx {
@@ -507,13 +519,18 @@ namespace IslandGraph {
     std::unordered_map<NodeUserdata, NodeMappings> nodeMappings;
     gnx::VectorFreeList<Island> islands;
     //Assuming bitset optimization
-    //Islands that have changed for internal tracking of work to do in rebuildIslands
-    std::vector<bool> changedIslands, forceChangedIslands;
-    std::vector<bool> visitedNodes, visitedEdges;
+    //Islands are kept up to date as the graph is modified, these track what changed since the last rebuildIslands
+    std::vector<bool> changedIslands, changedIslandNodes;
     //Information about which islands have changed nodes or edges for external use after rebuildIslands
     std::vector<bool> publishedIslandNodesChanged, publishedIslandEdgesChanged;
+    //Propagating nodes that may still need an island of their own
     std::vector<uint32_t> newNodes;
-    std::vector<uint32_t> scratchBuffer, scratchIslands;
+    //Nodes of removed edges whose island may have split, checked by rebuildIslands
+    std::vector<uint32_t> splitSeeds;
+    std::vector<SplitSearch> splitSearches;
+    //Search that visited each node or INVALID
+    std::vector<uint32_t> nodeSearches;
+    std::vector<uint32_t> activeSearches;
     //Unique ownership usually but shared easy debugging allowing copying
     std::shared_ptr<IIslandUserdataFactory> userdataFactory;
   };
@@ -534,6 +551,9 @@ namespace IslandGraph {
   };
   void setPropagation(Graph& graph, Graph::NodeIterator it, const PropagationOps& ops);
 
+  //Islands are merged as edges are added, but removals are only checked for splits here
+  //Each island with removals is searched from the nodes of the removed edges simultaneously until all searches meet
+  //or all but one run out of nodes, so the cost is proportional to the pieces that split off rather than the whole island
   void rebuildIslands(Graph& graph);
 
   namespace Debug {
@@ -22,32 +22,60 @@ namespace Narrowphase {
   };
 
   //Get the point furthest in the opposite direction on the mesh. Direction should be transformed into the mesh's space
-  SupportPoint getSupportPoint(const glm::vec2& direction, const ShapeRegistry::Mesh& mesh) {
-    SupportPoint result{ .minDistance = std::numeric_limits<float>::max() };
-    for(size_t i = 0; i < mesh.points.size(); ++i) {
-      const float currentDistance = glm::dot(direction, mesh.points[i]);
-      if(currentDistance < result.minDistance) {
-        result.minDistance = currentDistance;
-        result.index = i;
+  //The points are a convex hull so distance only decreases on the way to the support point, walk from start towards it until a neighbor is further
+  //Sweeping around the edges of the other mesh moves the support point the same way, so starting from the previous result is close to constant time
+  SupportPoint getSupportPoint(const glm::vec2& direction, const ShapeRegistry::Mesh& mesh, uint32_t start) {
+    const gnx::IntMath::Nonzero size{ static_cast<uint32_t>(mesh.points.size()) };
+    SupportPoint result{ .minDistance = glm::dot(direction, mesh.points[start]), .index = start };
+    //Forward if both neighbors are equal, as in the middle of collinear points, since that could be the far side of the hull
+    const bool forward = glm::dot(direction, mesh.points[gnx::IntMath::wrappedIncrement(start, size)]) <=
+      glm::dot(direction, mesh.points[gnx::IntMath::wrappedDecrement(start, size)]);
+    uint32_t current = start;
+    float currentDistance = result.minDistance;
+    //Ties are walked across rather than stopping on them. The step limit prevents cycling if every point is equal
+    //or precision makes the hull slightly concave
+    for(uint32_t steps = 1; steps < *size; ++steps) {
+      const uint32_t next = forward ? gnx::IntMath::wrappedIncrement(current, size) : gnx::IntMath::wrappedDecrement(current, size);
+      const float nextDistance = glm::dot(direction, mesh.points[next]);
+      if(nextDistance > currentDistance) {
+        break;
+      }
+      current = next;
+      currentDistance = nextDistance;
+      if(nextDistance < result.minDistance) {
+        result.minDistance = nextDistance;
+        result.index = next;
       }
     }
 
     return result;
   }
 
+  //Multiply by the transpose of the transform's basis. Normals transform by the inverse transpose, so this is used on the inverse of the desired transform
+  glm::vec2 transposeTransformVector(const Transform::PackedTransform& t, const glm::vec2& v) {
+    return {
+      t.ax*v.x + t.ay*v.y,
+      t.bx*v.x + t.by*v.y
+    };
+  }
+
   FurthestEdge findFurthestEdgeOnA(const ShapeRegistry::Mesh& a, const ShapeRegistry::Mesh& b, const MeshOptions& ops) {
     FurthestEdge result{ .distanceAlongNormal = std::numeric_limits<float>::lowest() };
 
     //Transform edges on A into space B to search for closest along the edge normals in B space
     const Transform::PackedTransform aToB = *b.worldToModel * *a.modelToWorld;
+    const Transform::PackedTransform bToA = *a.worldToModel * *b.modelToWorld;
     const size_t aPointCount = a.points.size();
+    assert(a.normals.empty() || a.normals.size() == aPointCount);
     //All the points are wound around the center in counterclockwise order.
     //Subtracting two neighboring points produces an edge on the boundary.
     glm::vec2 beginInB = aToB.transformPoint(a.points[aPointCount - 1]);
+    uint32_t supportStart{};
     for(size_t e = 0; e < aPointCount; ++e) {
       glm::vec2 endInB = aToB.transformPoint(a.points[e]);
       //Cross edge with z, since edge is counterclockwise that's the outward facing normal.
-      glm::vec2 normalInB = Geo::orthogonal(endInB - beginInB);
+      //If the normals were precomputed in model space they only need to be moved to B, degenerate edges have zero normals
+      glm::vec2 normalInB = !a.normals.empty() ? transposeTransformVector(bToA, a.normals[e]) : Geo::orthogonal(endInB - beginInB);
 
       const float length = glm::length(normalInB);
       //If the normal is nonsense count this is no-collision with this edge
@@ -56,7 +84,8 @@ namespace Narrowphase {
         //of different normals will be compared with each-other for the overall best.
         normalInB /= length;
 
-        const SupportPoint supportB = getSupportPoint(normalInB, b);
+        const SupportPoint supportB = getSupportPoint(normalInB, b, supportStart);
+        supportStart = supportB.index;
         //Either begin or end are valid support points, as they are on the boundary of the shape
         const float supportA = glm::dot(normalInB, endInB);
         //Since the supports are projected onto an outward facing normal, the distance is positive (separating) if B > A
@@ -73,6 +102,11 @@ namespace Narrowphase {
       beginInB = endInB;
     }
 
+    //No usable edges, as is the case for a point. Leave the distance as lowest so the other mesh is used as the reference
+    if(result.distanceAlongNormal == std::numeric_limits<float>::lowest()) {
+      return result;
+    }
+
     //Take the unit length normal, and scale it to the length of a to b
     result.normalWorld *= std::abs(result.distanceAlongNormal);
     //Transform to world. This could change the length of the vector (distance between points) if either object has non-unit scale
@@ -118,6 +152,73 @@ namespace Narrowphase {
                                                                     assert(eq(testA.tz, testB.tz));
   }
 
+  //A point's contact is against the closest point on the reference edge, which may be one of its corners
+  //Using the face normal near a corner would overestimate the overlap of a rounded point
+  void generatePointContact(
+    glm::vec2 normal,
+    const Geo::LineSegment& reference,
+    const glm::vec2& point,
+    float pointRadius,
+    float radii,
+    const MeshOptions& ops,
+    const ShapeRegistry::Mesh& a,
+    const ShapeRegistry::Mesh& b,
+    bool isOnA,
+    SP::ContactManifold& result
+  ) {
+    float distance = glm::dot(point - reference.start, normal);
+    const glm::vec2 edge = reference.end - reference.start;
+    const glm::vec2* corner = nullptr;
+    if(glm::dot(point - reference.start, edge) < 0.0f) {
+      corner = &reference.start;
+    }
+    else if(glm::dot(point - reference.end, edge) > 0.0f) {
+      corner = &reference.end;
+    }
+    //If the point is past the corner use the direction from it, unless it's inside in which case the face is the better way out
+    if(corner && distance > 0.0f) {
+      const glm::vec2 toPoint = point - *corner;
+      const float length = glm::length(toPoint);
+      if(length > ops.edgeEpsilon) {
+        normal = toPoint/length;
+        distance = length;
+      }
+    }
+    if(distance > radii + ops.noCollisionDistance) {
+      return;
+    }
+
+    //Contact is on the surface of the point's radius
+    const glm::vec2 contact = point - normal*pointRadius;
+    SP::ContactPoint& p = result[0];
+    result.size = 1;
+    //Normal is supposed to go away from A. Right now it is going away from the reference edge
+    p.normal = isOnA ? -normal : normal;
+    p.centerToContactA = contact - a.modelToWorld->pos2();
+    p.centerToContactB = contact - b.modelToWorld->pos2();
+    p.overlap = radii - distance;
+  }
+
+  void computeEdgeNormals(std::span<const glm::vec2> points, std::vector<glm::vec2>& normals, float edgeEpsilon) {
+    normals.resize(points.size());
+    computeEdgeNormals(points, std::span<glm::vec2>{ normals }, edgeEpsilon);
+  }
+
+  void computeEdgeNormals(std::span<const glm::vec2> points, std::span<glm::vec2> normals, float edgeEpsilon) {
+    assert(normals.size() == points.size());
+    if(points.empty()) {
+      return;
+    }
+    //Same as the edge traversal in findFurthestEdgeOnA
+    glm::vec2 begin = points.back();
+    for(size_t e = 0; e < points.size(); ++e) {
+      const glm::vec2 normal = Geo::orthogonal(points[e] - begin);
+      const float length = glm::length(normal);
+      normals[e] = length > edgeEpsilon ? normal/length : glm::vec2{ 0 };
+      begin = points[e];
+    }
+  }
+
   void generateContactsConvex(
     const ShapeRegistry::Mesh& a,
     const ShapeRegistry::Mesh& b,
@@ -135,27 +236,49 @@ namespace Narrowphase {
     //Find the most-separating edges relative to the normals on both bodies
     const FurthestEdge bestA = findFurthestEdgeOnA(a, b, ops);
     const FurthestEdge bestB = findFurthestEdgeOnA(b, a, ops);
+    const float radii = a.radius + b.radius;
+    //If either is separated by more than the radii then all contacts would be too, or there are no edges to test against
+    const float separation = std::max(bestA.distanceAlongNormal, bestB.distanceAlongNormal);
+    if(separation > radii + ops.noCollisionDistance || separation == std::numeric_limits<float>::lowest()) {
+      return;
+    }
+
     //Figure out which has the better edge, that'll be the reference
-    Geo::LineSegment reference, incident;
+    Geo::LineSegment reference;
     bool isOnA{};
     glm::vec2 normal{};
+    uint32_t incidentPoint{};
     //Bias towards one arbitrarily to avoid numerical instability flipping between near-equivalent results.
     if(bestA.distanceAlongNormal + ops.edgeEpsilon > bestB.distanceAlongNormal) {
       normal = bestA.normalWorld;
       reference = getReferenceSegment(bestA.referenceEdge, a);
-      incident = getIncidentSegment(bestA.incidentPoint, normal, b);
+      incidentPoint = bestA.incidentPoint;
       isOnA = true;
     }
     else {
       normal = bestB.normalWorld;
       reference = getReferenceSegment(bestB.referenceEdge, b);
-      incident = getIncidentSegment(bestB.incidentPoint, normal, a);
+      incidentPoint = bestB.incidentPoint;
       isOnA = false;
     }
+    const ShapeRegistry::Mesh& incidentMesh = isOnA ? b : a;
 
-    //Clip incident edge against reference and store in manifold
-    Narrowphase::storeResult(Narrowphase::clipEdgeToEdge(normal, reference, incident), normal, a.modelToWorld->pos2(), b.modelToWorld->pos2(), isOnA, result);
+    //A point has no incident edge to clip
+    if(incidentMesh.points.size() == 1) {
+      const glm::vec2 point = incidentMesh.modelToWorld->transformPoint(incidentMesh.points[0]);
+      generatePointContact(normal, reference, point, incidentMesh.radius, radii, ops, a, b, isOnA, result);
+      return;
+    }
 
-    //TODO: adjust contacts for mesh radius
+    //Clip incident edge against reference and store in manifold
+    ClipResult clip = Narrowphase::clipEdgeToEdge(normal, reference, getIncidentSegment(incidentPoint, normal, incidentMesh));
+    if(radii > 0.0f) {
+      //Move the contacts from the incident edge out to its rounded surface and extend the overlap by the rounding of both
+      clip.edge.start -= normal*incidentMesh.radius;
+      clip.edge.end -= normal*incidentMesh.radius;
+      clip.overlap.min += radii;
+      clip.overlap.max += radii;
+    }
+    Narrowphase::storeResult(clip, normal, a.modelToWorld->pos2(), b.modelToWorld->pos2(), isOnA, result);
   }
 }
\ No newline at end of file
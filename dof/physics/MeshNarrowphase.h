@@ -1,5 +1,9 @@
 #pragma once
 
+#include <glm/vec2.hpp>
+#include <span>
+#include <vector>
+
 namespace SP {
   struct ContactManifold;
 }
@@ -17,5 +21,11 @@ namespace Narrowphase {
     float noCollisionDistance{ 0.f };
   };
 
+  //Writes the outward facing unit normal of each edge of the counterclockwise convex hull to normals, where normals[i] is of the edge ending at points[i]
+  //Edges shorter than edgeEpsilon get a zero normal so contact generation skips them
+  void computeEdgeNormals(std::span<const glm::vec2> points, std::vector<glm::vec2>& normals, float edgeEpsilon = MeshOptions{}.edgeEpsilon);
+  //Same as above but writes into normals which must already be the same size as points
+  void computeEdgeNormals(std::span<const glm::vec2> points, std::span<glm::vec2> normals, float edgeEpsilon = MeshOptions{}.edgeEpsilon);
+
   void generateContactsConvex(const ShapeRegistry::Mesh& a, const ShapeRegistry::Mesh& b, const MeshOptions& ops, SP::ContactManifold& result);
 }
\ No newline at end of file
@@ -9,8 +9,10 @@
 #include <math/Geometric.h>
 #include "glm/gtc/matrix_inverse.hpp"
 #include "BoxBox.h"
+#include "NarrowphaseBatch.h"
 #include <MeshNarrowphase.h>
 #include <shapes/Mesh.h>
+#include <shapes/TriangleBVH.h>
 #include <SweepNPruneBroadphase.h>
 #include <transform/TransformModule.h>
 #include <transform/TransformRows.h>
@@ -30,59 +32,72 @@ namespace Narrowphase {
     SP::PairType& pairType;
   };
 
-  ShapeRegistry::Mesh toMesh(const ShapeRegistry::Rectangle&, std::vector<glm::vec2>& storage) {
-    storage.clear();
-    storage.insert(storage.end(), {
-      glm::vec2{ -0.5f, -0.5f },
-      glm::vec2{ 0.5f, -0.5f },
-      glm::vec2{ 0.5f, 0.5f },
-      glm::vec2{ -0.5f, 0.5f }
-    });
-    return ShapeRegistry::Mesh{
-      .points = storage,
-    };
-  }
+  //Model space points of the simple shapes. Their transforms place them in the world so all instances can share these
+  struct UnitMesh {
+    UnitMesh(std::vector<glm::vec2> p)
+      : points{ std::move(p) } {
+      computeEdgeNormals(points, normals);
+    }
 
-  ShapeRegistry::Mesh toMesh(const ShapeRegistry::AABB&, std::vector<glm::vec2>& storage) {
+    ShapeRegistry::Mesh toMesh(float radius = 0.0f) const {
+      return ShapeRegistry::Mesh{
+        .points = points,
+        .normals = normals,
+        .radius = radius
+      };
+    }
+
+    std::vector<glm::vec2> points;
+    std::vector<glm::vec2> normals;
+  };
+
+  const UnitMesh UNIT_RECTANGLE{ {
+    glm::vec2{ -0.5f, -0.5f },
+    glm::vec2{ 0.5f, -0.5f },
+    glm::vec2{ 0.5f, 0.5f },
+    glm::vec2{ -0.5f, 0.5f }
+  } };
+  const UnitMesh UNIT_AABB{ [] {
     auto points = Geo::AABB{ glm::vec2{ 0 }, glm::vec2{ 1 } }.points();
-    storage.clear();
-    storage.insert(storage.end(), points.begin(), points.end());
-    return ShapeRegistry::Mesh{
-      .points = storage
-    };
+    return std::vector<glm::vec2>{ points.begin(), points.end() };
+  }() };
+  const UnitMesh UNIT_RAYCAST{ {
+    glm::vec2{ 0 },
+    glm::vec2{ 1, 0 }
+  } };
+  const UnitMesh UNIT_POINT{ { glm::vec2{ 0 } } };
+  const UnitMesh EMPTY_MESH{ std::vector<glm::vec2>{} };
+
+  ShapeRegistry::Mesh toMesh(const ShapeRegistry::Rectangle&, std::vector<glm::vec2>&) {
+    return UNIT_RECTANGLE.toMesh();
   }
 
-  ShapeRegistry::Mesh toMesh(const ShapeRegistry::Raycast&, std::vector<glm::vec2>& storage) {
-    storage.clear();
-    storage.insert(storage.begin(), {
-      glm::vec2{ 0 },
-      glm::vec2{ 1, 0 }
-    });
-    return ShapeRegistry::Mesh{
-      .points = storage
-    };
+  ShapeRegistry::Mesh toMesh(const ShapeRegistry::AABB&, std::vector<glm::vec2>&) {
+    return UNIT_AABB.toMesh();
   }
 
-  //TODO: only works once mesh can have radius
-  ShapeRegistry::Mesh toMesh(const ShapeRegistry::Circle&, std::vector<glm::vec2>& storage) {
-    storage.clear();
-    storage.insert(storage.begin(), glm::vec2{ 0 });
-    return ShapeRegistry::Mesh{
-      .points = storage
-    };
+  ShapeRegistry::Mesh toMesh(const ShapeRegistry::Raycast&, std::vector<glm::vec2>&) {
+    return UNIT_RAYCAST.toMesh();
   }
 
-  ShapeRegistry::Mesh toMesh(std::monostate, std::vector<glm::vec2>& storage) {
-    storage.clear();
-    return {
-      .points = storage
-    };
+  //A point rounded out to the radius
+  ShapeRegistry::Mesh toMesh(const ShapeRegistry::Circle& circle, std::vector<glm::vec2>&) {
+    return UNIT_POINT.toMesh(circle.radius);
+  }
+
+  ShapeRegistry::Mesh toMesh(std::monostate, std::vector<glm::vec2>&) {
+    return EMPTY_MESH.toMesh();
   }
 
   ShapeRegistry::Mesh toMesh(const ShapeRegistry::Mesh& mesh, std::vector<glm::vec2>&) {
     return mesh;
   }
 
+  //Not convex so it can't be represented by a single mesh
+  ShapeRegistry::Mesh toMesh(const ShapeRegistry::TriangleMesh&, std::vector<glm::vec2>&) {
+    return EMPTY_MESH.toMesh();
+  }
+
   void generateContacts(ShapeRegistry::Mesh& a, ShapeRegistry::Mesh& b, ContactArgs& result);
 
   template<class A, class B>
@@ -131,6 +146,90 @@ namespace Narrowphase {
     Narrowphase::generateContactsConvex(a, b, {}, result.manifold);
   }
 
+  //Keep the deepest point and the one furthest from it, which is what usually keeps the body from rotating into the surface
+  void addReducedContact(SP::ContactManifold& manifold, const SP::ContactPoint& point) {
+    if(manifold.size < manifold.points.size()) {
+      manifold[manifold.size++] = point;
+      return;
+    }
+    std::array<SP::ContactPoint, 3> candidates{ manifold[0], manifold[1], point };
+    auto deepest = std::max_element(candidates.begin(), candidates.end(), [](const SP::ContactPoint& l, const SP::ContactPoint& r) {
+      return l.overlap < r.overlap;
+    });
+    std::swap(candidates[0], *deepest);
+    const auto distance2 = [&](const SP::ContactPoint& p) {
+      const glm::vec2 diff = p.centerToContactA - candidates[0].centerToContactA;
+      return glm::dot(diff, diff);
+    };
+    manifold[0] = candidates[0];
+    manifold[1] = distance2(candidates[1]) >= distance2(candidates[2]) ? candidates[1] : candidates[2];
+  }
+
+  //Collide with each triangle near b as if they were individual meshes
+  void generateContacts(ShapeRegistry::TriangleMesh& a, ShapeRegistry::Mesh& b, ContactArgs& result) {
+    if(!a.bvh) {
+      return;
+    }
+    b.modelToWorld = &result.modelToWorldB;
+    b.worldToModel = &result.worldToModelB;
+    //Bounds of b in the model space of the triangles including the radius which is in world space
+    const Transform::PackedTransform bToA = result.worldToModelA * result.modelToWorldB;
+    Geo::AABB bounds;
+    bounds.buildInit();
+    for(const glm::vec2& p : b.points) {
+      bounds.buildAdd(bToA.transformPoint(p));
+    }
+    const float radius = b.radius * std::max(
+      glm::length(result.worldToModelA.transformVector(glm::vec2{ 1, 0 })),
+      glm::length(result.worldToModelA.transformVector(glm::vec2{ 0, 1 }))
+    );
+    bounds.min -= glm::vec2{ radius };
+    bounds.max += glm::vec2{ radius };
+
+    SP::ContactManifold triangleManifold;
+    a.bvh->query(bounds, [&](uint32_t t) {
+      const ShapeRegistry::Mesh triangle{
+        .modelToWorld = &result.modelToWorldA,
+        .worldToModel = &result.worldToModelA,
+        .points = a.bvh->getTriangle(t),
+        .normals = a.bvh->getTriangleNormals(t)
+      };
+      triangleManifold.clear();
+      Narrowphase::generateContactsConvex(triangle, b, {}, triangleManifold);
+      for(uint32_t i = 0; i < triangleManifold.size; ++i) {
+        addReducedContact(result.manifold, triangleManifold[i]);
+      }
+    });
+  }
+
+  template<class B>
+  void generateContacts(ShapeRegistry::TriangleMesh& a, B& b, ContactArgs& args) {
+    ShapeRegistry::Mesh meshB = toMesh(b, args.tempB);
+    generateContacts(a, meshB, args);
+  }
+
+  //Transforms are swapped along with the shapes since the mesh path uses them
+  template<class A>
+  void generateContacts(A& a, ShapeRegistry::TriangleMesh& b, ContactArgs& args) {
+    ContactArgs swapped{
+      .modelToWorldA = args.modelToWorldB,
+      .worldToModelA = args.worldToModelB,
+      .modelToWorldB = args.modelToWorldA,
+      .worldToModelB = args.worldToModelA,
+      .tempA = args.tempB,
+      .tempB = args.tempA,
+      .manifold = args.manifold,
+      .zManifold = args.zManifold,
+      .pairType = args.pairType
+    };
+    generateContacts(b, a, swapped);
+    swapAB(args);
+  }
+
+  void generateContacts(ShapeRegistry::TriangleMesh&, ShapeRegistry::TriangleMesh&, ContactArgs&) {
+    //Static terrain doesn't collide with itself
+  }
+
   void generateContacts(Shape::Rectangle& a, Shape::Rectangle& b, ContactArgs& result) {
     Narrowphase::BoxPair pair{ toBoxElement(a), toBoxElement(b) };
     Narrowphase::boxBox(result.manifold, pair);
@@ -197,26 +296,7 @@ namespace Narrowphase {
   }
 
   void generateContacts(Shape::Circle& a, Shape::Circle& b, ContactArgs& result) {
-    const glm::vec2 ab = b.pos - a.pos;
-    const float dist2 = glm::dot(ab, ab);
-    const float radii = a.radius + b.radius;
-    constexpr float epsilon = 0.0001f;
-    if(dist2 <= radii*radii) {
-      auto& res = result.manifold.points[0];
-      result.manifold.size = 1;
-
-      float dist = std::sqrt(dist2);
-      //Circles not on top of each-other, normal is vector between them
-      if(dist > epsilon) {
-        res.normal = -ab / dist;
-      }
-      else {
-        res.normal = { 1, 0 };
-      }
-      res.centerToContactA = -res.normal*a.radius;
-      res.centerToContactB = (a.pos + res.centerToContactA) - b.pos;
-      res.overlap = radii - dist;
-    }
+    circleCircle(result.manifold, a, b);
   }
 
   void generateContacts(Shape::BodyType& a, Shape::BodyType& b, ContactArgs& result) {
@@ -253,15 +333,44 @@ namespace Narrowphase {
     return { transform.tz, transform.tz + thickness };
   }
 
-  void tryCheckZ(const UnpackedDatabaseElementID& a, const UnpackedDatabaseElementID& b, ShapeQueries& queries, ContactArgs& result, const Transform::PackedTransform& ta, const Transform::PackedTransform& tb) {
+  //Everything needed to finish a pair after its XY contacts are generated. Batched pairs are finished once their batch is generated
+  struct FinishPairArgs {
+    UnpackedDatabaseElementID a;
+    UnpackedDatabaseElementID b;
+    const Transform::PackedTransform* transformA{};
+    const Transform::PackedTransform* transformB{};
+    const Transform::PackedTransform* inverseA{};
+    const Transform::PackedTransform* inverseB{};
+    SP::ContactManifold* manifold{};
+    SP::ZContactManifold* zManifold{};
+    SP::PairType* pairType{};
+    SP::ManifoldCache* cache{};
+  };
+
+  //Per thread storage for pairs binned by shape combination
+  struct BatchStorage {
+    void clear() {
+      circleCircle.clear();
+      boxBox.clear();
+      deferred.clear();
+    }
+
+    CircleCircleBatch circleCircle;
+    BoxBoxBatch boxBox;
+    std::vector<FinishPairArgs> deferred;
+    uint32_t reused{};
+    uint32_t generated{};
+  };
+
+  void tryCheckZ(ShapeQueries& queries, const FinishPairArgs& result) {
     //If it's already not colliding on XY then Z doesn't matter
-    if(!result.manifold.size) {
+    if(!result.manifold->size) {
       //Default to XY if both are empty since Z can't indicate empty
-      result.pairType = SP::PairType::ContactXY;
+      *result.pairType = SP::PairType::ContactXY;
       return;
     }
-    const Geo::Range1D rangeA = getZRange(a, queries, ta);
-    const Geo::Range1D rangeB = getZRange(b, queries, tb);
+    const Geo::Range1D rangeA = getZRange(result.a, queries, *result.transformA);
+    const Geo::Range1D rangeB = getZRange(result.b, queries, *result.transformB);
     //If they are overlapping, solve on XZ only. If not overlapping, solve Z to ensure they don't pass through each-other on the Z axis
     const Geo::RangeOverlap overlap = Geo::classifyRangeOverlap(rangeA, rangeB);
     float distance = Geo::getRangeDistance(overlap, rangeA, rangeB);
@@ -269,18 +378,18 @@ namespace Narrowphase {
     //If they aren't, solve Z and ignore XY
     constexpr float overlapTolerance = Z_OVERLAP_TOLERANCE;
     if(distance > 0.0f) {
-      result.zManifold.info = SP::ZInfo{
+      result.zManifold->info = SP::ZInfo{
         Geo::getRangeNormal(overlap),
         //Provide information to solver as if they were closer to overlapping than they actually are
         //This keeps them at least twice the overlap tolerance apart, because if they got within the tolerance
         //then collision would not be prevented
         distance - overlapTolerance,
       };
-      result.manifold.clear();
-      result.pairType = SP::PairType::ContactZ;
+      result.manifold->clear();
+      *result.pairType = SP::PairType::ContactZ;
     }
     else {
-      result.pairType = SP::PairType::ContactXY;
+      *result.pairType = SP::PairType::ContactXY;
     }
   }
 
@@ -309,12 +418,97 @@ namespace Narrowphase {
     return getCollisionMask(queries, a) & getCollisionMask(queries, b);
   }
 
-  void generateInline(IAppBuilder& builder, size_t threadCount) {
+  //Adds the pair to the batch for its shape combination if there is one
+  bool tryBatchContacts(Shape::BodyType& a, Shape::BodyType& b, SP::ContactManifold& manifold, BatchStorage& batches) {
+    if(const Shape::Rectangle* rectA = std::get_if<Shape::Rectangle>(&a.shape)) {
+      if(const Shape::Rectangle* rectB = std::get_if<Shape::Rectangle>(&b.shape)) {
+        batches.boxBox.push({ toBoxElement(*rectA), toBoxElement(*rectB) }, manifold);
+        return true;
+      }
+      if(const Shape::AABB* aabbB = std::get_if<Shape::AABB>(&b.shape)) {
+        batches.boxBox.push({ toBoxElement(*rectA), toBoxElement(*aabbB) }, manifold);
+        return true;
+      }
+    }
+    else if(const Shape::Circle* circleA = std::get_if<Shape::Circle>(&a.shape)) {
+      if(const Shape::Circle* circleB = std::get_if<Shape::Circle>(&b.shape)) {
+        batches.circleCircle.push(*circleA, *circleB, manifold);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  //Sleeping bodies aren't moving so anything beyond rounding error means one was moved directly
+  constexpr float SLEEPING_MOVE_TOLERANCE = 0.0001f;
+
+  //Predict where B would be if it kept the relative transform from when the manifold was cached and see if it's still there
+  bool canReuseManifold(const SP::ManifoldCache& cache, const Transform::PackedTransform& transformA, const Transform::PackedTransform& transformB, float tolerance) {
+    if(!cache.isValid) {
+      return false;
+    }
+    //Scale is in the basis so the rotation difference is also roughly in world units
+    const Transform::PackedTransform predictedB = transformA * cache.relativeTransform;
+    return std::abs(predictedB.tx - transformB.tx) <= tolerance &&
+      std::abs(predictedB.ty - transformB.ty) <= tolerance &&
+      std::abs(predictedB.ax - transformB.ax) <= tolerance &&
+      std::abs(predictedB.ay - transformB.ay) <= tolerance &&
+      std::abs(predictedB.bx - transformB.bx) <= tolerance &&
+      std::abs(predictedB.by - transformB.by) <= tolerance;
+  }
+
+  //Move the cached model space manifold back into world space. Warm starts are left as they are in the manifold
+  void reuseManifold(const FinishPairArgs& pair) {
+    const SP::ContactManifold& cached = pair.cache->manifold;
+    SP::ContactManifold& manifold = *pair.manifold;
+    manifold.size = cached.size;
+    for(uint32_t i = 0; i < cached.size; ++i) {
+      SP::ContactPoint& point = manifold[i];
+      point.normal = glm::normalize(pair.transformA->transformVector(cached[i].normal));
+      point.centerToContactA = pair.transformA->transformVector(cached[i].centerToContactA);
+      point.centerToContactB = pair.transformB->transformVector(cached[i].centerToContactB);
+      point.overlap = cached[i].overlap;
+    }
+  }
+
+  void storeManifold(const FinishPairArgs& pair) {
+    SP::ManifoldCache& cache = *pair.cache;
+    const SP::ContactManifold& manifold = *pair.manifold;
+    cache.isValid = true;
+    cache.relativeTransform = *pair.inverseA * *pair.transformB;
+    cache.manifold.size = manifold.size;
+    for(uint32_t i = 0; i < manifold.size; ++i) {
+      SP::ContactPoint& point = cache.manifold[i];
+      point.normal = pair.inverseA->transformVector(manifold[i].normal);
+      point.centerToContactA = pair.inverseA->transformVector(manifold[i].centerToContactA);
+      point.centerToContactB = pair.inverseB->transformVector(manifold[i].centerToContactB);
+      point.overlap = manifold[i].overlap;
+    }
+  }
+
+  //Cache the XY manifold before the Z check since that clears it if the pair is separated on Z
+  void finishGeneratedPair(ShapeQueries& queries, const FinishPairArgs& pair) {
+    storeManifold(pair);
+    tryCheckZ(queries, pair);
+  }
+
+  void generateBatchedContacts(BatchStorage& batches, ShapeQueries& queries) {
+    generateContacts(batches.boxBox);
+    generateContacts(batches.circleCircle);
+    for(const FinishPairArgs& pair : batches.deferred) {
+      finishGeneratedPair(queries, pair);
+    }
+    batches.clear();
+  }
+
+  void generateInline(IAppBuilder& builder, size_t threadCount, const float* manifoldReuseTolerance) {
     auto task = builder.createTask();
     std::vector<std::shared_ptr<ShapeRegistry::IShapeClassifier>> classifiers(threadCount, nullptr);
+    std::vector<std::shared_ptr<BatchStorage>> batchStorage(threadCount, nullptr);
     const auto* reg = ShapeRegistry::get(task);
     for(size_t i = 0; i < threadCount; ++i) {
       classifiers[i] = reg->createShapeClassifier(task);
+      batchStorage[i] = std::make_shared<BatchStorage>();
     }
     task.setName("generate contacts inline");
 
@@ -322,10 +516,16 @@ namespace Narrowphase {
     {
       auto setup = builder.createTask();
       auto q = setup.query<SP::ManifoldRow>();
+      auto stats = setup.query<SP::ManifoldCacheStatsRow>();
       setup.setName("set task size");
-      setup.setCallback([config, q](AppTaskArgs&) mutable {
+      setup.setCallback([config, q, stats](AppTaskArgs&) mutable {
+        if(SP::ManifoldCacheStats* s = stats.tryGetSingletonElement()) {
+          s->reused = 0;
+          s->generated = 0;
+        }
         AppTaskSize size;
-        size.batchSize = 10;
+        //Large enough that the shape combination batches have enough pairs to be worth running wide
+        size.batchSize = 100;
         size.workItemCount = 0;
         for(size_t t = 0; t < q.size(); ++t) {
           size.workItemCount += q.get<0>(t).size();
@@ -336,29 +536,33 @@ namespace Narrowphase {
     }
 
     auto sq = buildShapeQueries(task);
-    auto query = task.query<const SP::ObjA, const SP::ObjB, SP::ManifoldRow, SP::ZManifoldRow, SP::PairTypeRow>();
+    auto query = task.query<const SP::ObjA, const SP::ObjB, SP::ManifoldRow, SP::ZManifoldRow, SP::PairTypeRow, SP::IsSleepingRow, SP::ManifoldCacheRow>();
+    auto stats = task.query<SP::ManifoldCacheStatsRow>();
     auto ids = task.getIDResolver();
 
-    task.setCallback([sq, query, ids, classifiers](AppTaskArgs& args) mutable {
+    task.setCallback([sq, query, stats, ids, classifiers, batchStorage, manifoldReuseTolerance](AppTaskArgs& args) mutable {
       ShapeQueries shapeQuery{ sq.createThreadLocalCopy() };
       ShapeRegistry::IShapeClassifier& classifier = *classifiers[args.threadIndex];
+      BatchStorage& batches = *batchStorage[args.threadIndex];
+      const float reuseTolerance = manifoldReuseTolerance ? *manifoldReuseTolerance : 0.0f;
+      std::vector<glm::vec2> tempA, tempB;
       auto resolver = ids->getRefResolver();
       size_t currentIndex = 0;
       CachedRow<const Transform::WorldTransformRow> wta, wtb;
       CachedRow<const Transform::WorldInverseTransformRow> ita, itb;
       for(size_t t = 0; t < query.size(); ++t) {
-        auto [a, b, manifold, zManifold, pairType] = query.get(t);
+        auto [a, b, manifold, zManifold, pairType, isSleeping, manifoldCache] = query.get(t);
         const size_t thisTableStart = currentIndex;
         const size_t thisTableEnd = thisTableStart + a->size();
         currentIndex += a->size();
-        if(args.begin < thisTableStart) {
+        //Larger batches are more likely to span multiple tables, continue into the next one until the end of the range
+        if(args.end <= thisTableStart) {
           break;
         }
         if(args.begin >= thisTableEnd) {
           continue;
         }
-        std::vector<glm::vec2> tempA, tempB;
-        for(size_t ri = args.begin; ri < std::min(args.end, thisTableEnd); ++ri) {
+        for(size_t ri = std::max(args.begin, thisTableStart); ri < std::min(args.end, thisTableEnd); ++ri) {
           const size_t i = ri - thisTableStart;
           const ElementRef& stableA = a->at(i);
           if(stableA == ElementRef{}) {
@@ -368,6 +572,8 @@ namespace Narrowphase {
           if(!SP::isContactPair(pairT)) {
             continue;
           }
+          //Z is still solved while asleep so only XY pairs keep their manifold
+          const bool sleeping = isSleeping->at(i) && pairT == SP::PairType::ContactXY;
 
           const ElementRef& stableB = b->at(i);
           //TODO: fast path if it's the same table as last time
@@ -399,9 +605,40 @@ namespace Narrowphase {
           const Transform::PackedTransform& transformB = wtb->at(ib);
           const Transform::PackedTransform& inverseB = itb->at(ib);
 
+          const FinishPairArgs finish{
+            .a = *resolvedA,
+            .b = *resolvedB,
+            .transformA = &transformA,
+            .transformB = &transformB,
+            .inverseA = &inverseA,
+            .inverseB = &inverseB,
+            .manifold = &man,
+            .zManifold = &zMan,
+            .pairType = &pairT,
+            .cache = &manifoldCache->at(i)
+          };
+          //Sleeping pairs always keep their manifold unless one of the bodies was moved directly, since they don't move on their own
+          const float tolerance = sleeping ? std::max(reuseTolerance, SLEEPING_MOVE_TOLERANCE) : reuseTolerance;
+          if(tolerance > 0.0f && canReuseManifold(*finish.cache, transformA, transformB, tolerance)) {
+            reuseManifold(finish);
+            tryCheckZ(shapeQuery, finish);
+            ++batches.reused;
+            continue;
+          }
+          //Clearing the flag is what tells the solver to wake the island since the bodies were teleported
+          if(sleeping) {
+            isSleeping->at(i) = 0;
+          }
+          ++batches.generated;
+
           //TODO: is non-const because of ispc signature, should be const
           Shape::BodyType shapeA = classifier.classifyShape(*resolvedA, transformA, inverseA);
           Shape::BodyType shapeB = classifier.classifyShape(*resolvedB, transformB, inverseB);
+          //Common shape combinations are binned and generated together below, the rest are generated one at a time
+          if(tryBatchContacts(shapeA, shapeB, man, batches)) {
+            batches.deferred.push_back(finish);
+            continue;
+          }
           ContactArgs cargs{
             .modelToWorldA = transformA,
             .worldToModelA = inverseA,
@@ -414,15 +651,47 @@ namespace Narrowphase {
             .pairType = pairT
           };
           generateContacts(shapeA, shapeB, cargs);
-          tryCheckZ(*resolvedA, *resolvedB, shapeQuery, cargs, transformA, transformB);
+          finishGeneratedPair(shapeQuery, finish);
         }
       }
+      generateBatchedContacts(batches, shapeQuery);
+      if(SP::ManifoldCacheStats* s = stats.tryGetSingletonElement()) {
+        s->reused += batches.reused;
+        s->generated += batches.generated;
+      }
+      batches.reused = batches.generated = 0;
     });
 
     builder.submitTask(std::move(task));
   }
 
-  void generateContactsFromSpatialPairs(IAppBuilder& builder, size_t threadCount) {
-    generateInline(builder, threadCount);
+  void generateContactsFromSpatialPairs(IAppBuilder& builder, size_t threadCount, const float* manifoldReuseTolerance) {
+    generateInline(builder, threadCount, manifoldReuseTolerance);
+  }
+
+  void generateContacts(ShapeRegistry::BodyType& a,
+    const Transform::PackedTransform& modelToWorldA,
+    const Transform::PackedTransform& worldToModelA,
+    ShapeRegistry::BodyType& b,
+    const Transform::PackedTransform& modelToWorldB,
+    const Transform::PackedTransform& worldToModelB,
+    std::vector<glm::vec2>& tempA,
+    std::vector<glm::vec2>& tempB,
+    SP::ContactManifold& manifold) {
+    SP::ZContactManifold zManifold;
+    SP::PairType pairType{};
+    manifold.clear();
+    ContactArgs args{
+      .modelToWorldA = modelToWorldA,
+      .worldToModelA = worldToModelA,
+      .modelToWorldB = modelToWorldB,
+      .worldToModelB = worldToModelB,
+      .tempA = tempA,
+      .tempB = tempB,
+      .manifold = manifold,
+      .zManifold = zManifold,
+      .pairType = pairType
+    };
+    generateContacts(a, b, args);
   }
 }
\ No newline at end of file
@@ -13,6 +13,9 @@ namespace ShapeRegistry {
   struct BodyType;
   struct IShapeClassifier;
 };
+namespace SP {
+  struct ContactManifold;
+}
 
 namespace Narrowphase {
   //This indirection has no practical significance, I moved types around and didn't want to update use locations
@@ -43,7 +46,21 @@ namespace Narrowphase {
 
   //Takes the pairs stored in SpatialPairsTable and generates the contacts needed to resolve the spatial
   //queries or constraint solving
-  void generateContactsFromSpatialPairs(IAppBuilder& builder, size_t threadCount);
+  //Pairs that moved less than manifoldReuseTolerance relative to each-other since their last generation reuse their previous manifold
+  //The tolerance is read every frame, null or zero disables reuse
+  void generateContactsFromSpatialPairs(IAppBuilder& builder, size_t threadCount, const float* manifoldReuseTolerance = nullptr);
+  //Contacts between two shapes outside of any spatial pair, as used by immediate spatial queries
+  //Points are relative to the center of each shape and the normal points from A to B. Z and thickness are not considered
+  //tempA and tempB are scratch for converting shapes to meshes, owned by the caller so repeated calls don't allocate
+  void generateContacts(ShapeRegistry::BodyType& a,
+    const Transform::PackedTransform& modelToWorldA,
+    const Transform::PackedTransform& worldToModelA,
+    ShapeRegistry::BodyType& b,
+    const Transform::PackedTransform& modelToWorldB,
+    const Transform::PackedTransform& worldToModelB,
+    std::vector<glm::vec2>& tempA,
+    std::vector<glm::vec2>& tempB,
+    SP::ContactManifold& manifold);
 
   ShapeRegistry::Mesh toMesh(const ShapeRegistry::Rectangle& v, std::vector<glm::vec2>& storage);
   ShapeRegistry::Mesh toMesh(const ShapeRegistry::AABB& v, std::vector<glm::vec2>& storage);
@@ -51,4 +68,5 @@ namespace Narrowphase {
   ShapeRegistry::Mesh toMesh(const ShapeRegistry::Circle& v, std::vector<glm::vec2>& storage);
   ShapeRegistry::Mesh toMesh(std::monostate, std::vector<glm::vec2>& storage);
   ShapeRegistry::Mesh toMesh(const ShapeRegistry::Mesh& mesh, std::vector<glm::vec2>&);
+  ShapeRegistry::Mesh toMesh(const ShapeRegistry::TriangleMesh& mesh, std::vector<glm::vec2>&);
 }
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "Precompile.h"
+#include "NarrowphaseBatch.h"
+
+#include "out_ispc/unity.h"
+#include "Profile.h"
+#include "SpatialPairsStorage.h"
+
+namespace Narrowphase {
+  void circleCircle(SP::ContactManifold& manifold, const ShapeRegistry::Circle& a, const ShapeRegistry::Circle& b) {
+    const glm::vec2 ab = b.pos - a.pos;
+    const float dist2 = glm::dot(ab, ab);
+    const float radii = a.radius + b.radius;
+    constexpr float epsilon = 0.0001f;
+    if(dist2 <= radii*radii) {
+      auto& res = manifold.points[0];
+      manifold.size = 1;
+
+      float dist = std::sqrt(dist2);
+      //Circles not on top of each-other, normal is vector between them
+      if(dist > epsilon) {
+        res.normal = -ab / dist;
+      }
+      else {
+        res.normal = { 1, 0 };
+      }
+      res.centerToContactA = -res.normal*a.radius;
+      res.centerToContactB = (a.pos + res.centerToContactA) - b.pos;
+      res.overlap = radii - dist;
+    }
+  }
+
+  void CircleCircleBatch::clear() {
+    posAX.clear();
+    posAY.clear();
+    radiusA.clear();
+    posBX.clear();
+    posBY.clear();
+    radiusB.clear();
+    manifolds.clear();
+  }
+
+  void CircleCircleBatch::push(const ShapeRegistry::Circle& a, const ShapeRegistry::Circle& b, SP::ContactManifold& manifold) {
+    posAX.push_back(a.pos.x);
+    posAY.push_back(a.pos.y);
+    radiusA.push_back(a.radius);
+    posBX.push_back(b.pos.x);
+    posBY.push_back(b.pos.y);
+    radiusB.push_back(b.radius);
+    manifolds.push_back(&manifold);
+  }
+
+  size_t CircleCircleBatch::size() const {
+    return manifolds.size();
+  }
+
+  void BoxBoxBatch::clear() {
+    pairs.clear();
+    posAX.clear();
+    posAY.clear();
+    rotAX.clear();
+    rotAY.clear();
+    scaleAX.clear();
+    scaleAY.clear();
+    posBX.clear();
+    posBY.clear();
+    rotBX.clear();
+    rotBY.clear();
+    scaleBX.clear();
+    scaleBY.clear();
+    manifolds.clear();
+  }
+
+  void BoxBoxBatch::push(const BoxPair& pair, SP::ContactManifold& manifold) {
+    pairs.push_back(pair);
+    posAX.push_back(pair.a.pos.x);
+    posAY.push_back(pair.a.pos.y);
+    rotAX.push_back(pair.a.rot.x);
+    rotAY.push_back(pair.a.rot.y);
+    scaleAX.push_back(pair.a.scale.x);
+    scaleAY.push_back(pair.a.scale.y);
+    posBX.push_back(pair.b.pos.x);
+    posBY.push_back(pair.b.pos.y);
+    rotBX.push_back(pair.b.rot.x);
+    rotBY.push_back(pair.b.rot.y);
+    scaleBX.push_back(pair.b.scale.x);
+    scaleBY.push_back(pair.b.scale.y);
+    manifolds.push_back(&manifold);
+  }
+
+  size_t BoxBoxBatch::size() const {
+    return manifolds.size();
+  }
+
+  void generateContacts(CircleCircleBatch& batch) {
+    PROFILE_SCOPE("physics", "circleCircleBatch");
+    const size_t count = batch.size();
+    if(!count) {
+      return;
+    }
+    batch.normalX.resize(count);
+    batch.normalY.resize(count);
+    batch.overlap.resize(count);
+    batch.touching.resize(count);
+    ispc::circleCircleContacts(
+      batch.posAX.data(),
+      batch.posAY.data(),
+      batch.radiusA.data(),
+      batch.posBX.data(),
+      batch.posBY.data(),
+      batch.radiusB.data(),
+      batch.normalX.data(),
+      batch.normalY.data(),
+      batch.overlap.data(),
+      batch.touching.data(),
+      static_cast<uint32_t>(count)
+    );
+
+    for(size_t i = 0; i < count; ++i) {
+      if(!batch.touching[i]) {
+        continue;
+      }
+      SP::ContactManifold& manifold = *batch.manifolds[i];
+      auto& res = manifold.points[0];
+      manifold.size = 1;
+      res.normal = { batch.normalX[i], batch.normalY[i] };
+      res.centerToContactA = -res.normal*batch.radiusA[i];
+      res.centerToContactB = (glm::vec2{ batch.posAX[i], batch.posAY[i] } + res.centerToContactA) - glm::vec2{ batch.posBX[i], batch.posBY[i] };
+      res.overlap = batch.overlap[i];
+    }
+  }
+
+  void generateContacts(BoxBoxBatch& batch) {
+    PROFILE_SCOPE("physics", "boxBoxBatch");
+    const size_t count = batch.size();
+    if(!count) {
+      return;
+    }
+    batch.overlap.resize(count);
+    batch.direction.resize(count);
+    batch.supportA.resize(count);
+    batch.supportB.resize(count);
+    batch.axis.resize(count);
+    ispc::boxBoxSeparatingAxes(
+      batch.posAX.data(),
+      batch.posAY.data(),
+      batch.rotAX.data(),
+      batch.rotAY.data(),
+      batch.scaleAX.data(),
+      batch.scaleAY.data(),
+      batch.posBX.data(),
+      batch.posBY.data(),
+      batch.rotBX.data(),
+      batch.rotBY.data(),
+      batch.scaleBX.data(),
+      batch.scaleBY.data(),
+      batch.overlap.data(),
+      batch.direction.data(),
+      batch.supportA.data(),
+      batch.supportB.data(),
+      batch.axis.data(),
+      static_cast<uint32_t>(count)
+    );
+
+    //Clipping branches too much to be worth doing wide, and separated pairs are skipped before getting here
+    for(size_t i = 0; i < count; ++i) {
+      if(batch.overlap[i] < 0) {
+        continue;
+      }
+      const SeparatingAxis axis{
+        .overlap = batch.overlap[i],
+        .direction = batch.direction[i],
+        .supportA = batch.supportA[i],
+        .supportB = batch.supportB[i],
+        .axis = batch.axis[i]
+      };
+      boxBox(*batch.manifolds[i], batch.pairs[i], axis);
+    }
+  }
+}
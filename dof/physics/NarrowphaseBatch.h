@@ -0,0 +1,43 @@
+#pragma once
+
+#include "BoxBox.h"
+#include "shapes/ShapeRegistry.h"
+
+namespace SP {
+  struct ContactManifold;
+};
+
+namespace Narrowphase {
+  void circleCircle(SP::ContactManifold& manifold, const ShapeRegistry::Circle& a, const ShapeRegistry::Circle& b);
+
+  //Pairs of the same shape combination gathered in SoA so that contacts for all of them can be generated by one kernel
+  //The manifolds are where the results of each pair are written to and are expected to already be cleared
+  struct CircleCircleBatch {
+    void clear();
+    void push(const ShapeRegistry::Circle& a, const ShapeRegistry::Circle& b, SP::ContactManifold& manifold);
+    size_t size() const;
+
+    std::vector<float> posAX, posAY, radiusA;
+    std::vector<float> posBX, posBY, radiusB;
+    std::vector<float> normalX, normalY, overlap;
+    std::vector<uint8_t> touching;
+    std::vector<SP::ContactManifold*> manifolds;
+  };
+
+  //The separating axes are found for the whole batch at once, then the overlapping ones are clipped one at a time
+  struct BoxBoxBatch {
+    void clear();
+    void push(const BoxPair& pair, SP::ContactManifold& manifold);
+    size_t size() const;
+
+    std::vector<BoxPair> pairs;
+    std::vector<float> posAX, posAY, rotAX, rotAY, scaleAX, scaleAY;
+    std::vector<float> posBX, posBY, rotBX, rotBY, scaleBX, scaleBY;
+    std::vector<float> overlap;
+    std::vector<uint8_t> direction, supportA, supportB, axis;
+    std::vector<SP::ContactManifold*> manifolds;
+  };
+
+  void generateContacts(CircleCircleBatch& batch);
+  void generateContacts(BoxBoxBatch& batch);
+}
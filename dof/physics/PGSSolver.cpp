@@ -2,6 +2,9 @@
 #include "Precompile.h"
 #include "PGSSolver.h"
 
+#include <bit>
+#include "out_ispc/unity.h"
+
 namespace PGS {
   float dot(const float* a, const float* b) {
     return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
@@ -13,9 +16,16 @@ namespace PGS {
     }
   }
 
+  //Infinite mass bodies have all zeroes here and are skipped so that they can be shared by constraints solved in parallel
+  void tryApplyImpulse(float* va, float lambda, const float* jacobianTMass) {
+    if(jacobianTMass[0] || jacobianTMass[1] || jacobianTMass[2]) {
+      applyImpulse(va, lambda, jacobianTMass);
+    }
+  }
+
   void applyImpulse(float* va, float* vb, float lambda, const float* jacobianTMass) {
-    applyImpulse(va, lambda, jacobianTMass);
-    applyImpulse(vb, lambda, jacobianTMass + 3);
+    tryApplyImpulse(va, lambda, jacobianTMass);
+    tryApplyImpulse(vb, lambda, jacobianTMass + 3);
   }
 
   void BodyStorage::resize(BodyIndex bodies) {
@@ -242,20 +252,24 @@ namespace PGS {
     return result;
   }
 
+  void computeDiagonal(SolveContext& solver, ConstraintIndex i) {
+    const float* jma = solver.jacobianTMass.getJacobianIndex(i);
+    const float* jmb = jma + Jacobian::BLOCK_SIZE;
+    const float* ja = solver.jacobian.getJacobianIndex(i);
+    const float* jb = ja + Jacobian::BLOCK_SIZE;
+    const float denom = dot(ja, jma) + dot(jb, jmb);
+    //A pair of immobile objects generally shouldn't make it here if they have been flagged as immobile in the contact graph.
+    //However, if mass is being recomputed or initialized they may be zero here momentarily.
+    //An epsilon may make sense for near zero division but at the moment no masses are that large.
+    solver.diagonal[i] = denom ? 1.0f / denom : 0.0f;
+  }
+
   SolveResult advancePGS(SolveContext& solver, size_t begin, size_t end) {
     //Precompute the diagonal of the matrix on the first iteration
     //TODO: should premultiply step go here too?
     if(!solver.currentIteration) {
       for(ConstraintIndex i = begin; i < end; ++i) {
-        const float* jma = solver.jacobianTMass.getJacobianIndex(i);
-        const float* jmb = jma + Jacobian::BLOCK_SIZE;
-        const float* ja = solver.jacobian.getJacobianIndex(i);
-        const float* jb = ja + Jacobian::BLOCK_SIZE;
-        const float denom = dot(ja, jma) + dot(jb, jmb);
-        //A pair of immobile objects generally shouldn't make it here if they have been flagged as immobile in the contact graph.
-        //However, if mass is being recomputed or initialized they may be zero here momentarily.
-        //An epsilon may make sense for near zero division but at the moment no masses are that large.
-        solver.diagonal[i] = denom ? 1.0f / denom : 0.0f;
+        computeDiagonal(solver, i);
       }
     }
 
@@ -279,6 +293,80 @@ namespace PGS {
     return result;
   }
 
+  SolveResult advancePGSWide(SolveContext& solver, const IndependentRows& rows) {
+    if(!solver.currentIteration) {
+      for(ConstraintIndex i : rows.rows) {
+        computeDiagonal(solver, i);
+      }
+    }
+
+    SolveResult result;
+    result.remainingError = ispc::advancePGSLevels(
+      rows.rows.data(),
+      rows.levelBegins.data(),
+      rows.levelCount(),
+      solver.mapping.bodyIndices,
+      solver.jacobian.values,
+      solver.jacobianTMass.values,
+      solver.bias,
+      solver.diagonal,
+      solver.lambdaMin,
+      solver.lambdaMax,
+      solver.lambda,
+      solver.velocity.values
+    );
+    return result;
+  }
+
+  void groupIndependentRows(IndependentRows& result,
+    const SolveContext& solver,
+    ConstraintIndex begin,
+    ConstraintIndex end,
+    std::vector<uint32_t>& bodyLevels
+  ) {
+    assert(bodyLevels.size() >= solver.bodies);
+    auto isInfiniteMass = [&](BodyIndex body) {
+      const float* m = solver.mass.getObjectMass(body);
+      return !m[0] && !m[1];
+    };
+    //Each row goes in the level after the last one used by either of its bodies
+    result.rowLevels.resize(end - begin);
+    uint32_t levelCount = 0;
+    for(ConstraintIndex i = begin; i < end; ++i) {
+      const auto [a, b] = solver.mapping.getPairForConstraint(i);
+      const bool sharedA = isInfiniteMass(a);
+      const bool sharedB = isInfiniteMass(b);
+      const uint32_t level = std::max(sharedA ? 0 : bodyLevels[a], sharedB ? 0 : bodyLevels[b]);
+      if(!sharedA) {
+        bodyLevels[a] = level + 1;
+      }
+      if(!sharedB) {
+        bodyLevels[b] = level + 1;
+      }
+      result.rowLevels[i - begin] = level;
+      levelCount = std::max(levelCount, level + 1);
+    }
+
+    //Counting sort by level, keeping rows in their original order within a level
+    result.levelBegins.assign(levelCount + 1, 0);
+    for(uint32_t level : result.rowLevels) {
+      ++result.levelBegins[level + 1];
+    }
+    for(uint32_t level = 1; level <= levelCount; ++level) {
+      result.levelBegins[level] += result.levelBegins[level - 1];
+    }
+    result.rows.resize(end - begin);
+    for(ConstraintIndex i = begin; i < end; ++i) {
+      //Use the counts to write, then shift them back to the beginning of each level below
+      result.rows[result.levelBegins[result.rowLevels[i - begin]]++] = i;
+      const auto [a, b] = solver.mapping.getPairForConstraint(i);
+      bodyLevels[a] = bodyLevels[b] = 0;
+    }
+    for(uint32_t level = levelCount; level > 0; --level) {
+      result.levelBegins[level] = result.levelBegins[level - 1];
+    }
+    result.levelBegins[0] = 0;
+  }
 
   void warmStart(SolveContext& solver) {
     warmStart(solver, 0, solver.constraints);
@@ -339,6 +427,70 @@ namespace PGS {
     return solvePGS(solver);
   }
 
+  void colorBatches(BatchColoring& result,
+    const std::pair<BodyIndex, BodyIndex>* pairs,
+    size_t count,
+    BodyIndex bodyCount,
+    size_t batchSize,
+    BodyIndex sharedBody
+  ) {
+    constexpr size_t OVERFLOW_COLOR = BatchColoring::MAX_COLORS;
+    assert(batchSize);
+    result.bodyColors.assign(bodyCount, 0);
+    result.colors.resize(count);
+    std::array<size_t, BatchColoring::MAX_COLORS + 1> colorSizes{};
+    auto getUsedColors = [&](BodyIndex body) {
+      return body == sharedBody ? uint64_t{} : result.bodyColors[body];
+    };
+    auto addColor = [&](BodyIndex body, uint64_t bit) {
+      if(body != sharedBody) {
+        result.bodyColors[body] |= bit;
+      }
+    };
+    for(size_t i = 0; i < count; ++i) {
+      const auto [a, b] = pairs[i];
+      assert((a == sharedBody || a < bodyCount) && (b == sharedBody || b < bodyCount));
+      //Lowest color that neither body has used yet, or the overflow color if all are taken
+      const size_t color = static_cast<size_t>(std::countr_one(getUsedColors(a) | getUsedColors(b)));
+      if(color != OVERFLOW_COLOR) {
+        const uint64_t bit = uint64_t{ 1 } << color;
+        addColor(a, bit);
+        addColor(b, bit);
+      }
+      result.colors[i] = static_cast<uint8_t>(color);
+      ++colorSizes[color];
+    }
+
+    //Stable counting sort by color so constraints keep their relative order within a color
+    std::array<size_t, BatchColoring::MAX_COLORS + 1> writeIndex{};
+    for(size_t color = 1; color < writeIndex.size(); ++color) {
+      writeIndex[color] = writeIndex[color - 1] + colorSizes[color - 1];
+    }
+    result.order.resize(count);
+    for(size_t i = 0; i < count; ++i) {
+      result.order[writeIndex[result.colors[i]]++] = static_cast<uint32_t>(i);
+    }
+
+    result.batchBegins.clear();
+    result.colorBegins.clear();
+    size_t begin = 0;
+    for(size_t color = 0; color < colorSizes.size(); ++color) {
+      if(!colorSizes[color]) {
+        continue;
+      }
+      const size_t end = begin + colorSizes[color];
+      result.colorBegins.push_back(result.batchBegins.size());
+      //Constraints in the overflow color may share bodies so they all go in one batch
+      const size_t step = color == OVERFLOW_COLOR ? colorSizes[color] : batchSize;
+      for(size_t b = begin; b < end; b += step) {
+        result.batchBegins.push_back(b);
+      }
+      begin = end;
+    }
+    result.colorBegins.push_back(result.batchBegins.size());
+    result.batchBegins.push_back(count);
+  }
+
   float computeJV(ConstraintIndex constraintIndex, SolveContext& solver) {
     const BodyIndex a = *solver.mapping.getPairPointerForConstraint(constraintIndex);
     const float* ja = solver.jacobian.getJacobianIndex(constraintIndex);
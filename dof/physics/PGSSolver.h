@@ -222,6 +222,66 @@ namespace PGS {
     SolverConfig config;
   };
 
+  //Greedy graph coloring of constraints between pairs of bodies, split into batches where no two constraints of the same color share a body
+  //Batches of one color can then be solved in parallel without racing on body velocities, and since colors are solved in order
+  //the result is the same regardless of how the batches are distributed across threads
+  struct BatchColoring {
+    //Colors used by each body are tracked in a bitmask. Constraints that don't fit go in a final color that must be solved serially
+    static constexpr size_t MAX_COLORS = 64;
+
+    size_t colorCount() const {
+      return colorBegins.size() ? colorBegins.size() - 1 : 0;
+    }
+
+    size_t batchCount() const {
+      return batchBegins.size() ? batchBegins.size() - 1 : 0;
+    }
+
+    //Input indices sorted by color then batch
+    std::vector<uint32_t> order;
+    //Index in order where each batch begins, followed by the total count
+    std::vector<size_t> batchBegins;
+    //Batch where each color begins, followed by the total batch count
+    std::vector<size_t> colorBegins;
+    //Scratch
+    std::vector<uint64_t> bodyColors;
+    std::vector<uint8_t> colors;
+  };
+
+  //sharedBody may be used by any number of constraints in a color. Meant for the infinite mass body whose velocity never changes
+  void colorBatches(BatchColoring& result,
+    const std::pair<BodyIndex, BodyIndex>* pairs,
+    size_t count,
+    BodyIndex bodyCount,
+    size_t batchSize,
+    BodyIndex sharedBody
+  );
+
+  //Rows of a range grouped into levels where rows within a level don't share any bodies other than infinite mass ones
+  //Each body's rows stay in their original relative order across levels so solving level by level gives the same result
+  //as solving the range in order, while the rows of a level can be solved simultaneously
+  struct IndependentRows {
+    uint32_t levelCount() const {
+      return levelBegins.size() ? static_cast<uint32_t>(levelBegins.size() - 1) : 0;
+    }
+
+    //Row indices sorted by level
+    std::vector<ConstraintIndex> rows;
+    //Index in rows where each level begins, followed by the total count
+    std::vector<uint32_t> levelBegins;
+    //Scratch
+    std::vector<uint32_t> rowLevels;
+  };
+
+  //Bodies with zero mass and inertia are considered infinite mass and may be shared within a level
+  //bodyLevels is scratch of at least solver.bodies zeroes, and is left that way upon returning
+  void groupIndependentRows(IndependentRows& result,
+    const SolveContext& solver,
+    ConstraintIndex begin,
+    ConstraintIndex end,
+    std::vector<uint32_t>& bodyLevels
+  );
+
   struct SolveResult {
     float remainingError{};
     //If iteration or error boundary has been reached. This means solving shoudl stop
@@ -234,6 +294,8 @@ namespace PGS {
   //Iterate once
   SolveResult advancePGS(SolveContext& solver);
   SolveResult advancePGS(SolveContext& solver, size_t begin, size_t end);
+  //Same as advancePGS on the range the rows were grouped from, but solves each level with SIMD
+  SolveResult advancePGSWide(SolveContext& solver, const IndependentRows& rows);
   void advanceIteration(SolveContext& solver, SolveResult& result);
   void warmStart(SolveContext& solver);
   void warmStart(SolveContext& solver, ConstraintIndex begin, ConstraintIndex end);
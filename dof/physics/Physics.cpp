@@ -19,6 +19,7 @@
 #include <ConstraintSolver.h>
 #include <SweepNPruneBroadphase.h>
 #include <Constraints.h>
+#include <PhysicsLOD.h>
 #include <shapes/DefaultShapes.h>
 
 namespace Physics {
@@ -44,14 +45,22 @@ namespace Physics {
     auto task = builder.createTask();
     task.setName("init physics from config");
     const Config::PhysicsConfig* config = &task.query<const SharedRow<Config::GameConfig>>().tryGetSingletonElement()->physics;
-    auto query = task.query<SharedRow<Broadphase::SweepGrid::Grid>>();
+    auto query = task.query<SharedRow<Broadphase::SweepGrid::Grid>, SharedRow<Broadphase::AABBTree::Tree>>();
     task.setCallback([query, config](AppTaskArgs&) mutable {
       for(size_t t = 0; t < query.size(); ++t) {
+        auto& tree = query.get<1>(t).at();
+        tree.enabled = config->broadphase.type == Config::PhysicsConfig::Broadphase::Type::AABBTree;
+        tree.margin = config->broadphase.treeMargin;
+
         auto& grid = query.get<0>(t).at();
         grid.definition.bottomLeft = { config->broadphase.bottomLeftX, config->broadphase.bottomLeftY };
         grid.definition.cellSize = { config->broadphase.cellSizeX, config->broadphase.cellSizeY };
         grid.definition.cellsX = config->broadphase.cellCountX;
         grid.definition.cellsY = config->broadphase.cellCountY;
+        grid.margin = config->broadphase.gridMargin;
+        grid.predictionFrames = config->broadphase.gridPredictionFrames;
+        grid.maxPrediction = config->broadphase.gridMaxPrediction;
+        grid.useSoA = config->broadphase.gridSoA;
         Broadphase::SweepGrid::init(grid);
       }
     });
@@ -69,14 +78,17 @@ namespace Physics {
       &biasTerm,
       &slop
     };
+    globals.sleepVelocity = &config.sleep.velocity;
+    globals.sleepFrames = &config.sleep.frames;
+    globals.useWideSolver = &config.wideSolver;
     temp.discard();
 
-    Physics::integrateVelocity(builder);
-    Physics::applyDampingMultiplier(builder, config.linearDragMultiplier, config.angularDragMultiplier);
+    PhysicsLOD::update(builder, config);
+    Physics::integrateVelocity(builder, config.linearDragMultiplier, config.angularDragMultiplier);
     SweepNPruneBroadphase::updateBroadphase(builder);
     Constraints::update(builder, globals);
 
-    Narrowphase::generateContactsFromSpatialPairs(builder, threadCount);
+    Narrowphase::generateContactsFromSpatialPairs(builder, threadCount, &config.manifoldReuseTolerance);
     ConstraintSolver::solveConstraints(builder, globals);
 
     Physics::integratePositionAndRotation(builder);
@@ -146,45 +158,12 @@ namespace Physics {
     return std::make_unique<CompositeAppModule>(std::move(modules));
   }
 
-  void _integratePositionAxis(const float* velocity, float* position, size_t count) {
-    ispc::integratePosition(position, velocity, uint32_t(count));
-  }
-
   void _integrateRotation(float* rotX, float* rotY, const float* velocity, size_t count) {
     ispc::integrateRotation(rotX, rotY, velocity, uint32_t(count));
   }
 
-  void _applyDampingMultiplier(float* velocity, float amount, size_t count) {
-    ispc::applyDampingMultiplier(velocity, amount, uint32_t(count));
-  }
-
-  void applyDampingMultiplierAxis(IAppBuilder& builder, const QueryAlias<Row<float>>& axis, const float& multiplier) {
-    for(const TableID& table : builder.queryAliasTables(axis)) {
-      auto task = builder.createTask();
-      task.setName("damping");
-      Row<float>* axisRow = &task.queryAlias(table, axis).get<0>(0);
-      task.setCallback([axisRow, &multiplier](AppTaskArgs&) {
-        _applyDampingMultiplier(axisRow->data(), multiplier, axisRow->size());
-      });
-
-      builder.submitTask(std::move(task));
-    }
-  }
-
-  void integratePositionAxis(IAppBuilder& builder, const QueryAlias<Row<float>>& position, const QueryAlias<const Row<float>>& velocity) {
-    for(const TableID& table : builder.queryAliasTables(position, velocity)) {
-      auto task = builder.createTask();
-      task.setName("Integrate Position");
-      auto query = task.queryAlias(table, position, velocity.read());
-      task.setCallback([query](AppTaskArgs&) mutable {
-        _integratePositionAxis(
-          query.get<1>(0).data(),
-          query.get<0>(0).data(),
-          query.get<0>(0).size()
-        );
-      });
-      builder.submitTask(std::move(task));
-    }
+  void integrateVelocityAxis(float* velocity, const float* acceleration, float multiplier, size_t count) {
+    ispc::integrateVelocityDamped(velocity, acceleration, multiplier, uint32_t(count));
   }
 
   void integratePositionAxis(IAppBuilder& builder, float(Transform::PackedTransform::*axis), const QueryAlias<const Row<float>>& velocity) {
@@ -204,11 +183,67 @@ namespace Physics {
     }
   }
 
-  void integrateVelocity(IAppBuilder& builder) {
-    //Misleading name but the math is the same, add acceleration to velocity
-    integratePositionAxis(builder, FloatQueryAlias::create<VelX>(), ConstFloatQueryAlias::create<const AccelX>());
-    integratePositionAxis(builder, FloatQueryAlias::create<VelY>(), ConstFloatQueryAlias::create<const AccelY>());
-    integratePositionAxis(builder, FloatQueryAlias::create<VelZ>(), ConstFloatQueryAlias::create<const AccelZ>());
+  struct VelocityAxis {
+    Row<float>* velocity{};
+    const Row<float>* acceleration{};
+    const float* multiplier{};
+  };
+
+  //Z damping doesn't really matter because the primary use case is simple upwards impulses counteracted by gravity
+  constexpr float NO_DAMPING = 1.0f;
+
+  void integrateVelocity(IAppBuilder& builder, const float& linearMultiplier, const float& angularMultiplier) {
+    const std::array velocityAliases{
+      FloatQueryAlias::create<VelX>(),
+      FloatQueryAlias::create<VelY>(),
+      FloatQueryAlias::create<VelZ>(),
+      FloatQueryAlias::create<VelA>()
+    };
+    std::unordered_set<TableID> tables;
+    for(const auto& alias : velocityAliases) {
+      for(const TableID& table : builder.queryAliasTables(alias)) {
+        tables.insert(table);
+      }
+    }
+
+    const auto accelX = ConstFloatQueryAlias::create<const AccelX>();
+    const auto accelY = ConstFloatQueryAlias::create<const AccelY>();
+    const auto accelZ = ConstFloatQueryAlias::create<const AccelZ>();
+    //One task per table that adds acceleration and applies damping to each velocity row in the same pass
+    for(const TableID& table : tables) {
+      auto task = builder.createTask();
+      task.setName("Integrate Velocity");
+      std::vector<VelocityAxis> axes;
+      auto addAxis = [&](const QueryAlias<Row<float>>& velocity, const QueryAlias<const Row<float>>* acceleration, const float& multiplier) {
+        QueryResult<Row<float>> v = task.queryAlias(table, velocity);
+        if(!v.size()) {
+          return;
+        }
+        VelocityAxis axis{ &v.get<0>(0), nullptr, &multiplier };
+        if(acceleration) {
+          if(QueryResult<const Row<float>> a = task.queryAlias(table, *acceleration); a.size()) {
+            axis.acceleration = &a.get<0>(0);
+          }
+        }
+        axes.push_back(axis);
+      };
+      addAxis(velocityAliases[0], &accelX, linearMultiplier);
+      addAxis(velocityAliases[1], &accelY, linearMultiplier);
+      addAxis(velocityAliases[2], &accelZ, NO_DAMPING);
+      addAxis(velocityAliases[3], nullptr, angularMultiplier);
+
+      task.setCallback([axes](AppTaskArgs&) {
+        for(const VelocityAxis& axis : axes) {
+          integrateVelocityAxis(
+            axis.velocity->data(),
+            axis.acceleration ? axis.acceleration->data() : nullptr,
+            *axis.multiplier,
+            axis.velocity->size()
+          );
+        }
+      });
+      builder.submitTask(std::move(task));
+    }
   }
 
   struct Integrator {
@@ -234,6 +269,9 @@ namespace Physics {
         linVelZ = tryQuery(ConstFloatQueryAlias::create<const VelZ>());
         linVelY = tryQuery(ConstFloatQueryAlias::create<const VelY>());
         linVelX = tryQuery(ConstFloatQueryAlias::create<const VelX>());
+        if(auto q = task.query<PhysicsLOD::BodyLODRow>(table); q.size()) {
+          lod = &q.get<0>(0);
+        }
         transformQuery = task.query<Transform::WorldTransformRow, Transform::TransformNeedsUpdateRow>(table);
       }
 
@@ -258,16 +296,34 @@ namespace Physics {
         }
       }
 
+      //Velocity to move the body by this tick. Bodies at a reduced level of detail don't move on the ticks they skip
+      //but sum the velocity of each of them, then move by all of it at once when they step, so damping is accounted for
+      float advance(size_t i, float velocity, float PhysicsLOD::BodyLOD::*skipped) {
+        if(!lod) {
+          return velocity;
+        }
+        PhysicsLOD::BodyLOD& body = lod->at(i);
+        float& sum = body.*skipped;
+        if(body.isStepping()) {
+          const float result = sum + velocity;
+          sum = 0.0f;
+          return result;
+        }
+        //Frozen bodies drop the time that passes rather than catching up on it
+        sum = body.level == PhysicsLOD::Level::Frozen ? 0.0f : sum + velocity;
+        return 0.0f;
+      }
+
       template<bool X, bool Y, bool Z>
       void integrateLinearPart(size_t i, Transform::PackedTransform& t, Accumulator& a, float dt) {
         if constexpr(X) {
-          t.tx += a.accumulate(linVelX->at(i)*dt);
+          t.tx += a.accumulate(advance(i, linVelX->at(i), &PhysicsLOD::BodyLOD::skippedX)*dt);
         }
         if constexpr(Y) {
-          t.ty += a.accumulate(linVelY->at(i)*dt);
+          t.ty += a.accumulate(advance(i, linVelY->at(i), &PhysicsLOD::BodyLOD::skippedY)*dt);
         }
         if constexpr(Z) {
-          t.tz += a.accumulate(linVelZ->at(i)*dt);
+          t.tz += a.accumulate(advance(i, linVelZ->at(i), &PhysicsLOD::BodyLOD::skippedZ)*dt);
         }
       }
 
@@ -289,7 +345,7 @@ namespace Physics {
           Accumulator a;
 
           integrateLinearPart<X, Y, Z>(i, t, a, dt);
-          const float av = a.accumulate(angVel->at(i)*dt);
+          const float av = a.accumulate(advance(i, angVel->at(i), &PhysicsLOD::BodyLOD::skippedA)*dt);
           //In theory this may deteriorate the scale over time due to accumulating float precision issues
           t = t.rotatedInPlace(av);
 
@@ -336,6 +392,7 @@ namespace Physics {
       const Row<float>* linVelY{};
       const Row<float>* linVelZ{};
       const Row<float>* angVel{};
+      PhysicsLOD::BodyLODRow* lod{};
       TableID table;
     };
 
@@ -367,13 +424,6 @@ namespace Physics {
     }
   }
 
-  void applyDampingMultiplier(IAppBuilder& builder, const float& linearMultiplier, const float& angularMultiplier) {
-    applyDampingMultiplierAxis(builder, FloatQueryAlias::create<VelX>(), linearMultiplier);
-    applyDampingMultiplierAxis(builder, FloatQueryAlias::create<VelY>(), linearMultiplier);
-    //Damping on Z doesn't really matter because the primary use case is simple upwards impulses counteracted by gravity
-    applyDampingMultiplierAxis(builder, FloatQueryAlias::create<VelA>(), angularMultiplier);
-  }
-
   std::shared_ptr<ShapeRegistry::IShapeClassifier> createShapeClassifier(RuntimeDatabaseTaskBuilder& task) {
     return ShapeRegistry::get(task)->createShapeClassifier(task);
   }
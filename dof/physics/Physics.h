@@ -31,8 +31,10 @@ namespace Physics {
 
   std::unique_ptr<IAppModule> createModule(std::function<size_t(RuntimeDatabaseTaskBuilder&)> threadCount);
 
-  void integrateVelocity(IAppBuilder& builder);
+  //Adds acceleration to velocity then applies damping, one pass per table
+  void integrateVelocity(IAppBuilder& builder, const float& linearMultiplier, const float& angularMultiplier);
   void integratePositionAndRotation(IAppBuilder& builder);
-  void applyDampingMultiplier(IAppBuilder& builder, const float& linearMultiplier, const float& angularMultiplier);
+  //velocity = (velocity + acceleration)*multiplier for a single velocity row, acceleration may be null
+  void integrateVelocityAxis(float* velocity, const float* acceleration, float multiplier, size_t count);
   std::shared_ptr<ShapeRegistry::IShapeClassifier> createShapeClassifier(RuntimeDatabaseTaskBuilder& task);
 };
\ No newline at end of file
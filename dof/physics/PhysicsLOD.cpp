@@ -0,0 +1,181 @@
+#include "Precompile.h"
+#include "PhysicsLOD.h"
+
+#include "AppBuilder.h"
+#include "IslandGraph.h"
+#include "Physics.h"
+#include "SpatialPairsStorage.h"
+#include "glm/glm.hpp"
+#include <transform/TransformRows.h>
+
+namespace PhysicsLOD {
+  namespace {
+    using LODConfig = Config::PhysicsConfig::LOD;
+
+    struct BodyTable {
+      BodyLODRow* lod{};
+      const Transform::WorldTransformRow* transforms{};
+      Row<float>* linVelX{};
+      Row<float>* linVelY{};
+      Row<float>* linVelZ{};
+      Row<float>* angVel{};
+    };
+
+    Row<float>* tryGetVelocity(RuntimeDatabaseTaskBuilder& task, const TableID& table, const QueryAlias<Row<float>>& alias) {
+      QueryResult<Row<float>> q = task.queryAlias(table, alias);
+      return q.size() ? &q.get<0>(0) : nullptr;
+    }
+
+    void copyIfPresent(Row<float>* row, size_t i, float& stored, bool toRow) {
+      if(!row) {
+        return;
+      }
+      if(toRow) {
+        row->at(i) = stored;
+      }
+      else {
+        stored = row->at(i);
+      }
+    }
+
+    void copyVelocity(BodyTable& table, size_t i, BodyLOD& body, bool toRow) {
+      copyIfPresent(table.linVelX, i, body.linearX, toRow);
+      copyIfPresent(table.linVelY, i, body.linearY, toRow);
+      copyIfPresent(table.linVelZ, i, body.linearZ, toRow);
+      copyIfPresent(table.angVel, i, body.angular, toRow);
+    }
+
+    Level getDesiredLevel(const LODConfig& config, const glm::vec2& pos, const std::vector<glm::vec2>& regions) {
+      //Nothing to measure against, such as in tests or menus, means nothing is far away
+      if(!config.enabled || regions.empty()) {
+        return Level::Full;
+      }
+      float closest = std::numeric_limits<float>::max();
+      for(const glm::vec2& region : regions) {
+        const glm::vec2 diff = region - pos;
+        closest = std::min(closest, glm::dot(diff, diff));
+      }
+      if(closest >= config.frozenDistance*config.frozenDistance) {
+        return Level::Frozen;
+      }
+      return closest >= config.reducedDistance*config.reducedDistance ? Level::Reduced : Level::Full;
+    }
+
+    //Bodies in an island take the highest detail of any of its bodies so the island is stepped as one
+    void shareIslandLevels(const IslandGraph::Graph& graph, ITableResolver& resolver, const ElementRefResolver& ids) {
+      CachedRow<BodyLODRow> cache;
+      for(size_t i = 0; i < graph.islands.getValues().size(); ++i) {
+        if(graph.islands.isFree(i) || !graph.islands[i].size()) {
+          continue;
+        }
+        const IslandGraph::Island& island = graph.islands[i];
+        Level level = Level::Frozen;
+        for(uint32_t n = island.nodes; n != IslandGraph::INVALID; n = graph.nodes[n].islandNext) {
+          if(const BodyLOD* body = resolver.tryGetOrSwapRowElement(cache, ids.tryUnpack(graph.nodes[n].data))) {
+            level = std::min(level, body->desired);
+          }
+        }
+        for(uint32_t n = island.nodes; n != IslandGraph::INVALID; n = graph.nodes[n].islandNext) {
+          if(BodyLOD* body = resolver.tryGetOrSwapRowElement(cache, ids.tryUnpack(graph.nodes[n].data))) {
+            body->level = level;
+            body->phase = static_cast<uint32_t>(i);
+          }
+        }
+      }
+    }
+
+    void applyLevel(const LODConfig& config, Stats& stats, BodyTable& table, size_t i, Level previous) {
+      BodyLOD& body = table.lod->at(i);
+      //Frozen velocity is either captured on the way in or restored to undo whatever happened to it last frame
+      if(body.level == Level::Frozen && previous != Level::Frozen) {
+        copyVelocity(table, i, body, false);
+      }
+      else if(previous == Level::Frozen) {
+        copyVelocity(table, i, body, true);
+      }
+
+      switch(body.level) {
+        case Level::Full:
+          ++stats.full;
+          body.stepping = true;
+          break;
+        case Level::Reduced:
+          ++stats.reduced;
+          body.stepping = (stats.frame + body.phase) % std::max(config.reducedInterval, size_t(1)) == 0;
+          break;
+        case Level::Frozen:
+          ++stats.frozen;
+          //Time spent frozen is dropped rather than caught up on
+          body.stepping = false;
+          break;
+      }
+    }
+  }
+
+  void update(IAppBuilder& builder, const Config::PhysicsConfig& physicsConfig) {
+    auto task = builder.createTask();
+    task.setName("physics lod");
+    const LODConfig* config = &physicsConfig.lod;
+    auto regionQuery = task.query<const RegionOfInterestRow, const Transform::WorldTransformRow>();
+    auto statsQuery = task.query<StatsRow>();
+    const IslandGraph::Graph* graph = task.query<const SP::IslandGraphRow>().tryGetSingletonElement();
+    std::vector<BodyTable> tables;
+    for(const TableID& table : builder.queryTables<BodyLODRow, Transform::WorldTransformRow>().getMatchingTableIDs()) {
+      auto q = task.query<BodyLODRow, const Transform::WorldTransformRow>(table);
+      tables.push_back(BodyTable{
+        .lod = &q.get<0>(0),
+        .transforms = &q.get<1>(0),
+        .linVelX = tryGetVelocity(task, table, FloatQueryAlias::create<VelX>()),
+        .linVelY = tryGetVelocity(task, table, FloatQueryAlias::create<VelY>()),
+        .linVelZ = tryGetVelocity(task, table, FloatQueryAlias::create<VelZ>()),
+        .angVel = tryGetVelocity(task, table, FloatQueryAlias::create<VelA>()),
+      });
+    }
+    std::shared_ptr<ITableResolver> resolver = task.getResolver<BodyLODRow>();
+    auto ids = task.getIDResolver();
+
+    task.setCallback([config, regionQuery, statsQuery, graph, tables, resolver, ids](AppTaskArgs&) mutable {
+      PROFILE_SCOPE("physics", "lod");
+      Stats* stats = statsQuery.tryGetSingletonElement();
+      if(!stats) {
+        return;
+      }
+      //Once everything is back at full rate there is nothing left to do until it is enabled again
+      if(!config->enabled && !stats->reduced && !stats->frozen) {
+        stats->full = 0;
+        return;
+      }
+
+      std::vector<glm::vec2> regions;
+      for(size_t t = 0; t < regionQuery.size(); ++t) {
+        for(const Transform::PackedTransform& transform : regionQuery.get<1>(t)) {
+          regions.push_back(transform.pos2());
+        }
+      }
+
+      std::vector<Level> previous;
+      for(BodyTable& table : tables) {
+        for(size_t i = 0; i < table.lod->size(); ++i) {
+          BodyLOD& body = table.lod->at(i);
+          previous.push_back(body.level);
+          body.desired = body.level = getDesiredLevel(*config, table.transforms->at(i).pos2(), regions);
+          body.phase = static_cast<uint32_t>(i);
+        }
+      }
+
+      if(graph) {
+        shareIslandLevels(*graph, *resolver, ids->getRefResolver());
+      }
+
+      ++stats->frame;
+      stats->full = stats->reduced = stats->frozen = 0;
+      size_t p = 0;
+      for(BodyTable& table : tables) {
+        for(size_t i = 0; i < table.lod->size(); ++i) {
+          applyLevel(*config, *stats, table, i, previous[p++]);
+        }
+      }
+    });
+    builder.submitTask(std::move(task));
+  }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Table.h"
+
+class IAppBuilder;
+
+namespace Config {
+  struct PhysicsConfig;
+}
+
+//Level of detail for bodies far away from every region of interest like cameras and players
+//Reduced bodies are only stepped every few ticks with the motion of the skipped ticks integrated all at once when they are
+//Frozen bodies keep their velocity but don't move or get solved until something comes close enough to promote them
+//All bodies in an island share the highest detail of any of them so touching bodies always step together
+namespace PhysicsLOD {
+  enum class Level : uint8_t {
+    Full,
+    Reduced,
+    Frozen
+  };
+
+  struct BodyLOD {
+    bool isStepping() const {
+      return stepping;
+    }
+
+    //If the solver and integrator process the body this frame. When a reduced body steps the integrator moves it by the
+    //skipped sums below rather than by a multiple of its current velocity
+    bool stepping{ true };
+    //Offset of the reduced step schedule so that not all reduced islands step on the same tick
+    uint32_t phase{};
+    Level desired{};
+    Level level{};
+    //Velocity at the time of freezing, restored each frame so that accelerations don't pile up while frozen
+    float linearX{};
+    float linearY{};
+    float linearZ{};
+    float angular{};
+    //Sum of the velocity on each skipped tick, which is how far the next step moves the body. Written by the integrator
+    float skippedX{};
+    float skippedY{};
+    float skippedZ{};
+    float skippedA{};
+  };
+
+  struct Stats {
+    uint64_t frame{};
+    uint32_t full{};
+    uint32_t reduced{};
+    uint32_t frozen{};
+  };
+
+  //Elements of tables with this tag and a world transform are the positions bodies measure their distance from
+  struct RegionOfInterestRow : TagRow {};
+  //Added alongside velocity by PhysicsTableBuilder
+  struct BodyLODRow : Row<BodyLOD> {};
+  //Counts of bodies at each level during the last update
+  struct StatsRow : SharedRow<Stats> {};
+
+  //Assigns levels and which bodies step this frame. Runs before any velocity is integrated
+  void update(IAppBuilder& builder, const Config::PhysicsConfig& config);
+}
@@ -11,9 +11,9 @@
 #include <shapes/Mesh.h>
 #include <shapes/Circle.h>
 #include <shapes/Rectangle.h>
-#include <RelationModule.h>
 #include <math/AxisFlags.h>
 #include <Physics.h>
+#include <PhysicsLOD.h>
 
 namespace PhysicsTableBuilder {
   StorageTableBuilder& addCircle(StorageTableBuilder& table) {
@@ -37,6 +37,8 @@ namespace PhysicsTableBuilder {
     if(axes.hasA()) {
       table.addRows<VelA>();
     }
+    //Anything that moves can be slowed down when far away
+    table.addRows<PhysicsLOD::BodyLODRow>();
     return table;
   }
 
@@ -113,8 +115,7 @@ namespace PhysicsTableBuilder {
   StorageTableBuilder& addStaticTriangleMesh(StorageTableBuilder& table) {
     return addImmobile(table).addRows<
       Shapes::StaticTriangleMeshReferenceRow,
-      Narrowphase::ThicknessRow,
-      Relation::HasChildrenRow
+      Narrowphase::ThicknessRow
     >();
   }
 
@@ -0,0 +1,98 @@
+#include "Precompile.h"
+#include "RayPacket.h"
+
+#include "out_ispc/unity.h"
+#include "glm/geometric.hpp"
+
+namespace RayPacket {
+  namespace {
+    void resize(Hits& hits, size_t s) {
+      hits.tIn.resize(s);
+      hits.tOut.resize(s);
+      hits.normalX.resize(s);
+      hits.normalY.resize(s);
+    }
+  }
+
+  void Rays::clear() {
+    startX.clear();
+    startY.clear();
+    dirX.clear();
+    dirY.clear();
+  }
+
+  void Rays::push_back(const glm::vec2& start, const glm::vec2& dir) {
+    startX.push_back(start.x);
+    startY.push_back(start.y);
+    dirX.push_back(dir.x);
+    dirY.push_back(dir.y);
+  }
+
+  size_t Rays::size() const {
+    return startX.size();
+  }
+
+  glm::vec2 Rays::getStart(size_t i) const {
+    return { startX[i], startY[i] };
+  }
+
+  glm::vec2 Rays::getDir(size_t i) const {
+    return { dirX[i], dirY[i] };
+  }
+
+  bool Hits::isHit(size_t i) const {
+    return tIn[i] >= 0.0f;
+  }
+
+  glm::vec2 Hits::getNormal(size_t i) const {
+    return { normalX[i], normalY[i] };
+  }
+
+  void intersectBox(const Rays& rays, const glm::vec2& center, const glm::vec2& basisX, const glm::vec2& basisY, float maxT, Hits& hits) {
+    const size_t s = rays.size();
+    resize(hits, s);
+    //Inverse of the 2x2 matrix with the basis vectors as columns
+    const float det = basisX.x*basisY.y - basisY.x*basisX.y;
+    if(std::abs(det) < 0.00001f) {
+      std::fill(hits.tIn.begin(), hits.tIn.end(), -1.0f);
+      return;
+    }
+    const float invDet = 1.0f/det;
+    ispc::rayPacketBox(rays.startX.data(),
+      rays.startY.data(),
+      rays.dirX.data(),
+      rays.dirY.data(),
+      center.x,
+      center.y,
+      basisY.y*invDet,
+      -basisY.x*invDet,
+      -basisX.y*invDet,
+      basisX.x*invDet,
+      maxT,
+      hits.tIn.data(),
+      hits.tOut.data(),
+      hits.normalX.data(),
+      hits.normalY.data(),
+      static_cast<uint32_t>(s)
+    );
+  }
+
+  void intersectCircle(const Rays& rays, const glm::vec2& center, float radius, float maxT, Hits& hits) {
+    const size_t s = rays.size();
+    resize(hits, s);
+    ispc::rayPacketCircle(rays.startX.data(),
+      rays.startY.data(),
+      rays.dirX.data(),
+      rays.dirY.data(),
+      center.x,
+      center.y,
+      radius,
+      maxT,
+      hits.tIn.data(),
+      hits.tOut.data(),
+      hits.normalX.data(),
+      hits.normalY.data(),
+      static_cast<uint32_t>(s)
+    );
+  }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "glm/vec2.hpp"
+
+//Intersection of many rays against one shape at a time, meant for casting a group of rays against the candidates
+//the group found in the broadphase. Rays are start + dir*t so t is in units of dir, like the segment [0, 1] for a raycast
+namespace RayPacket {
+  struct Rays {
+    void clear();
+    void push_back(const glm::vec2& start, const glm::vec2& dir);
+    size_t size() const;
+    glm::vec2 getStart(size_t i) const;
+    glm::vec2 getDir(size_t i) const;
+
+    std::vector<float> startX, startY, dirX, dirY;
+  };
+
+  struct Hits {
+    bool isHit(size_t i) const;
+    glm::vec2 getNormal(size_t i) const;
+
+    //Where the ray entered the shape, negative for misses. Zero if the ray started inside
+    std::vector<float> tIn;
+    //Where the ray exits the shape, may be beyond maxT. Only meaningful for hits
+    std::vector<float> tOut;
+    //Surface normal at the entry, not normalized. The reverse of the direction for rays that start inside
+    std::vector<float> normalX, normalY;
+  };
+
+  //Box with the given center whose edges are along basisX and basisY with lengths of the vectors
+  //Hits past maxT are misses
+  void intersectBox(const Rays& rays, const glm::vec2& center, const glm::vec2& basisX, const glm::vec2& basisY, float maxT, Hits& hits);
+  void intersectCircle(const Rays& rays, const glm::vec2& center, float radius, float maxT, Hits& hits);
+}
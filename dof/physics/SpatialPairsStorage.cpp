@@ -28,6 +28,7 @@ namespace SP {
     ObjA& rowA,
     ObjB& rowB,
     PairTypeRow& rowType,
+    ManifoldCacheRow& rowCache,
     const ElementRef& a,
     const ElementRef& b,
     PairType type
@@ -43,6 +44,8 @@ namespace SP {
     rowA.at(entryIndex) = a;
     rowB.at(entryIndex) = b;
     rowType.at(entryIndex) = type;
+    //Slots are reused from removed edges, don't let the new pair reuse a manifold cached by the previous one
+    rowCache.at(entryIndex).isValid = false;
     return entryIndex;
   }
 
@@ -88,6 +91,7 @@ namespace SP {
     ObjA& rowA,
     ObjB& rowB,
     PairTypeRow& rowType,
+    ManifoldCacheRow& rowCache,
     const AdapterT& adapter
   ) {
     //Add new edges and spatial pairs for all new pairs
@@ -95,7 +99,7 @@ namespace SP {
     //It is expected that there is only a single edge for contact types
     for(const GainT& gain : gained) {
       auto [a, b] = adapter.unwrapGain(gain);
-      addIslandEdge(pairStorageModifier, graph, rowA, rowB, rowType, a, b, type);
+      addIslandEdge(pairStorageModifier, graph, rowA, rowB, rowType, rowCache, a, b, type);
     }
 
     //Remove all edges corresponding to the lost pairs
@@ -117,22 +121,22 @@ namespace SP {
     auto task = builder.createTask();
     task.setName("update spatial pairs");
     const auto dstTable = builder.queryTables<ObjA, ObjB, PairTypeRow, ManifoldRow>()[0];
-    auto dstQuery = task.query<ObjA, ObjB, PairTypeRow, IslandGraphRow>(dstTable);
+    auto dstQuery = task.query<ObjA, ObjB, PairTypeRow, ManifoldCacheRow, IslandGraphRow>(dstTable);
     auto dstModifier = task.getModifierForTable(dstTable);
     auto ids = task.getIDResolver();
     auto broadphaseChanges = task.query<SharedRow<SweepNPruneBroadphase::PairChanges>>();
     auto constraintChanges = task.query<Constraints::ConstraintChangesRow>();
 
     task.setCallback([dstQuery, dstModifier, ids, broadphaseChanges, constraintChanges](AppTaskArgs&) mutable {
-      auto [objA, objB, pairType, islandGraph] = dstQuery.get(0);
+      auto [objA, objB, pairType, cache, islandGraph] = dstQuery.get(0);
       IslandGraph::Graph& graph = islandGraph->at();
       for(size_t t = 0; t < broadphaseChanges.size(); ++t) {
         SweepNPruneBroadphase::PairChanges& changes = broadphaseChanges.get<0>(t).at();
-        trackEdges(changes.mGained, changes.mLost, graph, *dstModifier, PairType::ContactXY, *objA, *objB, *pairType, ContactAdapter{ *pairType });
+        trackEdges(changes.mGained, changes.mLost, graph, *dstModifier, PairType::ContactXY, *objA, *objB, *pairType, *cache, ContactAdapter{ *pairType });
       }
       for(size_t t = 0; t < constraintChanges.size(); ++t) {
         Constraints::ConstraintChanges& changes = constraintChanges.get<0>(t).at();
-        trackEdges(changes.gained, changes.lost, graph, *dstModifier, PairType::Constraint, *objA, *objB, *pairType, ConstraintAdapter{});
+        trackEdges(changes.gained, changes.lost, graph, *dstModifier, PairType::Constraint, *objA, *objB, *pairType, *cache, ConstraintAdapter{});
         changes.gained.clear();
         changes.lost.clear();
       }
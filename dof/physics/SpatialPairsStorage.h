@@ -5,6 +5,9 @@
 #include "Table.h"
 #include "glm/vec2.hpp"
 #include "IslandGraph.h"
+#include "PhysicsLOD.h"
+#include <transform/Transform.h>
+#include <atomic>
 
 class IAppBuilder;
 class RuntimeDatabaseTaskBuilder;
@@ -49,6 +52,19 @@ namespace SP {
     std::array<ContactPoint, 2> points;
     uint32_t size{};
   };
+  //The last generated manifold of a pair along with the relative transform it was generated at
+  //Normal and centerToContactA are in A's model space and centerToContactB is in B's, so as long as the pair
+  //moves together the same contact features can be re-projected into world space without regenerating
+  struct ManifoldCache {
+    Transform::PackedTransform relativeTransform;
+    ContactManifold manifold;
+    bool isValid{};
+  };
+  //Counts of how each contact pair's manifold was produced during the last narrowphase
+  struct ManifoldCacheStats {
+    std::atomic_uint32_t reused;
+    std::atomic_uint32_t generated;
+  };
   struct ZContactManifold {
     bool isTouching() const;
     void clear();
@@ -91,6 +107,12 @@ namespace SP {
   struct ZConstraintRow : Row<ZConstraintManifold> {};
   struct IslandGraphRow : SharedRow<IslandGraph::Graph> {};
   struct PairTypeRow : Row<PairType> {};
+  //Nonzero if both objects are in a sleeping island, meaning narrowphase can skip the pair and keep the previous manifold
+  //Set and cleared by ConstraintSolver.cpp
+  struct IsSleepingRow : Row<uint8_t> {};
+  //Written and read by Narrowphase.cpp, invalidated by addIslandEdge when the slot is given to a new pair
+  struct ManifoldCacheRow : Row<ManifoldCache> {};
+  struct ManifoldCacheStatsRow : SharedRow<ManifoldCacheStats> {};
 
   //For more direct lookups, all spatial pairs are stored in a single tale
   //The type of connection is determined by PairTypeRow which determines the mutually exclusive constraint types
@@ -104,7 +126,11 @@ namespace SP {
     ManifoldRow,
     ZManifoldRow,
     ConstraintRow,
-    ZConstraintRow
+    ZConstraintRow,
+    IsSleepingRow,
+    ManifoldCacheRow,
+    ManifoldCacheStatsRow,
+    PhysicsLOD::StatsRow
   >;
 
   size_t addIslandEdge(ITableModifier& modifier,
@@ -112,6 +138,7 @@ namespace SP {
     ObjA& rowA,
     ObjB& rowB,
     PairTypeRow& rowType,
+    ManifoldCacheRow& rowCache,
     const ElementRef& a,
     const ElementRef& b,
     PairType type
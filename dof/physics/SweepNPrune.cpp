@@ -8,6 +8,7 @@
 #include "Profile.h"
 #include "AppBuilder.h"
 #include "SweepNPruneBroadphase.h"
+#include "SweepSoA.h"
 
 //#define BROADPHASE_DEBUG
 #ifdef BROADPHASE_DEBUG
@@ -107,7 +108,7 @@ namespace Broadphase {
       //Left start passed over right end, starting to overlap with right edge
       //Only care about this if it would be a new pair (not tracked) and they are newly overlapping on both axes
       const SweepKeyPair pair{ BroadphaseKey{ left.element.getValue() }, BroadphaseKey{ right.getValue() } };
-      if(!args.tracked->trackedPairs.count(pair)) {
+      if(!args.tracked->trackedPairs.contains(pair)) {
         if(isOverlapping(left, right, args)) {
           args.log->gains.emplace_back(pair);
         }
@@ -124,7 +125,7 @@ namespace Broadphase {
       //Left end swapped over right begin, overlap may have ended
       //Only care about this if they were colliding (tracked pair) and are no longer overlapping on at least one axis
       const SweepKeyPair pair{ BroadphaseKey{ left.element.getValue() }, BroadphaseKey{ right.getValue() } };
-      if(args.tracked->trackedPairs.count(pair)) {
+      if(args.tracked->trackedPairs.contains(pair)) {
         const auto r = unwrapElement(right, args.primaryAxis);
         //Only check the primary axis here, if it's not overlapping on the other axis it'll get logged when sorting that axis
         if(!isOverlapping(left, r)) {
@@ -204,12 +205,14 @@ namespace Broadphase {
         db.bounds[s].resize(db.bounds[s].size() + slotsNeeded);
       }
       db.userKey.resize(db.userKey.size() + slotsNeeded);
+      db.filters.resize(db.filters.size() + slotsNeeded);
     }
     for(size_t i = 0; i < count; ++i) {
       const BroadphaseKey k = getOrCreateKey(db.freeList, newKey);
 
       outKeys[i] = { k };
       db.userKey[k.value] = userKeys[i];
+      db.filters[k.value] = {};
 
       for(size_t d = 0; d < db.bounds.size(); ++d) {
         db.bounds[d][k.value] = { ObjectDB::NEW, ObjectDB::NEW };
@@ -259,9 +262,64 @@ namespace Broadphase {
     }
   }
 
+  void updateCollisionFilters(ObjectDB& db,
+    const CollisionFilter* filters,
+    const BroadphaseKey* keys,
+    size_t count
+  ) {
+    for(size_t i = 0; i < count; ++i) {
+      //Bounds check mainly for default constructed EMPTY_KEY used for elements that haven't been inserted into broadphase yet
+      if(const size_t k = keys[i].value; k < db.filters.size() && db.filters[k] != filters[i]) {
+        db.filterChanges.emplace_back(keys[i], db.filters[k]);
+        db.filters[k] = filters[i];
+      }
+    }
+  }
+
+  struct FilterChangeCompare {
+    bool operator()(const std::pair<BroadphaseKey, CollisionFilter>& l, const std::pair<BroadphaseKey, CollisionFilter>& r) const {
+      return l.first < r.first;
+    }
+
+    bool operator()(const std::pair<BroadphaseKey, CollisionFilter>& l, const BroadphaseKey& r) const {
+      return l.first < r;
+    }
+  };
+
+  void logFilterChanges(ObjectDB& db, const PairTracker& pairs, SwapLog& output) {
+    if(db.filterChanges.empty()) {
+      return;
+    }
+    //If a key changed multiple times the first entry holds the filter that events were last reported with
+    std::stable_sort(db.filterChanges.begin(), db.filterChanges.end(), FilterChangeCompare{});
+    db.filterChanges.erase(std::unique(db.filterChanges.begin(), db.filterChanges.end(), [](const auto& l, const auto& r) { return l.first == r.first; }), db.filterChanges.end());
+
+    auto getPreviousFilter = [&db](const BroadphaseKey& key) -> const CollisionFilter* {
+      auto it = std::lower_bound(db.filterChanges.begin(), db.filterChanges.end(), key, FilterChangeCompare{});
+      return it != db.filterChanges.end() && it->first == key ? &it->second : nullptr;
+    };
+    //Pairs don't know their neighbors so look through all of them. Filter changes are infrequent
+    for(const auto& [pair, unused] : pairs.trackedPairs) {
+      const CollisionFilter* previousA = getPreviousFilter(pair.a);
+      const CollisionFilter* previousB = getPreviousFilter(pair.b);
+      if(!previousA && !previousB) {
+        continue;
+      }
+      const CollisionFilter& currentA = db.filters[pair.a.value];
+      const CollisionFilter& currentB = db.filters[pair.b.value];
+      const bool wasReported = (previousA ? *previousA : currentA).canCollide(previousB ? *previousB : currentB);
+      const bool isReported = currentA.canCollide(currentB);
+      if(wasReported != isReported) {
+        auto& events = isReported ? output.gains : output.losses;
+        events.emplace_back(db.userKey[pair.a.value], db.userKey[pair.b.value]);
+      }
+    }
+    db.filterChanges.clear();
+  }
+
   void logChangedPairs(const ObjectDB& db, PairTracker& pairs, const ConstIntermediateLog& changedPairs, SwapLog& output) {
     for(const SweepKeyPair& g : changedPairs.gains) {
-      if(pairs.trackedPairs.insert(g).second) {
+      if(pairs.trackedPairs.insert({ g, {} }).second && db.filters[g.a.value].canCollide(db.filters[g.b.value])) {
         //Up until now the pairs have been holding BroadphaseKeys. For the event, look up the corresponding UserKey
         output.gains.emplace_back(db.userKey[g.a.value], db.userKey[g.b.value]);
       }
@@ -269,42 +327,71 @@ namespace Broadphase {
     for(const SweepKeyPair& l : changedPairs.losses) {
       if(auto it = pairs.trackedPairs.find(l); it != pairs.trackedPairs.end()) {
         pairs.trackedPairs.erase(it);
-        output.losses.emplace_back(db.userKey[l.a.value], db.userKey[l.b.value]);
+        //Filtered pairs never had a gain reported so there is no loss to report either
+        if(db.filters[l.a.value].canCollide(db.filters[l.b.value])) {
+          output.losses.emplace_back(db.userKey[l.a.value], db.userKey[l.b.value]);
+        }
       }
     }
   }
 
   //Log events for pairs that will be removed as a result of pending removals, but don't remove yet
   void logPendingRemovals(const ObjectDB& db, IntermediateLog& log, const PairTracker& pairs) {
-    //All removal events should have been logged, now insert removals into free list and trim them off the end of the axes
-    //Removals would always be at the end because REMOVED is float max and it was just sorted above
-    if(size_t toRemove = db.pendingRemoval.size()) {
-      //Log an event for all removal pairs. This is because all removal bounds are equal so their events might be missed if both were removed
-      //resolveCandidates will remove redundancies
-      for(size_t i = 0; i < db.pendingRemoval.size(); ++i) {
-        for(size_t j = i + 1; j < db.pendingRemoval.size(); ++j) {
+    const size_t toRemove = db.pendingRemoval.size();
+    if(!toRemove) {
+      return;
+    }
+    //Log an event for all removal pairs. This is because all removal bounds are equal so their events might be missed if both were removed
+    //resolveCandidates will remove redundancies
+    //Looking up every combination of removals is quadratic, which is fine for a few but not for mass removals
+    //Once there are more combinations than tracked pairs, check the tracked pairs against the sorted removals instead
+    if(toRemove*(toRemove - 1)/2 <= pairs.trackedPairs.size()) {
+      for(size_t i = 0; i < toRemove; ++i) {
+        for(size_t j = i + 1; j < toRemove; ++j) {
           const SweepKeyPair pair{ db.pendingRemoval[i], db.pendingRemoval[j] };
-          if(pairs.trackedPairs.count(pair)) {
+          if(pairs.trackedPairs.contains(pair)) {
             log.losses.emplace_back(pair);
           }
         }
       }
     }
+    else {
+      std::vector<BroadphaseKey> removed{ db.pendingRemoval };
+      std::sort(removed.begin(), removed.end());
+      for(const auto& entry : pairs.trackedPairs) {
+        const SweepKeyPair& pair = entry.first;
+        if(std::binary_search(removed.begin(), removed.end(), pair.a) && std::binary_search(removed.begin(), removed.end(), pair.b)) {
+          log.losses.emplace_back(pair);
+        }
+      }
+    }
   }
 
   //Remove elements pending deletion. This is after the events for them have already been logged and no cells are referencing them anymore
   void processPendingRemovals(ObjectDB& db) {
-    //All removal events should have been logged, now insert removals into free list and trim them off the end of the axes
-    //Removals would always be at the end because REMOVED is float max and it was just sorted above
-    if(size_t toRemove = db.pendingRemoval.size()) {
-      //Log an event for all removal pairs. This is because all removal bounds are equal so their events might be missed if both were removed
-      //resolveCandidates will remove redundancies
-      for(size_t i = 0; i < db.pendingRemoval.size(); ++i) {
-        db.userKey[db.pendingRemoval[i].value] = {};
-      }
-      db.freeList.insert(db.freeList.end(), db.pendingRemoval.begin(), db.pendingRemoval.end());
-      db.pendingRemoval.clear();
+    if(db.pendingRemoval.empty()) {
+      return;
+    }
+    //Erasing the same key twice would put it in the free list twice and then give it to two different objects
+    std::sort(db.pendingRemoval.begin(), db.pendingRemoval.end());
+    db.pendingRemoval.erase(std::unique(db.pendingRemoval.begin(), db.pendingRemoval.end()), db.pendingRemoval.end());
+    for(const BroadphaseKey& key : db.pendingRemoval) {
+      db.userKey[key.value] = {};
+    }
+    db.freeList.insert(db.freeList.end(), db.pendingRemoval.begin(), db.pendingRemoval.end());
+    db.pendingRemoval.clear();
+  }
+
+  bool isQueryOverlap(const ObjectDB& db, BroadphaseKey key, const glm::vec2& min, const glm::vec2& max, const QueryMask& mask) {
+    if(key.value >= db.filters.size() || !mask.matches(db.filters[key.value].mask)) {
+      return false;
     }
+    const ObjectDB::BoundsMinMax& x = db.bounds[0][key.value];
+    const ObjectDB::BoundsMinMax& y = db.bounds[1][key.value];
+    //Removed bounds are at the max float so they fail the overlap check by themselves
+    return x.first != ObjectDB::NEW &&
+      x.first <= max.x && min.x <= x.second &&
+      y.first <= max.y && min.y <= y.second;
   }
 
   namespace SweepNPrune {
@@ -340,7 +427,7 @@ namespace Broadphase {
       size_t count
     ) {
       for(size_t i = 0; i < count; ++i) {
-        if(sweep.containedKeys.insert(keys[i]).second) {
+        if(sweep.containedKeys.insert({ keys[i], {} }).second) {
           insertRange(sweep, keys + i, 1);
         }
       }
@@ -505,6 +592,7 @@ namespace Broadphase {
       constexpr float posInfinity = std::numeric_limits<float>::max();
       constexpr float negInfinity = std::numeric_limits<float>::lowest();
       grid.cells.resize(grid.definition.cellsX*grid.definition.cellsY);
+      grid.soaCells.resize(grid.useSoA ? grid.cells.size() : 0);
       for(size_t x = 0; x < grid.definition.cellsX; ++x) {
         for(size_t y = 0; y < grid.definition.cellsY; ++y) {
           glm::vec2 min = grid.definition.bottomLeft;
@@ -518,11 +606,16 @@ namespace Broadphase {
           max.x = x + 1 == grid.definition.cellsX ? posInfinity : max.x;
           max.y = y + 1 == grid.definition.cellsY ? posInfinity : max.y;
 
-          Sweep2D& cell = grid.cells[x + y*grid.definition.cellsX];
+          const size_t index = x + y*grid.definition.cellsX;
+          Sweep2D& cell = grid.cells[index];
           for(size_t i = 0; i < cell.axis.size(); ++i) {
             cell.axis[i].min = min[i];
             cell.axis[i].max = max[i];
           }
+          if(grid.useSoA) {
+            grid.soaCells[index].min = min;
+            grid.soaCells[index].max = max;
+          }
         }
       }
     }
@@ -534,6 +627,7 @@ namespace Broadphase {
       //Assign the keys a slot but don't map them to any internal cells yet since bounds aren't known
       //This will happen during updateBoundaries
       Broadphase::insertRange(grid.objects, userKeys, outKeys, count);
+      grid.lastCenter.resize(grid.objects.userKey.size());
     }
 
     void eraseRange(Grid& grid,
@@ -548,6 +642,25 @@ namespace Broadphase {
       glm::vec2 max{};
     };
 
+    bool contains(const Bounds& outer, const Bounds& inner) {
+      return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y &&
+        outer.max.x >= inner.max.x && outer.max.y >= inner.max.y;
+    }
+
+    Bounds expand(const Bounds& bounds, float amount) {
+      return { bounds.min - glm::vec2{ amount }, bounds.max + glm::vec2{ amount } };
+    }
+
+    Bounds getFatBounds(const Grid& grid, const Bounds& tight, const glm::vec2& displacement) {
+      const glm::vec2 maxPrediction{ grid.maxPrediction };
+      const glm::vec2 prediction = glm::clamp(displacement*grid.predictionFrames, -maxPrediction, maxPrediction);
+      Bounds result = expand(tight, grid.margin);
+      //Only extend on the side the object is moving towards
+      result.min += glm::min(prediction, glm::vec2{ 0.0f });
+      result.max += glm::max(prediction, glm::vec2{ 0.0f });
+      return result;
+    }
+
     //Call fn with index for all cells that the bounds overlap with.
     template<class FN>
     void foreachCell(const GridDefinition& definition, const Bounds& bounds, FN&& fn) {
@@ -573,23 +686,48 @@ namespace Broadphase {
       const BroadphaseKey* keys,
       size_t count) {
       for(size_t i = 0; i < count; ++i) {
-        if(keys[i] == EMPTY_KEY) {
+        //Bounds check mainly for default constructed EMPTY_KEY used for elements that haven't been inserted into broadphase yet
+        const size_t k = keys[i].value;
+        if(k >= grid.lastCenter.size()) {
           continue;
         }
+        const Bounds tight{ glm::vec2{ minX[i], minY[i] }, glm::vec2{ maxX[i], maxY[i] } };
+        const glm::vec2 center = (tight.min + tight.max)*0.5f;
+        const auto& x = grid.objects.bounds[0][k];
+        const auto& y = grid.objects.bounds[1][k];
+        const bool isNew = x.first == ObjectDB::NEW;
+        const glm::vec2 displacement = isNew ? glm::vec2{ 0.0f } : center - grid.lastCenter[k];
+        grid.lastCenter[k] = center;
+        const Bounds fat = getFatBounds(grid, tight, displacement);
+
+        //Nothing to do if the object is still within its previous bounds and those haven't become excessively large
+        //compared to what they would be now. The size check is what allows shrinking or slowing objects to lose pairs
+        if(!isNew) {
+          const Bounds current{ glm::vec2{ x.first, y.first }, glm::vec2{ x.second, y.second } };
+          if(contains(current, tight) && contains(expand(fat, grid.margin*2.0f), current)) {
+            continue;
+          }
+        }
+
         //Update the bounds information all cells are referring to for this single key
         Broadphase::updateBoundaries(grid.objects,
-          minX + i,
-          maxX + i,
-          minY + i,
-          maxY + i,
+          &fat.min.x,
+          &fat.max.x,
+          &fat.min.y,
+          &fat.max.y,
           keys + i,
           1);
 
-        const Bounds newBounds{ glm::vec2{ minX[i], minY[i] }, glm::vec2{ maxX[i], maxY[i] } };
-        //TODO: skip reinsertion check if new bounds aren't outside of cells from last time
         //Try to insert into each cell this overlaps with, skipping if they're already there
-        foreachCell(grid.definition, newBounds, [&](size_t cellIndex) {
-          if(cellIndex < grid.cells.size()) {
+        //This only happens when the bounds changed, which is rare for slow moving objects if there is a margin
+        foreachCell(grid.definition, fat, [&](size_t cellIndex) {
+          if(cellIndex >= grid.cells.size()) {
+            return;
+          }
+          if(grid.useSoA) {
+            SweepSoA::tryInsertRange(grid.soaCells[cellIndex], keys + i, 1);
+          }
+          else {
             SweepNPrune::tryInsertRange(grid.cells[cellIndex], keys + i, 1);
           }
         });
@@ -597,6 +735,32 @@ namespace Broadphase {
       }
     }
 
+    void queryAABB(const Grid& grid, const glm::vec2& min, const glm::vec2& max, const QueryMask& mask, std::vector<BroadphaseKey>& results) {
+      const size_t begin = results.size();
+      foreachCell(grid.definition, Bounds{ min, max }, [&](size_t cellIndex) {
+        if(cellIndex >= grid.cells.size()) {
+          return;
+        }
+        if(grid.useSoA) {
+          for(const BroadphaseKey& key : grid.soaCells[cellIndex].keys) {
+            if(isQueryOverlap(grid.objects, key, min, max, mask)) {
+              results.push_back(key);
+            }
+          }
+          return;
+        }
+        //Every object in the cell has a start element on each axis, the ends would be duplicates
+        for(const SweepElement& e : grid.cells[cellIndex].axis[0].elements) {
+          if(e.isStart() && isQueryOverlap(grid.objects, BroadphaseKey{ e.getValue() }, min, max, mask)) {
+            results.push_back(BroadphaseKey{ e.getValue() });
+          }
+        }
+      });
+      //Objects spanning multiple cells are found once per cell
+      std::sort(results.begin() + begin, results.end());
+      results.erase(std::unique(results.begin() + begin, results.end()), results.end());
+    }
+
     void recomputePairs(IAppBuilder& builder) {
       struct TaskData {
         std::vector<Broadphase::SweepCollisionPair> gains, losses;
@@ -636,7 +800,12 @@ namespace Broadphase {
             };
             log.gains.clear();
             log.losses.clear();
-            SweepNPrune::recomputePairs(grid.cells[i], grid.objects, grid.pairs, log);
+            if(grid.useSoA) {
+              SweepSoA::recomputePairs(grid.soaCells[i], grid.objects, log);
+            }
+            else {
+              SweepNPrune::recomputePairs(grid.cells[i], grid.objects, grid.pairs, log);
+            }
           }
         });
         builder.submitTask(std::move(process));
@@ -661,6 +830,7 @@ namespace Broadphase {
           //Tracked pairs can be updated now and used to discard the redundant events based on if the event would change
           //what is tracked
           SwapLog results{ finalResults.mGained, finalResults.mLost };
+          Broadphase::logFilterChanges(grid->objects, grid->pairs, results);
           for(size_t i = 0; i < data->tasks.size(); ++i) {
             const TaskData& t = data->tasks[i];
             const ConstIntermediateLog taskLog{ t.keyGains, t.keyLosses };
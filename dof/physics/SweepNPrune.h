@@ -3,6 +3,10 @@
 #include "glm/vec2.hpp"
 #include "Scheduler.h"
 #include "StableElementID.h"
+#include "generics/Hash.h"
+#include "generics/HashMap.h"
+
+#include <variant>
 
 class IAppBuilder;
 
@@ -68,19 +72,35 @@ struct std::hash<Broadphase::SweepCollisionPair> {
 template<>
 struct std::hash<Broadphase::BroadphaseKey> {
   std::size_t operator()(const Broadphase::BroadphaseKey& s) const noexcept {
-    return std::hash<size_t>()(s.value);
+    return static_cast<size_t>(gnx::Hash::mix(s.value));
   }
 };
 template<>
 struct std::hash<Broadphase::SweepKeyPair> {
   std::size_t operator()(const Broadphase::SweepKeyPair& s) const noexcept {
-    //cppreference hash combine example
-    std::hash<Broadphase::BroadphaseKey> h;
-    return h(s.a) ^ (h(s.b) << 1);
+    //Keys are dense indices so packing them before mixing avoids the collisions that combining their hashes has
+    return static_cast<size_t>(gnx::Hash::mix((static_cast<uint64_t>(s.a.value) << 32) ^ static_cast<uint64_t>(s.b.value)));
   }
 };
 
 namespace Broadphase {
+  //Open addressing set, the values are unused
+  template<class K>
+  using KeySet = gnx::HashMap<K, std::monostate>;
+
+  //Mirror of the narrowphase collision mask and mobility of an object so pairs that can't collide are never reported
+  struct CollisionFilter {
+    bool operator==(const CollisionFilter&) const = default;
+
+    bool canCollide(const CollisionFilter& other) const {
+      //Masks must share a bit and at least one of them must be able to move
+      return (mask & other.mask) && !(isImmobile && other.isImmobile);
+    }
+
+    uint8_t mask{ std::numeric_limits<uint8_t>::max() };
+    bool isImmobile{};
+  };
+
   //This holds the user keys and boundaries of the shapes tracked by the broadphase
   //The spatial data structure references this to decide how to partition the objects
   struct ObjectDB {
@@ -98,9 +118,12 @@ namespace Broadphase {
     std::vector<BroadphaseKey> freeList;
     //Keys recently marked for removal but won't be moved to the free list until the next recomputePairs
     std::vector<BroadphaseKey> pendingRemoval;
+    std::vector<CollisionFilter> filters;
+    //Keys whose filter changed since the last logFilterChanges along with the filter they had before
+    std::vector<std::pair<BroadphaseKey, CollisionFilter>> filterChanges;
   };
   struct PairTracker {
-    std::unordered_set<SweepKeyPair> trackedPairs;
+    KeySet<SweepKeyPair> trackedPairs;
   };
 
   struct SwapLog {
@@ -140,12 +163,46 @@ namespace Broadphase {
     const BroadphaseKey* keys,
     size_t count
   );
+  //Writes the new filters. Overlapping pairs are tracked regardless of filter but events are only reported for pairs that can collide
+  //Pairs whose result changes have events logged by the next logFilterChanges
+  void updateCollisionFilters(ObjectDB& db,
+    const CollisionFilter* filters,
+    const BroadphaseKey* keys,
+    size_t count
+  );
+  //Log gains and losses for tracked pairs that changed if they can collide. Must happen before logChangedPairs
+  void logFilterChanges(ObjectDB& db, const PairTracker& pairs, SwapLog& output);
   //Log events for pairs that will be removed as a result of pending removals, but don't remove yet
   void logPendingRemovals(const ObjectDB& db, IntermediateLog& log, const PairTracker& pairs);
   //Take the results of recomputePairs, resolve duplicates, and transform the keys from BroadphaseKey to UserKey
+  //All changes are tracked but only those that pass the collision filter are output
   void logChangedPairs(const ObjectDB& db, PairTracker& pairs, const ConstIntermediateLog& changedPairs, SwapLog& output);
   //Remove elements pending deletion. This is after the events for them have already been logged and no cells are referencing them anymore
   void processPendingRemovals(ObjectDB& db);
+  //Collision mask filter for queries. Converts from a mask to find objects whose mask shares a bit with it
+  struct QueryMask {
+    QueryMask(uint8_t bits)
+      : mask{ bits }
+    {}
+
+    //Every object regardless of its mask, including those with a mask of zero that collide with nothing
+    static QueryMask all() {
+      QueryMask result{ 0 };
+      result.ignoreMask = true;
+      return result;
+    }
+
+    bool matches(uint8_t objectMask) const {
+      return ignoreMask || (objectMask & mask);
+    }
+
+    uint8_t mask{};
+    bool ignoreMask{};
+  };
+
+  //True if the stored bounds of the object overlap the given bounds and its mask matches the query mask
+  //Objects that were just inserted or are pending removal never overlap
+  bool isQueryOverlap(const ObjectDB& db, BroadphaseKey key, const glm::vec2& min, const glm::vec2& max, const QueryMask& mask);
 
   struct SweepElement {
     static constexpr size_t END_BIT = size_t(1) << (sizeof(size_t)*8 - 1);
@@ -195,10 +252,30 @@ namespace Broadphase {
   struct Sweep2D {
     static constexpr size_t S = 2;
     std::array<SweepAxis, S> axis;
-    std::unordered_set<BroadphaseKey> containedKeys;
+    KeySet<BroadphaseKey> containedKeys;
     std::vector<BroadphaseKey> temp;
   };
 
+  namespace SweepSoA {
+    //Alternative to Sweep2D that keeps copies of the bounds inline with the keys as parallel arrays sorted by min X
+    //Sweep2D sorts elements that point at the bounds in the ObjectDB, making each comparison an indirect lookup,
+    //and logs changes on swaps, making each swap a pair lookup. Here the sort and the overlap scan only touch contiguous
+    //floats, and the overlaps are diffed against the previous update's to find gains and losses
+    struct Sweep {
+      //Parallel arrays sorted by minX
+      std::vector<BroadphaseKey> keys;
+      std::vector<float> minX, maxX, minY, maxY;
+      //Sorted overlapping pairs as of the last and the current recomputePairs
+      std::vector<SweepKeyPair> overlaps, previousOverlaps;
+      //Output of the overlap scan kernel for one element
+      std::vector<uint32_t> candidates;
+      KeySet<BroadphaseKey> containedKeys;
+      //Elements entirely outside of this range are dropped during recomputePairs, same as SweepAxis
+      glm::vec2 min{ std::numeric_limits<float>::lowest() };
+      glm::vec2 max{ std::numeric_limits<float>::max() };
+    };
+  }
+
   namespace Debug {
     bool isValidSweepAxis(const SweepAxis& axis);
   }
@@ -236,6 +313,18 @@ namespace Broadphase {
       PairTracker pairs;
       GridDefinition definition;
       std::vector<Sweep2D> cells;
+      //Set before init to track the objects of each cell in soaCells instead of cells. The boundaries are in both
+      bool useSoA{};
+      std::vector<SweepSoA::Sweep> soaCells;
+      //Bounds in the ObjectDB are extended by this in all directions and only rewritten once the object escapes them,
+      //avoiding churn in the sweep axes for slow moving objects
+      float margin{};
+      //Bounds are also extended in the direction of movement by this many updates worth of the last displacement
+      float predictionFrames{};
+      //Limit on the predicted extension on each axis so teleports don't create enormous bounds
+      float maxPrediction{ 1.0f };
+      //Center of each object's bounds at the last update, used to estimate its displacement
+      std::vector<glm::vec2> lastCenter;
     };
 
     void init(Grid& grid);
@@ -257,6 +346,10 @@ namespace Broadphase {
       const BroadphaseKey* keys,
       size_t count);
 
+    //Appends the keys of every object overlapping the bounds according to isQueryOverlap without duplicates
+    //Only reads the grid so any number of threads can query as long as nothing is modifying it
+    void queryAABB(const Grid& grid, const glm::vec2& min, const glm::vec2& max, const QueryMask& mask, std::vector<BroadphaseKey>& results);
+
     void recomputePairs(IAppBuilder& builder);
   }
 }
\ No newline at end of file
@@ -7,10 +7,61 @@
 #include "SpatialPairsStorage.h"
 #include "shapes/ShapeRegistry.h"
 #include "Events.h"
+#include "Narrowphase.h"
 #include "TLSTaskImpl.h"
 #include <module/MassModule.h>
+#include "glm/common.hpp"
 
 namespace SweepNPruneBroadphase {
+  //Forwards to whichever of the broadphase implementations is enabled
+  struct BroadphaseRef {
+    void insertRange(const Broadphase::UserKey* userKeys, Broadphase::BroadphaseKey* outKeys, size_t count) {
+      if(tree->enabled) {
+        Broadphase::AABBTree::insertRange(*tree, userKeys, outKeys, count);
+      }
+      else {
+        Broadphase::SweepGrid::insertRange(*grid, userKeys, outKeys, count);
+      }
+    }
+
+    void eraseRange(const Broadphase::BroadphaseKey* keys, size_t count) {
+      if(tree->enabled) {
+        Broadphase::AABBTree::eraseRange(*tree, keys, count);
+      }
+      else {
+        Broadphase::SweepGrid::eraseRange(*grid, keys, count);
+      }
+    }
+
+    void updateBoundaries(const float* minX,
+      const float* maxX,
+      const float* minY,
+      const float* maxY,
+      const Broadphase::BroadphaseKey* keys,
+      size_t count) {
+      if(tree->enabled) {
+        Broadphase::AABBTree::updateBoundaries(*tree, minX, maxX, minY, maxY, keys, count);
+      }
+      else {
+        Broadphase::SweepGrid::updateBoundaries(*grid, minX, maxX, minY, maxY, keys, count);
+      }
+    }
+
+    void updateCollisionFilters(const Broadphase::CollisionFilter* filters, const Broadphase::BroadphaseKey* keys, size_t count) {
+      Broadphase::updateCollisionFilters(tree->enabled ? tree->objects : grid->objects, filters, keys, count);
+    }
+
+    Broadphase::SweepGrid::Grid* grid{};
+    Broadphase::AABBTree::Tree* tree{};
+  };
+
+  BroadphaseRef queryBroadphase(RuntimeDatabaseTaskBuilder& task) {
+    return {
+      task.query<SharedRow<Broadphase::SweepGrid::Grid>>().tryGetSingletonElement(),
+      task.query<SharedRow<Broadphase::AABBTree::Tree>>().tryGetSingletonElement()
+    };
+  }
+
   void registryUpdate(IAppBuilder& builder) {
     auto task = builder.createTask();
     task.setName("assignBoundaries");
@@ -35,30 +86,126 @@ namespace SweepNPruneBroadphase {
       data.keys = &kq.get<0>(0);
       data.bounds.table = table;
       data.bounds.requiredDependency = QueryAliasBase{ gridAlias };
+      //Immobile objects only need new bounds when something moves them, which flags the transform as updated
+      //Everything else is assumed to move most frames, and gameplay is allowed to write their transforms directly
+      data.bounds.onlyUpdated = builder.queryTable<MassModule::IsImmobile>(table);
 
       impl->writeBoundaries(builder, data.bounds);
     }
 
     //After all bounds have been stored in task data, collect them and put them in the broadphase
-    auto& grid = *task.query<GridQ>().tryGetSingletonElement();
-    task.setCallback([&grid, taskDatas](AppTaskArgs&) mutable {
-      for(size_t i = 0; i < taskDatas->size(); ++i) {
-        Broadphase::SweepGrid::updateBoundaries(grid,
-          taskDatas->at(i).bounds.minX.data(),
-          taskDatas->at(i).bounds.maxX.data(),
-          taskDatas->at(i).bounds.minY.data(),
-          taskDatas->at(i).bounds.maxY.data(),
-          taskDatas->at(i).keys->data(),
-          taskDatas->at(i).bounds.minX.size()
+    BroadphaseRef broadphase = queryBroadphase(task);
+    task.setCallback([broadphase, taskDatas](AppTaskArgs&) mutable {
+      std::vector<Broadphase::BroadphaseKey> keys;
+      for(TaskData& data : *taskDatas) {
+        const ShapeRegistry::BroadphaseBounds& bounds = data.bounds;
+        keys.resize(bounds.elements.size());
+        for(size_t i = 0; i < keys.size(); ++i) {
+          keys[i] = data.keys->at(bounds.elements[i]);
+        }
+        broadphase.updateBoundaries(
+          bounds.minX.data(),
+          bounds.maxX.data(),
+          bounds.minY.data(),
+          bounds.maxY.data(),
+          keys.data(),
+          keys.size()
         );
       }
     });
     builder.submitTask(std::move(task));
   }
 
+  //Fills reader.keys with the candidates and returns the objects they refer to
+  const Broadphase::ObjectDB& gatherKeys(BroadphaseReader& reader, const glm::vec2& min, const glm::vec2& max, const Broadphase::QueryMask& mask) {
+    reader.keys.clear();
+    if(reader.tree->enabled) {
+      Broadphase::AABBTree::queryAABB(*reader.tree, min, max, mask, reader.stack, reader.keys);
+      return reader.tree->objects;
+    }
+    Broadphase::SweepGrid::queryAABB(*reader.grid, min, max, mask, reader.keys);
+    return reader.grid->objects;
+  }
+
+  //Slab test of the segment against the bounds
+  bool isSegmentOverlap(const glm::vec2& start, const glm::vec2& dir, const glm::vec2& min, const glm::vec2& max) {
+    float tMin = 0.0f;
+    float tMax = 1.0f;
+    for(int a = 0; a < 2; ++a) {
+      if(std::abs(dir[a]) < 0.00001f) {
+        if(start[a] < min[a] || start[a] > max[a]) {
+          return false;
+        }
+        continue;
+      }
+      const float inv = 1.0f/dir[a];
+      const float t0 = (min[a] - start[a])*inv;
+      const float t1 = (max[a] - start[a])*inv;
+      tMin = std::max(tMin, std::min(t0, t1));
+      tMax = std::min(tMax, std::max(t0, t1));
+    }
+    return tMin <= tMax;
+  }
+
+  void BroadphaseReader::queryAABB(const glm::vec2& min, const glm::vec2& max, const Broadphase::QueryMask& mask, std::vector<Broadphase::UserKey>& results) {
+    const Broadphase::ObjectDB& objects = gatherKeys(*this, min, max, mask);
+    for(const Broadphase::BroadphaseKey& key : keys) {
+      results.push_back(objects.userKey[key.value]);
+    }
+  }
+
+  void BroadphaseReader::queryRaycast(const glm::vec2& start, const glm::vec2& end, const Broadphase::QueryMask& mask, std::vector<Broadphase::UserKey>& results) {
+    //The bounds of the whole segment find the candidates, then the segment itself rules out the rest
+    const Broadphase::ObjectDB& objects = gatherKeys(*this, glm::min(start, end), glm::max(start, end), mask);
+    for(const Broadphase::BroadphaseKey& key : keys) {
+      const glm::vec2 min{ objects.bounds[0][key.value].first, objects.bounds[1][key.value].first };
+      const glm::vec2 max{ objects.bounds[0][key.value].second, objects.bounds[1][key.value].second };
+      if(isSegmentOverlap(start, end - start, min, max)) {
+        results.push_back(objects.userKey[key.value]);
+      }
+    }
+  }
+
+  BroadphaseReader createBroadphaseReader(RuntimeDatabaseTaskBuilder& task) {
+    return BroadphaseReader{
+      .grid = task.query<const SharedRow<Broadphase::SweepGrid::Grid>>().tryGetSingletonElement(),
+      .tree = task.query<const SharedRow<Broadphase::AABBTree::Tree>>().tryGetSingletonElement()
+    };
+  }
+
+  //Mirror the collision masks and mobility into the broadphase so pairs that can't collide are never reported
+  //This is a separate pass rather than on creation because gameplay changes masks by writing to the row directly
+  void updateCollisionFilters(IAppBuilder& builder) {
+    auto task = builder.createTask();
+    task.setName("update broadphase filters");
+    auto query = task.query<const BroadphaseKeys>();
+    auto resolver = task.getResolver<const Narrowphase::CollisionMaskRow, const MassModule::IsImmobile>();
+    BroadphaseRef broadphase = queryBroadphase(task);
+    task.setCallback([query, resolver, broadphase](AppTaskArgs&) mutable {
+      std::vector<Broadphase::CollisionFilter> filters;
+      for(size_t t = 0; t < query.size(); ++t) {
+        auto [keys] = query.get(t);
+        //Narrowphase treats a missing mask row as a mask of zero
+        const Narrowphase::CollisionMaskRow* masks = resolver->tryGetRow<const Narrowphase::CollisionMaskRow>(query[t]);
+        const bool isImmobile = resolver->tryGetRow<const MassModule::IsImmobile>(query[t]) != nullptr;
+        filters.resize(keys->size());
+        for(size_t i = 0; i < filters.size(); ++i) {
+          filters[i] = Broadphase::CollisionFilter{
+            .mask = masks ? masks->at(i) : Narrowphase::CollisionMask{},
+            .isImmobile = isImmobile
+          };
+        }
+        broadphase.updateCollisionFilters(filters.data(), keys->data(), keys->size());
+      }
+    });
+    builder.submitTask(std::move(task));
+  }
+
   void updateBroadphase(IAppBuilder& builder) {
     registryUpdate(builder);
+    updateCollisionFilters(builder);
     Broadphase::SweepGrid::recomputePairs(builder);
+    Broadphase::AABBTree::recomputePairs(builder);
     SP::updateSpatialPairsFromBroadphase(builder);
   }
 
@@ -67,7 +214,7 @@ namespace SweepNPruneBroadphase {
       query = task;
       ids = task.getRefResolver();
       spatialPairs = SP::createStorageModifier(task);
-      grid = task.query<SharedRow<Broadphase::SweepGrid::Grid>>().tryGetSingletonElement();
+      broadphase = queryBroadphase(task);
     }
 
     void execute() {
@@ -83,13 +230,13 @@ namespace SweepNPruneBroadphase {
             }
             Broadphase::BroadphaseKey& key = keys->at(i);
             const Broadphase::UserKey userKey = stables->at(i);
-            Broadphase::SweepGrid::insertRange(*grid, &userKey, &key, 1);
+            broadphase.insertRange(&userKey, &key, 1);
             spatialPairs->addSpatialNode(userKey, false);
           }
           else if(event.second.isDestroy()) {
             //Remove elements that are about to be destroyed
             Broadphase::BroadphaseKey& key = keys->at(i);
-            Broadphase::SweepGrid::eraseRange(*grid, &key, 1);
+            broadphase.eraseRange(&key, 1);
             spatialPairs->removeSpatialNode(stables->at(i));
             key = {};
           }
@@ -103,7 +250,7 @@ namespace SweepNPruneBroadphase {
     > query;
     ElementRefResolver ids;
     std::shared_ptr<SP::IStorageModifier> spatialPairs;
-    Broadphase::SweepGrid::Grid* grid{};
+    BroadphaseRef broadphase;
   };
 
   void preProcessEvents(IAppBuilder& builder) {
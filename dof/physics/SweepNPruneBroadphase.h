@@ -5,6 +5,7 @@
 #include "Table.h"
 #include "StableElementID.h"
 #include "SweepNPrune.h"
+#include "AABBTree.h"
 #include "Scheduler.h"
 #include "AppBuilder.h"
 
@@ -24,13 +25,34 @@ namespace SweepNPruneBroadphase {
     //Removed collision pairs caused by reinserts or erases
     std::vector<Broadphase::SweepCollisionPair> mLost;
   };
+  //Only one of the grid and tree is used at a time, selected by PhysicsConfig upon init
   using BroadphaseTable = Table<
     SharedRow<Broadphase::SweepGrid::Grid>,
+    SharedRow<Broadphase::AABBTree::Tree>,
     SharedRow<PairChanges>
   >;
 
   void updateBroadphase(IAppBuilder& builder);
 
+  //Read only access to whichever broadphase is enabled as of its last update, for queries outside of the physics update
+  //Bounds may be fattened by the broadphase margins so a narrowphase test is needed to know if shapes actually overlap
+  struct BroadphaseReader {
+    //Appends the user keys of all objects whose bounds overlap and whose collision mask matches the mask
+    //Use Broadphase::QueryMask::all to include objects that don't collide with anything
+    void queryAABB(const glm::vec2& min, const glm::vec2& max, const Broadphase::QueryMask& mask, std::vector<Broadphase::UserKey>& results);
+    //Same as queryAABB but only objects whose bounds the segment passes through
+    void queryRaycast(const glm::vec2& start, const glm::vec2& end, const Broadphase::QueryMask& mask, std::vector<Broadphase::UserKey>& results);
+
+    const Broadphase::SweepGrid::Grid* grid{};
+    const Broadphase::AABBTree::Tree* tree{};
+    //Scratch reused across queries
+    std::vector<Broadphase::BroadphaseKey> keys;
+    std::vector<uint32_t> stack;
+  };
+
+  //Takes a const dependency on the broadphase, so the reader sees it as of the last physics update that preceded the task
+  BroadphaseReader createBroadphaseReader(RuntimeDatabaseTaskBuilder& task);
+
   //Before table service
   //New elements are added to the broadphase if they have a broadphase key row
   //Removed elements are removed from the broadphase
@@ -0,0 +1,149 @@
+#include "Precompile.h"
+#include "SweepSoA.h"
+
+#include "out_ispc/unity.h"
+#include "Profile.h"
+
+namespace Broadphase {
+  namespace SweepSoA {
+    void insertRange(Sweep& sweep,
+      const BroadphaseKey* keys,
+      size_t count) {
+      //Bounds are filled in from the ObjectDB during the next recomputePairs
+      sweep.keys.insert(sweep.keys.end(), keys, keys + count);
+      const size_t size = sweep.keys.size();
+      sweep.minX.resize(size);
+      sweep.maxX.resize(size);
+      sweep.minY.resize(size);
+      sweep.maxY.resize(size);
+    }
+
+    void tryInsertRange(Sweep& sweep,
+      const BroadphaseKey* keys,
+      size_t count) {
+      for(size_t i = 0; i < count; ++i) {
+        if(sweep.containedKeys.insert({ keys[i], {} }).second) {
+          insertRange(sweep, keys + i, 1);
+        }
+      }
+    }
+
+    bool isOutside(const Sweep& sweep, const ObjectDB::BoundsMinMax& x, const ObjectDB::BoundsMinMax& y) {
+      return x.second < sweep.min.x || x.first > sweep.max.x || y.second < sweep.min.y || y.first > sweep.max.y;
+    }
+
+    //Copy the latest bounds next to the keys, dropping removed elements and those outside of the sweep's range
+    void gatherBounds(Sweep& sweep, const ObjectDB& db) {
+      size_t count = 0;
+      for(size_t i = 0; i < sweep.keys.size(); ++i) {
+        const BroadphaseKey key = sweep.keys[i];
+        const ObjectDB::BoundsMinMax& x = db.bounds[0][key.value];
+        const ObjectDB::BoundsMinMax& y = db.bounds[1][key.value];
+        if(x.first == ObjectDB::REMOVED || (x.first != ObjectDB::NEW && isOutside(sweep, x, y))) {
+          if(auto it = sweep.containedKeys.find(key); it != sweep.containedKeys.end()) {
+            sweep.containedKeys.erase(it);
+          }
+          continue;
+        }
+        sweep.keys[count] = key;
+        if(x.first == ObjectDB::NEW) {
+          //Bounds haven't been written yet. Use an empty range at the end of the axis so it doesn't pair with anything
+          sweep.minX[count] = sweep.minY[count] = std::numeric_limits<float>::max();
+          sweep.maxX[count] = sweep.maxY[count] = std::numeric_limits<float>::lowest();
+        }
+        else {
+          sweep.minX[count] = x.first;
+          sweep.maxX[count] = x.second;
+          sweep.minY[count] = y.first;
+          sweep.maxY[count] = y.second;
+        }
+        ++count;
+      }
+      sweep.keys.resize(count);
+      sweep.minX.resize(count);
+      sweep.maxX.resize(count);
+      sweep.minY.resize(count);
+      sweep.maxY.resize(count);
+    }
+
+    //Order is mostly unchanged between updates so insertion sort is close to linear
+    void sortByMinX(Sweep& sweep) {
+      for(size_t i = 1; i < sweep.keys.size(); ++i) {
+        const float value = sweep.minX[i];
+        if(!(value < sweep.minX[i - 1])) {
+          continue;
+        }
+        const BroadphaseKey key = sweep.keys[i];
+        const float maxX = sweep.maxX[i];
+        const float minY = sweep.minY[i];
+        const float maxY = sweep.maxY[i];
+        size_t j = i;
+        do {
+          sweep.keys[j] = sweep.keys[j - 1];
+          sweep.minX[j] = sweep.minX[j - 1];
+          sweep.maxX[j] = sweep.maxX[j - 1];
+          sweep.minY[j] = sweep.minY[j - 1];
+          sweep.maxY[j] = sweep.maxY[j - 1];
+          --j;
+        }
+        while(j > 0 && value < sweep.minX[j - 1]);
+        sweep.keys[j] = key;
+        sweep.minX[j] = value;
+        sweep.maxX[j] = maxX;
+        sweep.minY[j] = minY;
+        sweep.maxY[j] = maxY;
+      }
+    }
+
+    void findOverlaps(Sweep& sweep) {
+      const size_t count = sweep.keys.size();
+      sweep.overlaps.clear();
+      for(size_t i = 0; i < count; ++i) {
+        //Everything after this that starts before it ends overlaps on X
+        const float maxX = sweep.maxX[i];
+        size_t end = i + 1;
+        while(end < count && sweep.minX[end] <= maxX) {
+          ++end;
+        }
+        const size_t first = i + 1;
+        if(const size_t candidateCount = end - first) {
+          if(sweep.candidates.size() < candidateCount) {
+            sweep.candidates.resize(candidateCount);
+          }
+          const uint32_t found = ispc::overlapScanY(sweep.minY.data() + first, sweep.maxY.data() + first, sweep.minY[i], sweep.maxY[i], static_cast<uint32_t>(candidateCount), sweep.candidates.data());
+          for(uint32_t c = 0; c < found; ++c) {
+            sweep.overlaps.emplace_back(sweep.keys[i], sweep.keys[first + sweep.candidates[c]]);
+          }
+        }
+      }
+      std::sort(sweep.overlaps.begin(), sweep.overlaps.end());
+    }
+
+    bool isOverlapping(const ObjectDB& db, const SweepKeyPair& pair) {
+      for(size_t d = 0; d < ObjectDB::S; ++d) {
+        const ObjectDB::BoundsMinMax& a = db.bounds[d][pair.a.value];
+        const ObjectDB::BoundsMinMax& b = db.bounds[d][pair.b.value];
+        if(a.first > b.second || b.first > a.second) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    void recomputePairs(Sweep& sweep, const ObjectDB& db, IntermediateLog& log) {
+      PROFILE_SCOPE("physics", "sweepSoA");
+      gatherBounds(sweep, db);
+      sortByMinX(sweep);
+      std::swap(sweep.overlaps, sweep.previousOverlaps);
+      findOverlaps(sweep);
+      std::set_difference(sweep.overlaps.begin(), sweep.overlaps.end(), sweep.previousOverlaps.begin(), sweep.previousOverlaps.end(), std::back_inserter(log.gains));
+      const size_t lossBegin = log.losses.size();
+      std::set_difference(sweep.previousOverlaps.begin(), sweep.previousOverlaps.end(), sweep.overlaps.begin(), sweep.overlaps.end(), std::back_inserter(log.losses));
+      //Pairs with a removed element are lost since removed bounds don't overlap anything. Pairs where both were removed are
+      //left to logPendingRemovals. Pairs that still overlap were only dropped because an element left this sweep's range
+      log.losses.erase(std::remove_if(log.losses.begin() + lossBegin, log.losses.end(), [&db](const SweepKeyPair& pair) {
+        return isOverlapping(db, pair);
+      }), log.losses.end());
+    }
+  }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "SweepNPrune.h"
+
+namespace Broadphase {
+  namespace SweepSoA {
+    //Object will be sorted into place during the next recomputePairs
+    void insertRange(Sweep& sweep,
+      const BroadphaseKey* keys,
+      size_t count);
+    //Inserts if it wasn't already there
+    void tryInsertRange(Sweep& sweep,
+      const BroadphaseKey* keys,
+      size_t count);
+    //Erase isn't needed directly, elements with REMOVED bounds or outside of the sweep's range are dropped during recomputePairs
+
+    //Copies the latest bounds, sorts them, and logs the overlaps that changed since the last call
+    //Overlaps lost only because an element left the sweep's range aren't logged since another sweep still contains both
+    void recomputePairs(Sweep& sweep, const ObjectDB& db, IntermediateLog& log);
+  }
+}
@@ -75,6 +75,8 @@ namespace MassModule {
     }
 
     Mass::OriginMass operator()(const ShapeRegistry::Raycast&) const { return unsupported(); }
+    //Triangle meshes are static terrain
+    Mass::OriginMass operator()(const ShapeRegistry::TriangleMesh&) const { return unsupported(); }
     Mass::OriginMass operator()(std::monostate) const { return unsupported(); }
     Mass::OriginMass unsupported() const { return {}; }
 
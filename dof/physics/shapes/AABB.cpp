@@ -1,5 +1,6 @@
 #include "Precompile.h"
 #include "shapes/AABB.h"
+#include "shapes/ShapeBounds.h"
 #include "AppBuilder.h"
 
 
@@ -49,22 +50,11 @@ namespace Shapes {
       task.setName("write aabb indiv bounds");
       task.logDependency({ bounds.requiredDependency });
 
-      auto query = task.query<const Transform::WorldTransformRow, const AABBRow>(bounds.table);
+      auto query = task.query<const Transform::WorldTransformRow, const AABBRow, const Transform::TransformHasUpdatedRow>(bounds.table);
       task.setCallback([query, &bounds](AppTaskArgs&) mutable {
-        auto [transforms, bbs] = query.get(0);
-        const size_t s = transforms->size();
-        bounds.minX.resize(s);
-        bounds.minY.resize(s);
-        bounds.maxX.resize(s);
-        bounds.maxY.resize(s);
-        for(size_t i = 0; i < transforms->size(); ++i) {
-          const Transform::PackedTransform& t = transforms->at(i);
-          const ShapeRegistry::AABB bb = aabbFromTransform(t);
-          bounds.minX[i] = bb.min.x;
-          bounds.maxX[i] = bb.max.x;
-          bounds.minY[i] = bb.min.y;
-          bounds.maxY[i] = bb.max.y;
-        }
+        auto [transforms, _, updated] = query.get(0);
+        gatherBoundsElements(bounds, *updated, transforms->size());
+        writeAABBBounds(bounds, *transforms);
       });
 
       builder.submitTask(std::move(task));
@@ -1,5 +1,6 @@
 #include "Precompile.h"
 #include "shapes/Circle.h"
+#include "shapes/ShapeBounds.h"
 #include "AppBuilder.h"
 
 namespace Shapes {
@@ -40,21 +41,11 @@ namespace Shapes {
       task.setName("write circle indiv bounds");
       task.logDependency({ bounds.requiredDependency });
 
-      auto query = task.query<const Transform::WorldTransformRow, const CircleRow>(bounds.table);
+      auto query = task.query<const Transform::WorldTransformRow, const CircleRow, const Transform::TransformHasUpdatedRow>(bounds.table);
       task.setCallback([query, &bounds](AppTaskArgs&) mutable {
-        auto [transforms, circles] = query.get(0);
-        const size_t s = circles->size();
-        bounds.minX.resize(s);
-        bounds.minY.resize(s);
-        bounds.maxX.resize(s);
-        bounds.maxY.resize(s);
-        for(size_t i = 0; i < circles->size(); ++i) {
-          const ShapeRegistry::Circle circle = circleFromTransform(transforms->at(i));
-          bounds.minX[i] = circle.pos.x - circle.radius;
-          bounds.maxX[i] = circle.pos.x + circle.radius;
-          bounds.minY[i] = circle.pos.y - circle.radius;
-          bounds.maxY[i] = circle.pos.y + circle.radius;
-        }
+        auto [transforms, _, updated] = query.get(0);
+        gatherBoundsElements(bounds, *updated, transforms->size());
+        writeCircleBounds(bounds, *transforms);
       });
 
       builder.submitTask(std::move(task));
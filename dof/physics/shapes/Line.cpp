@@ -1,5 +1,6 @@
 #include "Precompile.h"
 #include "shapes/Line.h"
+#include "shapes/ShapeBounds.h"
 #include "AppBuilder.h"
 
 namespace Shapes {
@@ -53,16 +54,12 @@ namespace Shapes {
       task.setName("write line indiv bounds");
       task.logDependency({ bounds.requiredDependency });
 
-      auto query = task.query<const Transform::WorldTransformRow, const LineRow>(bounds.table);
+      auto query = task.query<const Transform::WorldTransformRow, const LineRow, const Transform::TransformHasUpdatedRow>(bounds.table);
       task.setCallback([query, &bounds](AppTaskArgs&) mutable {
-        auto [transforms, lines] = query.get(0);
-        const size_t s = transforms->size();
-        bounds.minX.resize(s);
-        bounds.minY.resize(s);
-        bounds.maxX.resize(s);
-        bounds.maxY.resize(s);
-        for(size_t i = 0; i < transforms->size(); ++i) {
-          const ShapeRegistry::Raycast line = lineFromTransform(transforms->at(i));
+        auto [transforms, lines, updated] = query.get(0);
+        gatherBoundsElements(bounds, *updated, transforms->size());
+        for(size_t i = 0; i < bounds.elements.size(); ++i) {
+          const ShapeRegistry::Raycast line = lineFromTransform(transforms->at(bounds.elements[i]));
           bounds.minX[i] = std::min(line.start.x, line.end.x);
           bounds.maxX[i] = std::max(line.start.x, line.end.x);
           bounds.minY[i] = std::min(line.start.y, line.end.y);
@@ -6,52 +6,19 @@
 #include <Events.h>
 #include <TLSTaskImpl.h>
 #include <shapes/ShapeRegistry.h>
+#include <shapes/ShapeBounds.h>
 #include <IAppModule.h>
 #include <generics/Functional.h>
 #include <loader/ReflectionModule.h>
 #include <loader/SceneAsset.h>
-#include <RelationModule.h>
-#include <PhysicsTableBuilder.h>
-#include <TableName.h>
 #include <transform/TransformModule.h>
-#include <ConstraintSolver.h>
-#include <Narrowphase.h>
+#include <MeshNarrowphase.h>
 
 namespace Shapes {
-  //This is equivalent to Relation::HasChildrenRow but allows children of mesh asset entries to exist unrelated to composite meshes.
-  struct CompositeMesh {
-    std::vector<ElementRef> parts;
-  };
-  struct CompositeMeshRow : Row<CompositeMesh> {};
-  struct CompositeMeshTagRow : TagRow {};
-
-  struct TriangleMesh {
-    TriangleMesh() = default;
-    TriangleMesh(const Transform::PackedTransform& t, const glm::vec2& a, const glm::vec2& b, const glm::vec2& c)
-      : points{ t.transformPoint(a), t.transformPoint(b), t.transformPoint(c) }
-      , aabb{ Geo::AABB::build({ points[0], points[1], points[2] }) }
-    {
-    }
-
-    ShapeRegistry::Mesh toMesh() const {
-      //Points are in world space, so transforms are identity
-      return ShapeRegistry::Mesh{
-        .points = points,
-        .aabb = aabb,
-      };
-    }
-
-    std::vector<glm::vec2> points;
-    Geo::AABB aabb;
-  };
-  struct TriangleMeshRow : Row<TriangleMesh> {};
-
   struct MeshStorage : ChainedRuntimeStorage {
     using ChainedRuntimeStorage::ChainedRuntimeStorage;
     struct Rows {
       MeshAssetRow mesh;
-      //Reference to elements in the compositeAssets table for composite meshes
-      CompositeMeshRow composite;
     };
 
     std::vector<Rows> rows;
@@ -60,11 +27,6 @@ namespace Shapes {
   struct ImportMeshTask {
     void init(RuntimeDatabaseTaskBuilder& task) {
       query = task;
-      compositeMeshTable = task.queryTables<CompositeMeshTagRow>().getTableID(0);
-    }
-
-    void init(AppTaskArgs& args) {
-      relations = args;
     }
 
     static Geo::AABB computeAABB(const MeshAsset& mesh) {
@@ -82,6 +44,7 @@ namespace Shapes {
       ConvexHull::compute(mesh.points, ctx);
       mesh.convexHull.resize(ctx.result.size());
       std::transform(ctx.result.begin(), ctx.result.end(), mesh.convexHull.begin(), ConvexHull::GetPoints{ mesh.points });
+      Narrowphase::computeEdgeNormals(mesh.convexHull, mesh.convexHullNormals);
       mesh.aabb = computeAABB(mesh);
     }
 
@@ -94,192 +57,35 @@ namespace Shapes {
       });
       ConvexHull::Context ctx;
       fillModelFromPoints(result, ctx);
+      //Always create triangle data for now. Could be done on-demand for StaticTriangleMeshReference in the future if needed.
+      result.triangles = buildTriangleBVH(result.points);
       //Mass properties will be computed based on convex hull by MassModule
       return result;
     }
 
-    static void createCompositeMesh(
-      TableID childTable,
-      const ElementRef& parentMesh,
-      const MeshAsset& mesh,
-      CompositeMesh& parentComposite,
-      Relation::ChildrenEntry& meshChildren,
-      Relation::RelationWriter& writer) {
-      std::vector<size_t> triIndices;
-      triIndices.reserve(mesh.points.size() / 3);
-
-      //Find all "valid" triangles as ones that have some amount of area.
-      //Points are assumed to be in triplets
-      for(size_t i = 0; i + 2 < mesh.points.size(); i += 3) {
-        const glm::vec2& a = mesh.points[i];
-        const glm::vec2& b = mesh.points[i + 1];
-        const glm::vec2& c = mesh.points[i + 2];
-        const float area = std::abs(Geo::cross(b - a, c - a));
-        if(area > 0.01f) {
-          triIndices.push_back(i);
-        }
-      }
-
-      if(triIndices.empty()) {
-        return;
-      }
-
-      //Add child elements
-      Relation::RelationWriter::NewChildren result = writer.addChildren(parentMesh, meshChildren, childTable, triIndices.size());
-      //Fill in child meshes
-      MeshAssetRow* childMeshes = result.table->tryGet<MeshAssetRow>();
-      parentComposite.parts.resize(triIndices.size());
-      ConvexHull::Context ctx;
-
-      for(size_t i = 0; i < triIndices.size(); ++i) {
-        MeshAsset& childMesh = childMeshes->at(i + result.startIndex);
-        const size_t ti = triIndices[i];
-        childMesh.points.insert(childMesh.points.end(), {
-          mesh.points[ti],
-          mesh.points[ti + 1],
-          mesh.points[ti + 2]
-        });
-        fillModelFromPoints(childMesh, ctx);
-
-        //Store references to the chldren on the parent
-        parentComposite.parts[i] = result.childRefs[i];
-      }
-    }
-
     void execute() {
       for(size_t t = 0; t < query.size(); ++t) {
-        auto [stables, events, baseMeshes, children, compositeMeshes, physicsMeshes] = query.get(t);
+        auto [events, baseMeshes, physicsMeshes] = query.get(t);
         for(auto it : events) {
           if(it.second.isCreate()) {
             const size_t i = it.first;
             physicsMeshes->at(i) = createMesh(baseMeshes->at(i));
-            //Always create composite mesh data for now. Could be done on-demand in the future if needed.
-            createCompositeMesh(
-              compositeMeshTable,
-              stables->at(i),
-              physicsMeshes->at(i),
-              compositeMeshes->at(i),
-              children->at(i),
-              relations
-            );
           }
         }
       }
     }
 
     QueryResult<
-      const StableIDRow,
       const Events::EventsRow,
       const Loader::MeshAssetRow,
-      Relation::HasChildrenRow,
-      CompositeMeshRow,
       MeshAssetRow
     > query;
-    Relation::RelationWriter relations;
-    TableID compositeMeshTable;
-  };
-
-  struct InitCompositeMeshTask {
-    void init(RuntimeDatabaseTaskBuilder& task) {
-      triangleMeshTable = task.queryTables<TriangleMeshRow>().getTableID(0);
-      query = task;
-      ids = task.getRefResolver();
-      resolver = task.getResolver(meshAssets, compositeMeshAssets);
-      transformResolver = { task };
-    }
-
-    void init(AppTaskArgs& args) {
-      relation = args;
-    }
-
-    struct ChildRows {
-      ChildRows() = default;
-      ChildRows(RuntimeTable& table)
-        : triangleMeshes{ table.tryGet<TriangleMeshRow>() }
-        , constraintMasks{ table.tryGet<ConstraintSolver::ConstraintMaskRow>() }
-        , collisionMasks{ table.tryGet<Narrowphase::CollisionMaskRow>() }
-        , thicknesses{ table.tryGet<Narrowphase::ThicknessRow>() }
-      {}
-
-      explicit operator bool() const {
-        return triangleMeshes && constraintMasks && collisionMasks;
-      }
-
-      TriangleMeshRow* triangleMeshes{};
-      ConstraintSolver::ConstraintMaskRow* constraintMasks{};
-      Narrowphase::CollisionMaskRow* collisionMasks{};
-      Narrowphase::ThicknessRow* thicknesses{};
-    };
-
-    void execute() {
-      for(size_t t = 0; t < query.size(); ++t) {
-        auto&& [events, stables, meshRefs, constraintMasks, collisionMasks, thicknesses, children] = query.get(t);
-        for(auto event : events) {
-          if(!event.second.isCreate()) {
-            continue;
-          }
-          const size_t si = event.first;
-          const UnpackedDatabaseElementID assetID = ids.unpack(meshRefs->at(si).meshAsset.asset);
-          const CompositeMesh* composite = resolver->tryGetOrSwapRowElement(compositeMeshAssets, assetID);
-          if(!composite || composite->parts.empty()) {
-            continue;
-          }
-
-          //TODO: should relation have a feature that automatically tries to copy from any matching parent rows?
-          Relation::RelationWriter::NewChildren newChildren = relation.addChildren(stables->at(si), children->at(si), triangleMeshTable, composite->parts.size());
-          ChildRows newRows = newChildren.table ? ChildRows{ *newChildren.table } : ChildRows{};
-          if(!newChildren.count || !newRows) {
-            continue;
-          }
-
-          const ElementRef& parentID = stables->at(si);
-          const Transform::PackedTransform parentTransform = transformResolver.resolve(ids.unpack(parentID));
-          const Narrowphase::CollisionMask parentCollisionMask = collisionMasks->at(si);
-          const ConstraintSolver::ConstraintMask parentConstraintMask = constraintMasks->at(si);
-          const float parentThickness = thicknesses->at(si);
-
-          for(size_t c = 0; c < newChildren.count; ++c) {
-            const MeshAsset* childMesh = resolver->tryGetOrSwapRowElement(meshAssets, ids.unpack(composite->parts[c]));
-            //Skip meshes that fail to resolve. This shouldn't happen. If it does, the new child will be useless but also shouldn't cause problems.
-            //If they resolved, they should have 3 points as constructed by ImportMeshTask.
-            if(!childMesh || childMesh->points.size() != 3) {
-              continue;
-            }
-            const size_t ci = c + newChildren.startIndex;
-            //Copy points for this child mesh to world space TriangleMesh using parent transform
-            newRows.triangleMeshes->at(ci) = TriangleMesh{ parentTransform, childMesh->convexHull[0], childMesh->convexHull[1], childMesh->convexHull[2] };
-            //Copy over parent masks
-            newRows.collisionMasks->at(ci) = parentCollisionMask;
-            newRows.constraintMasks->at(ci) = parentConstraintMask;
-            newRows.thicknesses->at(ci) = parentThickness;
-          }
-        }
-      }
-    }
-
-    QueryResult<
-      const Events::EventsRow,
-      const StableIDRow,
-      const StaticTriangleMeshReferenceRow,
-      const ConstraintSolver::ConstraintMaskRow,
-      const Narrowphase::CollisionMaskRow,
-      const Narrowphase::ThicknessRow,
-      Relation::HasChildrenRow
-    > query;
-    Relation::RelationWriter relation;
-    TableID triangleMeshTable;
-    CachedRow<const CompositeMeshRow> compositeMeshAssets;
-    CachedRow<const MeshAssetRow> meshAssets;
-    Transform::Resolver transformResolver;
-    std::shared_ptr<ITableResolver> resolver;
-    ElementRefResolver ids;
   };
 
   class MeshModule : public IAppModule {
   public:
     void postProcessEvents(IAppBuilder& builder) override {
       builder.submitTask(TLSTask::create<ImportMeshTask>("import mesh"));
-      builder.submitTask(TLSTask::create<InitCompositeMeshTask>("InitCompositeMesh"));
     }
 
     //Add MeshAssetRow to all tables with Loader::MeshAssetRow
@@ -294,38 +100,7 @@ namespace Shapes {
       storage->rows.resize(tables.size());
       for(size_t i = 0; i < tables.size(); ++i) {
         DBReflect::details::reflectRow(storage->rows[i].mesh, *tables[i]);
-        DBReflect::details::reflectRow(storage->rows[i].composite, *tables[i]);
       }
-      //Add table for all the child meshes of a composite mesh
-      args.tables.emplace_back();
-      std::invoke([] {
-        StorageTableBuilder table;
-        //Pieces of the full model broken down into a bunch of smaller ones.
-        //These are assets referenced by MeshReferenceRow
-        table.addRows<
-          CompositeMeshTagRow,
-          StableIDRow,
-          Relation::HasParentRow,
-          MeshAssetRow
-        >().setTableName({ "Triangles" });
-        Transform::addTransform25D(table);
-        return table;
-      }).finalize(args);
-
-      //Add table for instances of those child meshes.
-      std::invoke([] {
-        StorageTableBuilder table;
-        //Add rows needed for collision, omit mass which means a static (infinite mass) mesh
-        PhysicsTableBuilder::addRigidbody(table);
-        PhysicsTableBuilder::addCollider(table);
-        PhysicsTableBuilder::addImmobile(table);
-        Transform::addTransform25D(table);
-        table.addRows<
-          TriangleMeshRow,
-          Narrowphase::ThicknessRow
-        >().setStable().setTableName({ "Triangle Instances" });
-        return table;
-      }).finalize(args);
     }
 
     //For any objects that load with MatMeshRefRow, copy that mesh reference into MeshReferenceRow if it exists to use for collision.
@@ -372,6 +147,8 @@ namespace Shapes {
           .worldToModel = &inverse,
           .points = asset->convexHull,
           .aabb = asset->aabb,
+          .normals = asset->convexHullNormals,
+          .radius = asset->radius
         }};
       }
       return {};
@@ -388,27 +165,32 @@ namespace Shapes {
   public:
     StaticTriangleMeshClassifier(RuntimeDatabaseTaskBuilder& task, ITableResolver& res)
       : tableResolver{ res }
+      , ids{ task.getIDResolver()->getRefResolver() }
     {
-      task.getResolver(meshRef);
+      task.getResolver(meshRef, meshAsset);
     }
 
     ShapeRegistry::BodyType classifyShape(const UnpackedDatabaseElementID& id, const Transform::PackedTransform& transform, const Transform::PackedTransform& inverse) final {
-      if(const TriangleMesh* ref = tableResolver.tryGetOrSwapRowElement(meshRef, id)) {
-        return { ShapeRegistry::Mesh{
+      const StaticTriangleMeshReference* ref = tableResolver.tryGetOrSwapRowElement(meshRef, id);
+      const Shapes::MeshAsset* asset = ref ? tableResolver.tryGetOrSwapRowElement(meshAsset, ids.tryUnpack(ref->meshAsset.asset)) : nullptr;
+      if(asset) {
+        return { ShapeRegistry::TriangleMesh{
           .modelToWorld = &transform,
           .worldToModel = &inverse,
-          .points = ref->points,
-          .aabb = ref->aabb,
+          .bvh = &asset->triangles
         }};
       }
       return {};
     }
 
-    CachedRow<const TriangleMeshRow> meshRef;
     ITableResolver& tableResolver;
+    CachedRow<const StaticTriangleMeshReferenceRow> meshRef;
+    CachedRow<const MeshAssetRow> meshAsset;
+    ElementRefResolver ids;
   };
 
   void resizeBounds(ShapeRegistry::BroadphaseBounds& bounds, size_t size) {
+    bounds.elements.resize(size);
     bounds.minX.resize(size);
     bounds.minY.resize(size);
     bounds.maxX.resize(size);
@@ -422,6 +204,9 @@ namespace Shapes {
     bounds.maxY.at(i) = bb.max.y;
   }
 
+  //ReferenceRow is the row holding each element's mesh asset reference, MeshReferenceRow or StaticTriangleMeshReferenceRow
+  //Bounds come from the referenced asset's model space AABB transformed to world
+  template<class ReferenceRow>
   struct UpdateBoundaries {
     struct Args {
       ShapeRegistry::BroadphaseBounds& bounds;
@@ -440,11 +225,14 @@ namespace Shapes {
 
       ShapeRegistry::BroadphaseBounds* bounds{};
       QueryResult<
-        const MeshReferenceRow,
-        const Transform::WorldTransformRow
+        const ReferenceRow,
+        const Transform::WorldTransformRow,
+        const Transform::TransformHasUpdatedRow
       > query;
       std::shared_ptr<ITableResolver> resolver;
       ElementRefResolver ids;
+      //Elements whose mesh asset wasn't available yet, retried each frame since they may not move again
+      std::vector<uint32_t> unresolved;
     };
 
     void init() {}
@@ -453,14 +241,27 @@ namespace Shapes {
       CachedRow<const MeshAssetRow> assets;
       assert(g.query.size() <= 1);
       for(size_t t = 0; t < g.query.size(); ++t) {
-        auto&& [shape, transforms] = g.query.get(t);
-        resizeBounds(*g.bounds, transforms->size());
+        auto&& [shape, transforms, updated] = g.query.get(t);
+        gatherBoundsElements(*g.bounds, *updated, transforms->size());
+        std::vector<uint32_t>& elements = g.bounds->elements;
+        if(g.bounds->onlyUpdated) {
+          for(uint32_t e : g.unresolved) {
+            if(e < transforms->size()) {
+              elements.push_back(e);
+            }
+          }
+        }
+        g.unresolved.clear();
+        resizeBounds(*g.bounds, elements.size());
 
-        for(size_t i = 0; i < transforms->size(); ++i) {
+        //Compact the resolved elements to the front, the rest are tried again next frame
+        size_t written = 0;
+        for(size_t i = 0; i < elements.size(); ++i) {
+          const uint32_t e = elements[i];
           //Resolve mesh
-          if(const MeshAsset* mesh = g.resolver->tryGetOrSwapRowElement(assets, g.ids.unpack(shape->at(i).meshAsset.asset))) {
+          if(const MeshAsset* mesh = g.resolver->tryGetOrSwapRowElement(assets, g.ids.unpack(shape->at(e).meshAsset.asset))) {
             //Resolve transform
-            const Transform::PackedTransform& transform = transforms->at(i);
+            const Transform::PackedTransform& transform = transforms->at(e);
             //Transform aabb to world
             auto points = mesh->aabb.points();
             Geo::AABB worldBB;
@@ -469,52 +270,16 @@ namespace Shapes {
               worldBB.buildAdd(transform.transformPoint(point));
             }
 
-            writeWorldBounds(*g.bounds, i, worldBB);
+            writeWorldBounds(*g.bounds, written, worldBB);
+            elements[written++] = e;
+          }
+          else if(g.bounds->onlyUpdated) {
+            g.unresolved.push_back(e);
           }
         }
+        resizeBounds(*g.bounds, written);
       }
     }
-
-    std::optional<MeshClassifier> classifier;
-  };
-
-  struct UpdateStaticTriangleMeshBoundaries {
-    struct Args {
-      ShapeRegistry::BroadphaseBounds& bounds;
-    };
-    struct Group {
-      void init(const Args& args) {
-        bounds = &args.bounds;
-      }
-
-      void init(RuntimeDatabaseTaskBuilder& task) {
-        task.logDependency({ bounds->requiredDependency });
-        childMeshQuery = task.query<
-          const TriangleMeshRow
-        >(bounds->table);
-      }
-
-      ShapeRegistry::BroadphaseBounds* bounds{};
-      QueryResult<
-        const TriangleMeshRow
-      > childMeshQuery;
-    };
-
-    void init() {}
-
-    void execute(Group& g) {
-      //TODO: do nothing because they're static
-      for(size_t t = 0; t < g.childMeshQuery.size(); ++t) {
-        auto&& [mesh] = g.childMeshQuery.get(t);
-        resizeBounds(*g.bounds, mesh->size());
-
-        for(size_t i = 0; i < mesh->size(); ++i) {
-          writeWorldBounds(*g.bounds, i, mesh->at(i).aabb);
-        }
-      }
-    }
-
-    std::optional<MeshClassifier> classifier;
   };
 
   class MeshImpl : public ShapeRegistry::IShapeImpl {
@@ -528,7 +293,8 @@ namespace Shapes {
     }
 
     void writeBoundaries(IAppBuilder& builder, ShapeRegistry::BroadphaseBounds& bounds) const final {
-      builder.submitTask(TLSTask::createWithArgs<UpdateBoundaries, UpdateBoundaries::Group>("UpdateMeshBounds", UpdateBoundaries::Args{
+      using Task = UpdateBoundaries<MeshReferenceRow>;
+      builder.submitTask(TLSTask::createWithArgs<Task, Task::Group>("UpdateMeshBounds", Task::Args{
         .bounds = bounds
       }));
     }
@@ -536,7 +302,7 @@ namespace Shapes {
 
   class StaticTriangleMeshImpl : public ShapeRegistry::IShapeImpl {
     std::vector<TableID> queryTables(IAppBuilder& builder) const final {
-      return builder.queryTables<TriangleMeshRow>().getMatchingTableIDs();
+      return builder.queryTables<StaticTriangleMeshReferenceRow>().getMatchingTableIDs();
     }
 
     std::shared_ptr<ShapeRegistry::IShapeClassifier> createShapeClassifier(RuntimeDatabaseTaskBuilder& task, ITableResolver& resolver) const final {
@@ -544,7 +310,8 @@ namespace Shapes {
     }
 
     void writeBoundaries(IAppBuilder& builder, ShapeRegistry::BroadphaseBounds& bounds) const final {
-      builder.submitTask(TLSTask::createWithArgs<UpdateStaticTriangleMeshBoundaries, UpdateStaticTriangleMeshBoundaries::Group>("UpdateMeshBounds", UpdateStaticTriangleMeshBoundaries::Args{
+      using Task = UpdateBoundaries<StaticTriangleMeshReferenceRow>;
+      builder.submitTask(TLSTask::createWithArgs<Task, Task::Group>("UpdateStaticTriangleMeshBounds", Task::Args{
         .bounds = bounds
       }));
     }
@@ -5,6 +5,7 @@
 #include <glm/vec2.hpp>
 #include <loader/AssetHandle.h>
 #include <math/Geometric.h>
+#include <shapes/TriangleBVH.h>
 
 namespace ShapeRegistry {
   struct IShapeImpl;
@@ -18,10 +19,10 @@ namespace Shapes {
   struct MeshReference {
     Loader::AssetHandle meshAsset;
   };
-  //Same as MeshReference, but interprets the mesh as a composite mesh for each triangle.
+  //Same as MeshReference, but collides with each triangle of the mesh instead of its convex hull, see MeshAsset::triangles
   //Such meshes are not allowed to move (static), so are intended for terrain.
   struct StaticTriangleMeshReference : MeshReference {};
-  //Add this to tables that want mesh collision. The table must also have Relation::HasChildrenRow as the composite uses children.
+  //Add this to tables that want mesh collision
   struct MeshReferenceRow : Row<MeshReference> {};
   struct StaticTriangleMeshReferenceRow : Row<StaticTriangleMeshReference> {};
 
@@ -29,7 +30,13 @@ namespace Shapes {
   struct MeshAsset {
     std::vector<glm::vec2> points;
     std::vector<glm::vec2> convexHull;
+    //Model space normals of the convex hull edges, see Narrowphase::computeEdgeNormals
+    std::vector<glm::vec2> convexHullNormals;
     Geo::AABB aabb;
+    //World space rounding of the convex hull
+    float radius{};
+    //Non-degenerate triangles of points used by StaticTriangleMeshReference
+    TriangleBVH triangles;
   };
   struct MeshAssetRow : Row<MeshAsset> {};
 
@@ -1,4 +1,5 @@
 #include "shapes/Rectangle.h"
+#include "shapes/ShapeBounds.h"
 #include "AppBuilder.h"
 #include "Physics.h"
 #include <math/Geometric.h>
@@ -44,23 +45,11 @@ namespace Shapes {
       task.setName("write rect indiv bounds");
       task.logDependency({ bounds.requiredDependency });
 
-      auto query = task.query<const RectangleRow, const Transform::WorldTransformRow>(bounds.table);
+      auto query = task.query<const RectangleRow, const Transform::WorldTransformRow, const Transform::TransformHasUpdatedRow>(bounds.table);
       task.setCallback([query, &bounds](AppTaskArgs&) mutable {
-        auto [_, transforms] = query.get(0);
-        const size_t s = transforms->size();
-        bounds.minX.resize(s);
-        bounds.minY.resize(s);
-        bounds.maxX.resize(s);
-        bounds.maxY.resize(s);
-        for(size_t i = 0; i < transforms->size(); ++i) {
-          const Transform::PackedTransform& t = transforms->at(i);
-          const glm::vec2 extents = (glm::abs(t.basisX()) + glm::abs(t.basisY()))*RECT_SCALE;
-          const glm::vec2 center = t.pos2();
-          bounds.minX[i] = center.x - extents.x;
-          bounds.maxX[i] = center.x + extents.x;
-          bounds.minY[i] = center.y - extents.y;
-          bounds.maxY[i] = center.y + extents.y;
-        }
+        auto [_, transforms, updated] = query.get(0);
+        gatherBoundsElements(bounds, *updated, transforms->size());
+        writeRectangleBounds(bounds, *transforms, RECT_SCALE);
       });
 
       builder.submitTask(std::move(task));
@@ -0,0 +1,69 @@
+#include "Precompile.h"
+#include "shapes/ShapeBounds.h"
+
+#include "out_ispc/unity.h"
+#include "shapes/ShapeRegistry.h"
+#include <transform/TransformRows.h>
+#include <numeric>
+
+namespace Shapes {
+  static_assert(sizeof(Transform::PackedTransform) == sizeof(float)*7, "Bounds.ispc reads transforms as 7 floats");
+
+  namespace {
+    const float* asFloats(const Transform::WorldTransformRow& transforms) {
+      return reinterpret_cast<const float*>(transforms.data());
+    }
+  }
+
+  void gatherBoundsElements(ShapeRegistry::BroadphaseBounds& bounds, const Transform::TransformHasUpdatedRow& updated, size_t tableSize) {
+    bounds.elements.clear();
+    if(bounds.onlyUpdated) {
+      for(size_t i : updated) {
+        bounds.elements.push_back(static_cast<uint32_t>(i));
+      }
+    }
+    else {
+      bounds.elements.resize(tableSize);
+      std::iota(bounds.elements.begin(), bounds.elements.end(), 0);
+    }
+    const size_t s = bounds.elements.size();
+    bounds.minX.resize(s);
+    bounds.minY.resize(s);
+    bounds.maxX.resize(s);
+    bounds.maxY.resize(s);
+  }
+
+  void writeRectangleBounds(ShapeRegistry::BroadphaseBounds& bounds, const Transform::WorldTransformRow& transforms, float halfScale) {
+    ispc::rectangleBounds(asFloats(transforms),
+      bounds.elements.data(),
+      halfScale,
+      bounds.minX.data(),
+      bounds.minY.data(),
+      bounds.maxX.data(),
+      bounds.maxY.data(),
+      static_cast<uint32_t>(bounds.elements.size())
+    );
+  }
+
+  void writeCircleBounds(ShapeRegistry::BroadphaseBounds& bounds, const Transform::WorldTransformRow& transforms) {
+    ispc::circleBounds(asFloats(transforms),
+      bounds.elements.data(),
+      bounds.minX.data(),
+      bounds.minY.data(),
+      bounds.maxX.data(),
+      bounds.maxY.data(),
+      static_cast<uint32_t>(bounds.elements.size())
+    );
+  }
+
+  void writeAABBBounds(ShapeRegistry::BroadphaseBounds& bounds, const Transform::WorldTransformRow& transforms) {
+    ispc::aabbBounds(asFloats(transforms),
+      bounds.elements.data(),
+      bounds.minX.data(),
+      bounds.minY.data(),
+      bounds.maxX.data(),
+      bounds.maxY.data(),
+      static_cast<uint32_t>(bounds.elements.size())
+    );
+  }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+namespace ShapeRegistry {
+  struct BroadphaseBounds;
+}
+
+namespace Transform {
+  struct TransformHasUpdatedRow;
+  struct WorldTransformRow;
+}
+
+namespace Shapes {
+  //Fill BroadphaseBounds::elements with the elements of the table whose bounds need to be written this frame
+  //and size the bounds to match. This is all of them unless the table only wants elements that moved
+  void gatherBoundsElements(ShapeRegistry::BroadphaseBounds& bounds, const Transform::TransformHasUpdatedRow& updated, size_t tableSize);
+
+  //Vectorized bounds of the gathered elements for shapes that are entirely described by their transform
+  void writeRectangleBounds(ShapeRegistry::BroadphaseBounds& bounds, const Transform::WorldTransformRow& transforms, float halfScale);
+  void writeCircleBounds(ShapeRegistry::BroadphaseBounds& bounds, const Transform::WorldTransformRow& transforms);
+  void writeAABBBounds(ShapeRegistry::BroadphaseBounds& bounds, const Transform::WorldTransformRow& transforms);
+}
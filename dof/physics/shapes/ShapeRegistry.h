@@ -3,6 +3,7 @@
 #include "Table.h"
 #include "glm/vec2.hpp"
 #include <variant>
+#include <span>
 #include "QueryAlias.h"
 #include "DatabaseID.h"
 #include <transform/TransformResolver.h>
@@ -13,6 +14,10 @@ class IAppBuilder;
 class RuntimeDatabaseTaskBuilder;
 class ITableResolver;
 
+namespace Shapes {
+  struct TriangleBVH;
+}
+
 namespace ShapeRegistry {
   struct Rectangle {
     glm::vec2 center{};
@@ -34,10 +39,20 @@ namespace ShapeRegistry {
   struct Mesh {
     const Transform::PackedTransform* modelToWorld{};
     const Transform::PackedTransform* worldToModel{};
-    const std::vector<glm::vec2>& points;
+    std::span<const glm::vec2> points;
     Geo::AABB aabb;
+    //Model space edge normals as computed by Narrowphase::computeEdgeNormals. Computed from the points during contact generation if empty
+    std::span<const glm::vec2> normals;
+    //World space distance the shape extends past its points, rounding off the corners
+    float radius{};
+  };
+  //Non-convex static mesh that collides as if each of its triangles was a Mesh
+  struct TriangleMesh {
+    const Transform::PackedTransform* modelToWorld{};
+    const Transform::PackedTransform* worldToModel{};
+    const Shapes::TriangleBVH* bvh{};
   };
-  using Variant = std::variant<std::monostate, Rectangle, Raycast, AABB, Circle, Mesh>;
+  using Variant = std::variant<std::monostate, Rectangle, Raycast, AABB, Circle, Mesh, TriangleMesh>;
 
   struct BodyType {
     Variant shape;
@@ -51,6 +66,10 @@ namespace ShapeRegistry {
   struct BroadphaseBounds {
     QueryAliasBase requiredDependency;
     TableID table;
+    //If set only elements flagged in TransformHasUpdatedRow are written, otherwise all of them are
+    bool onlyUpdated{};
+    //Element indices in the table of each of the bounds below, see Shapes::gatherBoundsElements
+    std::vector<uint32_t> elements;
     std::vector<float> minX, minY, maxX, maxY;
   };
 
@@ -63,6 +82,7 @@ namespace ShapeRegistry {
     virtual std::shared_ptr<IShapeClassifier> createShapeClassifier(RuntimeDatabaseTaskBuilder& task, ITableResolver& resolver) const = 0;
     //Submit a task that writes the bounds for the given table to the container
     //Must take a const dependency on the requiredDependency field for this to schedule insertion into broadphase properly
+    //Bounds are only written for the elements chosen by Shapes::gatherBoundsElements
     virtual void writeBoundaries(IAppBuilder& builder, BroadphaseBounds& bounds) const = 0;
   };
 
@@ -0,0 +1,93 @@
+#include "Precompile.h"
+#include <shapes/TriangleBVH.h>
+
+#include <MeshNarrowphase.h>
+
+namespace Shapes {
+  namespace {
+    struct BuildTriangle {
+      std::array<glm::vec2, 3> points;
+      glm::vec2 centroid{};
+      Geo::AABB bounds;
+    };
+
+    struct BuildContext {
+      std::vector<BuildTriangle>& triangles;
+      TriangleBVH& result;
+    };
+
+    //Split the range at the median centroid along the axis the centroids are most spread out on
+    //Each range is written in order as a node followed by its left then right subtrees
+    void buildNode(BuildContext& ctx, uint32_t begin, uint32_t end) {
+      const uint32_t nodeIndex = static_cast<uint32_t>(ctx.result.nodes.size());
+      ctx.result.nodes.emplace_back();
+      Geo::AABB bounds, centroidBounds;
+      bounds.buildInit();
+      centroidBounds.buildInit();
+      for(uint32_t i = begin; i < end; ++i) {
+        bounds.buildAdd(ctx.triangles[i].bounds.min);
+        bounds.buildAdd(ctx.triangles[i].bounds.max);
+        centroidBounds.buildAdd(ctx.triangles[i].centroid);
+      }
+      ctx.result.nodes[nodeIndex].bounds = bounds;
+
+      const uint32_t count = end - begin;
+      if(count <= TriangleBVH::MAX_LEAF_TRIANGLES) {
+        TriangleBVH::Node& node = ctx.result.nodes[nodeIndex];
+        node.index = begin;
+        node.count = count;
+        return;
+      }
+
+      const glm::vec2 extents = centroidBounds.max - centroidBounds.min;
+      const int axis = extents.x >= extents.y ? 0 : 1;
+      const uint32_t mid = begin + count/2;
+      std::nth_element(ctx.triangles.begin() + begin, ctx.triangles.begin() + mid, ctx.triangles.begin() + end, [axis](const BuildTriangle& l, const BuildTriangle& r) {
+        return l.centroid[axis] < r.centroid[axis];
+      });
+
+      buildNode(ctx, begin, mid);
+      //Nodes may have been reallocated by the left subtree
+      ctx.result.nodes[nodeIndex].index = static_cast<uint32_t>(ctx.result.nodes.size());
+      buildNode(ctx, mid, end);
+    }
+  }
+
+  TriangleBVH buildTriangleBVH(std::span<const glm::vec2> triangleList) {
+    std::vector<BuildTriangle> triangles;
+    triangles.reserve(triangleList.size() / 3);
+    for(size_t i = 0; i + 2 < triangleList.size(); i += 3) {
+      BuildTriangle t{ .points = { triangleList[i], triangleList[i + 1], triangleList[i + 2] } };
+      const float area = Geo::cross(t.points[1] - t.points[0], t.points[2] - t.points[0]);
+      //Find all "valid" triangles as ones that have some amount of area.
+      if(std::abs(area) <= 0.01f) {
+        continue;
+      }
+      //Contact generation expects counterclockwise winding
+      if(area < 0.0f) {
+        std::swap(t.points[1], t.points[2]);
+      }
+      t.centroid = (t.points[0] + t.points[1] + t.points[2]) / 3.0f;
+      t.bounds = Geo::AABB::build({ t.points[0], t.points[1], t.points[2] });
+      triangles.push_back(t);
+    }
+
+    TriangleBVH result;
+    if(triangles.empty()) {
+      return result;
+    }
+    BuildContext ctx{ triangles, result };
+    buildNode(ctx, 0, static_cast<uint32_t>(triangles.size()));
+
+    //Leaves refer to ranges of the sorted triangles, copy them out in that order
+    result.points.reserve(triangles.size()*3);
+    for(const BuildTriangle& t : triangles) {
+      result.points.insert(result.points.end(), t.points.begin(), t.points.end());
+    }
+    result.normals.resize(result.points.size());
+    for(size_t i = 0; i < triangles.size(); ++i) {
+      Narrowphase::computeEdgeNormals(result.getTriangle(i), std::span<glm::vec2>{ result.normals }.subspan(i*3, 3));
+    }
+    return result;
+  }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <math/Geometric.h>
+#include <span>
+#include <vector>
+
+namespace Shapes {
+  //Bounding volume hierarchy over the triangles of a static mesh, flattened into an array in depth first order
+  //Points and normals are in model space. Each triangle is three consecutive counterclockwise points and the
+  //edge normals of those points as computed by Narrowphase::computeEdgeNormals
+  struct TriangleBVH {
+    static constexpr uint32_t MAX_LEAF_TRIANGLES = 4;
+    static constexpr uint32_t MAX_DEPTH = 64;
+
+    struct Node {
+      bool isLeaf() const {
+        return count != 0;
+      }
+
+      Geo::AABB bounds;
+      //The first triangle of a leaf or the right child of an interior node. The left child is always the next node
+      uint32_t index{};
+      //Number of triangles in a leaf, zero for interior nodes
+      uint32_t count{};
+    };
+
+    size_t triangleCount() const {
+      return points.size() / 3;
+    }
+
+    std::span<const glm::vec2> getTriangle(size_t i) const {
+      return std::span<const glm::vec2>{ points }.subspan(i*3, 3);
+    }
+
+    std::span<const glm::vec2> getTriangleNormals(size_t i) const {
+      return std::span<const glm::vec2>{ normals }.subspan(i*3, 3);
+    }
+
+    //Invoke visitor with the index of each triangle whose bounds overlap the model space bounds
+    template<class Visitor>
+    void query(const Geo::AABB& bounds, const Visitor& visitor) const {
+      if(nodes.empty()) {
+        return;
+      }
+      uint32_t stack[MAX_DEPTH];
+      uint32_t stackSize = 0;
+      stack[stackSize++] = 0;
+      while(stackSize) {
+        const uint32_t n = stack[--stackSize];
+        const Node& node = nodes[n];
+        if(!node.bounds.overlaps(bounds)) {
+          continue;
+        }
+        if(node.isLeaf()) {
+          for(uint32_t i = node.index; i < node.index + node.count; ++i) {
+            const glm::vec2* t = &points[i*3];
+            if(Geo::AABB::build({ t[0], t[1], t[2] }).overlaps(bounds)) {
+              visitor(i);
+            }
+          }
+        }
+        else {
+          assert(stackSize + 2 <= MAX_DEPTH);
+          stack[stackSize++] = node.index;
+          stack[stackSize++] = n + 1;
+        }
+      }
+    }
+
+    std::vector<glm::vec2> points;
+    std::vector<glm::vec2> normals;
+    std::vector<Node> nodes;
+  };
+
+  //Build from a triangle list where each consecutive three points is a triangle of either winding
+  //Degenerate triangles are skipped
+  TriangleBVH buildTriangleBVH(std::span<const glm::vec2> triangleList);
+}
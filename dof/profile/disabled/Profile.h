@@ -1,4 +1,13 @@
 #pragma once
 
-#define PROFILE_SCOPE(area, name)
-#define PROFILE_UPDATE(context)
\ No newline at end of file
+#include "Trace.h"
+
+#define PROFILE_SCOPE(area, name) TRACE_SCOPE(area, name)
+#define PROFILE_UPDATE(context) Trace::onFrame()
+
+using ProfileToken = uint64_t;
+
+#define PROFILE_CREATETOKEN(area, name, color) ProfileToken{}
+#define PROFILE_ENTER_TOKEN(token)
+#define PROFILE_EXIT_TOKEN(token)
+#define ON_PROFILE_THREAD_DESTROYED
@@ -1,14 +1,15 @@
 #pragma once
 
 #include "microprofile.h"
+#include "Trace.h"
 
-#define PROFILE_SCOPE(area, name) MICROPROFILE_SCOPEI(area, name, 0)
+#define PROFILE_SCOPE(area, name) MICROPROFILE_SCOPEI(area, name, 0); TRACE_SCOPE(area, name)
 
-#define PROFILE_UPDATE(context) MicroProfileFlip(context)
+#define PROFILE_UPDATE(context) MicroProfileFlip(context); Trace::onFrame()
 
 using ProfileToken = uint64_t;
 
 #define PROFILE_CREATETOKEN(area, name, color) MicroProfileGetToken(area, name, color, MicroProfileTokenTypeCpu, 0)
 #define PROFILE_ENTER_TOKEN(token) MicroProfileEnter(token)
 #define PROFILE_EXIT_TOKEN(token) MicroProfileLeave()
-#define ON_PROFILE_THREAD_DESTROYED MicroProfileOnThreadExit()
\ No newline at end of file
+#define ON_PROFILE_THREAD_DESTROYED MicroProfileOnThreadExit()
@@ -0,0 +1,147 @@
+#include "Trace.h"
+
+#include <array>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Trace {
+  namespace details {
+    std::atomic_bool enabled{ true };
+    std::atomic_uint32_t frame{};
+  }
+
+  namespace {
+    //Enough for a few frames of every task and profile scope on a thread
+    constexpr size_t BUFFER_CAPACITY = 1 << 15;
+
+    //Written only by the owning thread. Head is published after the event is written so readers on other threads
+    //see complete events unless the writer laps them during the read
+    struct ThreadBuffer {
+      std::array<Event, BUFFER_CAPACITY> events;
+      std::atomic_uint64_t head{};
+      uint32_t threadIndex{};
+    };
+
+    struct Registry {
+      std::mutex mutex;
+      //Buffers are never destroyed so that events from threads that have exited can still be dumped
+      std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+      const TimePoint epoch = Clock::now();
+    };
+
+    Registry& getRegistry() {
+      static Registry registry;
+      return registry;
+    }
+
+    ThreadBuffer& getThreadBuffer() {
+      thread_local ThreadBuffer* buffer = nullptr;
+      if(!buffer) {
+        Registry& registry = getRegistry();
+        std::lock_guard<std::mutex> lock{ registry.mutex };
+        registry.buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = registry.buffers.back().get();
+        buffer->threadIndex = static_cast<uint32_t>(registry.buffers.size() - 1);
+      }
+      return *buffer;
+    }
+
+    void writeEscaped(std::ostream& stream, std::string_view str) {
+      for(char c : str) {
+        if(c == '"' || c == '\\') {
+          stream << '\\';
+        }
+        stream << c;
+      }
+    }
+
+    double toMicroseconds(Clock::duration d) {
+      return std::chrono::duration<double, std::micro>(d).count();
+    }
+  }
+
+  void details::record(const Event& e) {
+    ThreadBuffer& buffer = getThreadBuffer();
+    const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    buffer.events[head % BUFFER_CAPACITY] = e;
+    buffer.head.store(head + 1, std::memory_order_release);
+  }
+
+  void setEnabled(bool enabled) {
+    details::enabled.store(enabled, std::memory_order_relaxed);
+  }
+
+  void onFrame() {
+    details::frame.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  uint32_t getFrame() {
+    return details::frame.load(std::memory_order_relaxed);
+  }
+
+  void writeChromeTrace(std::ostream& stream, uint32_t frameCount) {
+    Registry& registry = getRegistry();
+    std::vector<ThreadBuffer*> buffers;
+    {
+      std::lock_guard<std::mutex> lock{ registry.mutex };
+      buffers.reserve(registry.buffers.size());
+      for(const auto& buffer : registry.buffers) {
+        buffers.push_back(buffer.get());
+      }
+    }
+
+    const uint32_t currentFrame = getFrame();
+    const uint32_t minFrame = currentFrame >= frameCount ? currentFrame - frameCount : 0;
+    bool first = true;
+    auto separate = [&] {
+      if(!first) {
+        stream << ",\n";
+      }
+      first = false;
+    };
+
+    //Default precision switches to scientific notation after a few seconds, collapsing nearby events onto the same timestamp
+    const std::ios_base::fmtflags previousFlags = stream.flags();
+    const std::streamsize previousPrecision = stream.precision();
+    stream << std::fixed << std::setprecision(3);
+    stream << "{\"traceEvents\":[\n";
+    for(const ThreadBuffer* buffer : buffers) {
+      separate();
+      stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->threadIndex
+        << ",\"args\":{\"name\":\"Thread " << buffer->threadIndex << "\"}}";
+
+      const uint64_t head = buffer->head.load(std::memory_order_acquire);
+      const uint64_t begin = head > BUFFER_CAPACITY ? head - BUFFER_CAPACITY : 0;
+      for(uint64_t i = begin; i < head; ++i) {
+        const Event& e = buffer->events[i % BUFFER_CAPACITY];
+        if(e.frame < minFrame || e.frame > currentFrame) {
+          continue;
+        }
+        separate();
+        stream << "{\"name\":\"";
+        writeEscaped(stream, e.name);
+        stream << "\",\"cat\":\"";
+        writeEscaped(stream, e.category);
+        stream << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->threadIndex
+          << ",\"ts\":" << toMicroseconds(e.begin - registry.epoch)
+          << ",\"dur\":" << toMicroseconds(e.end - e.begin)
+          << ",\"args\":{\"frame\":" << e.frame << "}}";
+      }
+    }
+    stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    stream.flags(previousFlags);
+    stream.precision(previousPrecision);
+  }
+
+  bool writeChromeTrace(const char* path, uint32_t frameCount) {
+    std::ofstream stream(path, std::ios::trunc);
+    if(!stream.good()) {
+      return false;
+    }
+    writeChromeTrace(stream, frameCount);
+    return stream.good();
+  }
+}
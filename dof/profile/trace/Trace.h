@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+//Lightweight always available tracer that records scopes into per-thread ring buffers
+//and can dump the most recent frames as Chrome trace JSON, viewable in chrome://tracing or Perfetto.
+//Recording a scope is two clock reads and a write to a thread local buffer so it's cheap enough to leave on.
+namespace Trace {
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  struct Event {
+    std::string_view category;
+    std::string_view name;
+    TimePoint begin;
+    TimePoint end;
+    uint32_t frame{};
+  };
+
+  namespace details {
+    extern std::atomic_bool enabled;
+    extern std::atomic_uint32_t frame;
+    void record(const Event& e);
+  }
+
+  inline bool isEnabled() {
+    return details::enabled.load(std::memory_order_relaxed);
+  }
+
+  void setEnabled(bool enabled);
+  //Marks the end of a frame. Used to determine how many events to include in a dump
+  void onFrame();
+  uint32_t getFrame();
+
+  //Write the events of the last frameCount frames in Chrome trace event format.
+  //Threads that are recording while this is happening may overwrite events that are being read, so prefer calling this between frames.
+  void writeChromeTrace(std::ostream& stream, uint32_t frameCount);
+  bool writeChromeTrace(const char* path, uint32_t frameCount);
+
+  //Names are expected to outlive the trace, like string literals or task names
+  struct Scope {
+    Scope(std::string_view c, std::string_view n)
+      : category{ c }
+      , name{ n }
+      , begin{ isEnabled() ? Clock::now() : TimePoint{} } {
+    }
+
+    ~Scope() {
+      if(begin != TimePoint{} && isEnabled()) {
+        details::record(Event{
+          .category = category,
+          .name = name,
+          .begin = begin,
+          .end = Clock::now(),
+          .frame = details::frame.load(std::memory_order_relaxed)
+        });
+      }
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    std::string_view category;
+    std::string_view name;
+    TimePoint begin;
+  };
+}
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(category, name) Trace::Scope TRACE_CONCAT(traceScope, __LINE__){ category, name }
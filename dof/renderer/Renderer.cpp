@@ -929,6 +929,20 @@ public:
     Renderer::commit(builder);
   }
 
+  void preSimDraw(IAppBuilder& builder) final {
+    Renderer::render(builder);
+  }
+
+  void postSimDraw(IAppBuilder& builder) final {
+    Renderer::endMainPass(builder);
+    Renderer::commit(builder);
+  }
+
+  void postSimExtract(IAppBuilder& builder) final {
+    Renderer::extractRenderables(builder);
+    Renderer::clearRenderRequests(builder);
+  }
+
   void preProcessEvents(IAppBuilder& builder) final {
     Renderer::preProcessEvents(builder);
   }
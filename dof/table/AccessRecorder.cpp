@@ -0,0 +1,30 @@
+#include "Precompile.h"
+#include "AccessRecorder.h"
+
+namespace AccessRecorder {
+  namespace details {
+    thread_local Recording* active{};
+    std::atomic_uint32_t activeCount{};
+  }
+
+  template<class T>
+  void eraseDuplicates(T& container) {
+    std::sort(container.begin(), container.end());
+    container.erase(std::unique(container.begin(), container.end()), container.end());
+  }
+
+  void Recording::compact() {
+    eraseDuplicates(rows);
+    eraseDuplicates(modifiedTables);
+  }
+
+  void setActive(Recording* recording) {
+    if(!details::active && recording) {
+      details::activeCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if(details::active && !recording) {
+      details::activeCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+    details::active = recording;
+  }
+}
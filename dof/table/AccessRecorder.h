@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+
+#include "DBTypeID.h"
+#include "DatabaseID.h"
+
+//Diagnostic that records which rows and tables are looked up on the current thread while a recording is active.
+//Used to find tasks that are synchronous because they use the entire database but only touch a few tables.
+//Rows accessed through pointers obtained before the recording started are not seen
+namespace AccessRecorder {
+  struct RowAccess {
+    auto operator<=>(const RowAccess&) const = default;
+
+    TableID table;
+    DBTypeID row;
+  };
+
+  struct Recording {
+    //Remove duplicates so that a recording can accumulate over many frames
+    void compact();
+
+    std::vector<RowAccess> rows;
+    //Tables that elements were added to or removed from
+    std::vector<TableID> modifiedTables;
+  };
+
+  namespace details {
+    extern thread_local Recording* active;
+    //Number of threads with an active recording. Checked before the thread local so row lookups only pay for a
+    //relaxed load of a global when nothing is recording, which is always the case outside of diagnostics
+    extern std::atomic_uint32_t activeCount;
+
+    inline Recording* tryGetActive() {
+      return activeCount.load(std::memory_order_relaxed) ? active : nullptr;
+    }
+  }
+
+  //Record on the current thread into the recording until this is called again with null
+  void setActive(Recording* recording);
+
+  inline void onRowAccess(const TableID& table, DBTypeID row) {
+    if(Recording* recording = details::tryGetActive()) {
+      recording->rows.push_back({ table, row });
+    }
+  }
+
+  inline void onTableModified(const TableID& table) {
+    if(Recording* recording = details::tryGetActive()) {
+      recording->modifiedTables.push_back(table);
+    }
+  }
+}
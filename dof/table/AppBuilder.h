@@ -188,10 +188,14 @@ struct AppTask {
   AppTaskPinning::Variant pinning;
 };
 
+struct AppTaskMetadata;
+
 struct AppTaskNode {
   std::unique_ptr<ITaskImpl> task;
   std::string_view name;
   std::vector<std::shared_ptr<AppTaskNode>> children;
+  //Dependencies that a synchronous task declared before they were replaced by a dependency on everything. Kept for diagnostics
+  std::shared_ptr<const AppTaskMetadata> synchronousDependencies;
 };
 
 struct TableAccess {
@@ -32,6 +32,13 @@ namespace Tasks {
     virtual ~ILocalScheduler() = default;
 
     virtual TaskHandle queueTask(TaskCallback&& task, const AppTaskSize& size) = 0;
+    //Create a task without starting it so that continuations can be attached before it runs. Start with startTasks
+    virtual TaskHandle createTask(TaskCallback&& task, const AppTaskSize& size) = 0;
+    //Create a task that starts on its own once all dependencies complete, without blocking the caller in the meantime
+    //Dependencies must come from createTask or createContinuation and not have been started yet
+    //Awaiting a continuation also counts as awaiting its dependencies, so only the ends of the chain need to be awaited
+    virtual TaskHandle createContinuation(const TaskHandle* dependencies, size_t count, TaskCallback&& task, const AppTaskSize& size) = 0;
+    virtual void startTasks(const TaskHandle* tasks, size_t count) = 0;
     //Convenience to chain a linked list of tasks together for await calls
     //May use LinkOptions in the future to also specify dependencies
     virtual void linkTasks(TaskHandle from, TaskHandle to, const LinkOptions& ops) = 0;
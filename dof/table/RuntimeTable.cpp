@@ -53,6 +53,8 @@ size_t RuntimeTable::migrate(size_t i, RuntimeTable& from, RuntimeTable& to, siz
   const size_t fromSize = from.size();
   const size_t dstBegin = to.size();
   const size_t dstEnd = dstBegin + count;
+  AccessRecorder::onTableModified(from.getID());
+  AccessRecorder::onTableModified(to.getID());
 
   if constexpr(Debug::DEBUG_TABLES) {
     Debug::checkTable(from.rows, from.size());
@@ -114,6 +116,7 @@ void RuntimeTable::resize(size_t newSize, const ElementRef* reservedKeys) {
   if constexpr(Debug::DEBUG_TABLES) {
     Debug::checkTable(rows, size());
   }
+  AccessRecorder::onTableModified(getID());
 
   for(auto& pair : rows) {
     if(pair.first == DBTypeID::get<StableIDRow>()) {
@@ -168,6 +171,7 @@ size_t RuntimeTable::rowCount() const {
 }
 
 void RuntimeTable::swapRemove(size_t i) {
+  AccessRecorder::onTableModified(getID());
   //Swap remove all rows, erase and update stable ids
   for(auto& pair : rows) {
     if(pair.first == DBTypeID::get<StableIDRow>()) {
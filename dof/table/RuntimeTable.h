@@ -2,6 +2,7 @@
 
 #include "DBTypeID.h"
 #include "DatabaseID.h"
+#include "AccessRecorder.h"
 
 class IRow;
 struct StableElementMappings;
@@ -109,12 +110,20 @@ public:
 
   IRow* tryGet(DBTypeID id) {
     auto it = rows.find(id);
-    return it != rows.end() ? it->second : nullptr;
+    if(it != rows.end()) {
+      AccessRecorder::onRowAccess(tableID, id);
+      return it->second;
+    }
+    return nullptr;
   }
 
   const IRow* tryGet(DBTypeID id) const {
     auto it = rows.find(id);
-    return it != rows.end() ? it->second : nullptr;
+    if(it != rows.end()) {
+      AccessRecorder::onRowAccess(tableID, id);
+      return it->second;
+    }
+    return nullptr;
   }
 
   //Number of elements in the table. All rows have this many elements except for SharedRow
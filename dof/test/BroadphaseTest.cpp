@@ -2,6 +2,9 @@
 #include "CppUnitTest.h"
 
 #include "SweepNPrune.h"
+#include "AABBTree.h"
+#include "SweepSoA.h"
+#include <random>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -20,6 +23,7 @@ namespace Test {
         Broadphase::IntermediateLog temp{ tempGain, tempLoss };
         Broadphase::ConstIntermediateLog ctemp{ tempGain, tempLoss };
         Broadphase::SweepNPrune::recomputePairs(sweep, objects, pairs, temp);
+        Broadphase::logFilterChanges(objects, pairs, log);
         Broadphase::logPendingRemovals(objects, temp, pairs);
         Broadphase::logChangedPairs(objects, pairs, ctemp, log);
         Broadphase::processPendingRemovals(objects);
@@ -466,5 +470,667 @@ namespace Test {
       assertPairsMatch(gainedPairs, { sweepPair(bottomLeft, upperRight) });
       assertPairsMatch(lostPairs, { sweepPair(bottomLeft, bottomRight) });
     }
+    struct TestTree {
+      TestTree(float margin = 0.0f) {
+        tree.margin = margin;
+      }
+
+      void insert(SweepEntry& entry) {
+        entry.mKey = mappings.createKey();
+        Broadphase::AABBTree::insertRange(tree, &entry.mKey, &entry.broadphaseKey, 1);
+        updateBoundaries(entry);
+      }
+
+      void updateBoundaries(const SweepEntry& entry) {
+        Broadphase::AABBTree::updateBoundaries(tree, &entry.mNewBoundaryMin.x, &entry.mNewBoundaryMax.x, &entry.mNewBoundaryMin.y, &entry.mNewBoundaryMax.y, &entry.broadphaseKey, 1);
+      }
+
+      void erase(const SweepEntry& entry) {
+        Broadphase::AABBTree::eraseRange(tree, &entry.broadphaseKey, 1);
+      }
+
+      void update() {
+        gained.clear();
+        lost.clear();
+        Broadphase::SwapLog log{ gained, lost };
+        Broadphase::AABBTree::recomputePairs(tree, log);
+        Assert::IsTrue(Broadphase::Debug::isValidTree(tree));
+      }
+
+      Broadphase::AABBTree::Tree tree;
+      StableElementMappings mappings;
+      std::vector<Broadphase::SweepCollisionPair> gained, lost;
+    };
+
+    static SweepEntry createEntry(const glm::vec2& min, const glm::vec2& max) {
+      SweepEntry result;
+      result.mNewBoundaryMin = min;
+      result.mNewBoundaryMax = max;
+      return result;
+    }
+
+    static void setFilter(TestSweep& sweep, const SweepEntry& entry, uint8_t mask, bool isImmobile) {
+      const Broadphase::CollisionFilter filter{ mask, isImmobile };
+      Broadphase::updateCollisionFilters(sweep.objects, &filter, &entry.broadphaseKey, 1);
+    }
+
+    TEST_METHOD(CollisionFilter_ReportsOnlyPairsThatCanCollide) {
+      TestSweep sweep;
+      std::vector<Broadphase::SweepCollisionPair> gains, losses;
+      SweepEntry a = createEntry(glm::vec2{ 0.0f }, glm::vec2{ 1.0f });
+      SweepEntry b = createEntry(glm::vec2{ 0.5f }, glm::vec2{ 1.5f });
+      a.mKey = sweep.createKey();
+      b.mKey = sweep.createKey();
+      for(SweepEntry* e : { &a, &b }) {
+        Broadphase::insertRange(sweep.objects, &e->mKey, &e->broadphaseKey, 1);
+        Broadphase::SweepNPrune::tryInsertRange(sweep.sweep, &e->broadphaseKey, 1);
+        updateBoundaries(sweep, *e);
+      }
+      setFilter(sweep, a, 1 << 0, false);
+      setFilter(sweep, b, 1 << 1, false);
+      update(sweep, gains, losses);
+      //Overlap is tracked but not reported since the masks don't match
+      assertPairsMatch(gains, {});
+      Assert::AreEqual(size_t(1), sweep.pairs.trackedPairs.size());
+
+      //Changing the mask reports the existing overlap
+      _clear(gains, losses);
+      setFilter(sweep, a, (1 << 0) | (1 << 1), false);
+      update(sweep, gains, losses);
+      assertPairsMatch(gains, { sweepPair(a, b) });
+      assertPairsMatch(losses, {});
+
+      //Two immobile objects can't collide
+      _clear(gains, losses);
+      setFilter(sweep, a, (1 << 0) | (1 << 1), true);
+      setFilter(sweep, b, 1 << 1, true);
+      update(sweep, gains, losses);
+      assertPairsMatch(gains, {});
+      assertPairsMatch(losses, { sweepPair(a, b) });
+
+      //Separating while filtered doesn't report a loss
+      _clear(gains, losses);
+      b.mNewBoundaryMin.x += 5.0f;
+      b.mNewBoundaryMax.x += 5.0f;
+      _reinsertOne(sweep, b, gains, losses);
+      assertPairsMatch(gains, {});
+      assertPairsMatch(losses, {});
+      Assert::IsTrue(sweep.pairs.trackedPairs.empty());
+
+      //Changing and reverting a filter within an update doesn't report anything
+      b.mNewBoundaryMin.x -= 5.0f;
+      b.mNewBoundaryMax.x -= 5.0f;
+      setFilter(sweep, b, 1 << 1, false);
+      _reinsertOne(sweep, b, gains, losses);
+      assertPairsMatch(gains, { sweepPair(a, b) });
+      _clear(gains, losses);
+      setFilter(sweep, b, 0, false);
+      setFilter(sweep, b, 1 << 1, false);
+      update(sweep, gains, losses);
+      assertPairsMatch(gains, {});
+      assertPairsMatch(losses, {});
+    }
+
+    TEST_METHOD(AABBTree_InsertMoveErase) {
+      TestTree tree;
+      SweepEntry a = createEntry(glm::vec2{ 0.0f }, glm::vec2{ 1.0f });
+      SweepEntry b = createEntry(glm::vec2{ 0.5f }, glm::vec2{ 1.5f });
+      SweepEntry c = createEntry(glm::vec2{ 5.0f }, glm::vec2{ 6.0f });
+      tree.insert(a);
+      tree.insert(b);
+      tree.insert(c);
+      tree.update();
+      assertPairsMatch(tree.gained, { sweepPair(a, b) });
+      assertPairsMatch(tree.lost, {});
+
+      //Nothing moved, nothing should change
+      tree.update();
+      assertPairsMatch(tree.gained, {});
+      assertPairsMatch(tree.lost, {});
+
+      //Move b over to c
+      b.mNewBoundaryMin = glm::vec2{ 5.5f };
+      b.mNewBoundaryMax = glm::vec2{ 6.5f };
+      tree.updateBoundaries(b);
+      tree.update();
+      assertPairsMatch(tree.gained, { sweepPair(b, c) });
+      assertPairsMatch(tree.lost, { sweepPair(a, b) });
+
+      //Touching on the boundary counts as overlapping
+      a.mNewBoundaryMin = glm::vec2{ 4.0f };
+      a.mNewBoundaryMax = glm::vec2{ 5.0f };
+      tree.updateBoundaries(a);
+      tree.update();
+      assertPairsMatch(tree.gained, { sweepPair(a, c) });
+      assertPairsMatch(tree.lost, {});
+
+      tree.erase(c);
+      tree.update();
+      assertPairsMatch(tree.gained, {});
+      assertPairsMatch(tree.lost, { sweepPair(a, c), sweepPair(b, c) });
+
+      //Removing both sides of a pair should only report it once
+      a.mNewBoundaryMax = glm::vec2{ 5.5f };
+      tree.updateBoundaries(a);
+      tree.update();
+      assertPairsMatch(tree.gained, { sweepPair(a, b) });
+      tree.erase(a);
+      tree.erase(b);
+      tree.update();
+      assertPairsMatch(tree.gained, {});
+      assertPairsMatch(tree.lost, { sweepPair(a, b) });
+      Assert::IsTrue(tree.tree.root == Broadphase::AABBTree::NONE);
+    }
+
+    TEST_METHOD(AABBTree_MarginAvoidsReinsertion) {
+      TestTree tree{ 0.5f };
+      SweepEntry a = createEntry(glm::vec2{ 0.0f }, glm::vec2{ 1.0f });
+      SweepEntry b = createEntry(glm::vec2{ 1.25f, 0.0f }, glm::vec2{ 2.25f, 1.0f });
+      tree.insert(a);
+      tree.insert(b);
+      tree.update();
+      //Fat bounds overlap even though the objects don't
+      assertPairsMatch(tree.gained, { sweepPair(a, b) });
+
+      const Broadphase::AABBTree::Node before = tree.tree.nodes[tree.tree.leaves[a.broadphaseKey.value]];
+      //Small movement within the margin doesn't change the tree or pairs
+      a.mNewBoundaryMin.x += 0.2f;
+      a.mNewBoundaryMax.x += 0.2f;
+      tree.updateBoundaries(a);
+      Assert::IsTrue(tree.tree.moved.empty());
+      const Broadphase::AABBTree::Node& after = tree.tree.nodes[tree.tree.leaves[a.broadphaseKey.value]];
+      Assert::IsTrue(before.min == after.min && before.max == after.max);
+      tree.update();
+      assertPairsMatch(tree.gained, {});
+      assertPairsMatch(tree.lost, {});
+
+      //Moving out of the margin reinserts it and loses the pair
+      a.mNewBoundaryMin.x -= 5.0f;
+      a.mNewBoundaryMax.x -= 5.0f;
+      tree.updateBoundaries(a);
+      tree.update();
+      assertPairsMatch(tree.gained, {});
+      assertPairsMatch(tree.lost, { sweepPair(a, b) });
+    }
+
+    struct BenchmarkScene {
+      BenchmarkScene(size_t count, unsigned seed)
+        : generator{ seed } {
+        entries.resize(count);
+        for(SweepEntry& entry : entries) {
+          entry.mKey = mappings.createKey();
+          entry.mNewBoundaryMin = randomPosition();
+          entry.mNewBoundaryMax = entry.mNewBoundaryMin + glm::vec2{ 1.0f };
+        }
+      }
+
+      glm::vec2 randomPosition() {
+        //Intentionally outside of the grid definition in some places to include objects in the boundary cells
+        std::uniform_real_distribution<float> pos(-120.0f, 120.0f);
+        return { pos(generator), pos(generator) };
+      }
+
+      void move() {
+        std::uniform_real_distribution<float> offset(-0.2f, 0.2f);
+        for(SweepEntry& entry : entries) {
+          const glm::vec2 o{ offset(generator), offset(generator) };
+          entry.mNewBoundaryMin += o;
+          entry.mNewBoundaryMax += o;
+        }
+      }
+
+      std::mt19937 generator;
+      std::vector<SweepEntry> entries;
+      StableElementMappings mappings;
+    };
+
+    static std::vector<Broadphase::SweepCollisionPair> bruteForcePairs(const std::vector<SweepEntry>& entries) {
+      std::vector<Broadphase::SweepCollisionPair> result;
+      for(size_t i = 0; i < entries.size(); ++i) {
+        for(size_t j = i + 1; j < entries.size(); ++j) {
+          const SweepEntry& a = entries[i];
+          const SweepEntry& b = entries[j];
+          if(a.mNewBoundaryMin.x <= b.mNewBoundaryMax.x && b.mNewBoundaryMin.x <= a.mNewBoundaryMax.x &&
+            a.mNewBoundaryMin.y <= b.mNewBoundaryMax.y && b.mNewBoundaryMin.y <= a.mNewBoundaryMax.y) {
+            result.emplace_back(a.mKey, b.mKey);
+          }
+        }
+      }
+      std::sort(result.begin(), result.end());
+      return result;
+    }
+
+    static std::vector<Broadphase::SweepCollisionPair> trackedPairs(const Broadphase::ObjectDB& db, const Broadphase::PairTracker& pairs) {
+      std::vector<Broadphase::SweepCollisionPair> result;
+      for(const auto& [pair, unused] : pairs.trackedPairs) {
+        result.emplace_back(db.userKey[pair.a.value], db.userKey[pair.b.value]);
+      }
+      std::sort(result.begin(), result.end());
+      return result;
+    }
+
+    static void updateGrid(Broadphase::SweepGrid::Grid& grid, std::vector<Broadphase::SweepKeyPair>& gains, std::vector<Broadphase::SweepKeyPair>& losses) {
+      std::vector<Broadphase::SweepCollisionPair> gained, lost;
+      Broadphase::SwapLog results{ gained, lost };
+      gains.clear();
+      losses.clear();
+      Broadphase::IntermediateLog log{ gains, losses };
+      if(grid.useSoA) {
+        for(Broadphase::SweepSoA::Sweep& cell : grid.soaCells) {
+          Broadphase::SweepSoA::recomputePairs(cell, grid.objects, log);
+        }
+      }
+      else {
+        for(Broadphase::Sweep2D& cell : grid.cells) {
+          Broadphase::SweepNPrune::recomputePairs(cell, grid.objects, grid.pairs, log);
+        }
+      }
+      Broadphase::logPendingRemovals(grid.objects, log, grid.pairs);
+      Broadphase::logChangedPairs(grid.objects, grid.pairs, Broadphase::ConstIntermediateLog{ gains, losses }, results);
+      Broadphase::processPendingRemovals(grid.objects);
+    }
+
+    struct SceneTimings {
+      std::chrono::nanoseconds tree{};
+      std::chrono::nanoseconds grid{};
+      std::chrono::nanoseconds soaGrid{};
+    };
+
+    static void initBenchmarkGrid(Broadphase::SweepGrid::Grid& grid, float margin, bool useSoA) {
+      grid.margin = margin;
+      grid.useSoA = useSoA;
+      grid.definition.bottomLeft = glm::vec2{ -100.0f };
+      grid.definition.cellSize = glm::vec2{ 20.0f };
+      grid.definition.cellsX = grid.definition.cellsY = 10;
+      Broadphase::SweepGrid::init(grid);
+    }
+
+    //Moves the same objects through a tree, a grid, and a grid of SweepSoA cells
+    //Optionally verifies the tree's pairs against brute force and the SweepSoA grid's against the Sweep2D grid
+    static SceneTimings runScene(size_t count, size_t frames, float treeMargin, float gridMargin, bool verify) {
+      BenchmarkScene scene{ count, 7 };
+      TestTree tree{ treeMargin };
+      Broadphase::SweepGrid::Grid grid, soaGrid;
+      initBenchmarkGrid(grid, gridMargin, false);
+      initBenchmarkGrid(soaGrid, gridMargin, true);
+
+      std::vector<Broadphase::UserKey> userKeys;
+      std::vector<Broadphase::BroadphaseKey> treeKeys(count), gridKeys(count), soaGridKeys(count);
+      for(const SweepEntry& entry : scene.entries) {
+        userKeys.push_back(entry.mKey);
+      }
+      Broadphase::AABBTree::insertRange(tree.tree, userKeys.data(), treeKeys.data(), count);
+      Broadphase::SweepGrid::insertRange(grid, userKeys.data(), gridKeys.data(), count);
+      Broadphase::SweepGrid::insertRange(soaGrid, userKeys.data(), soaGridKeys.data(), count);
+
+      std::vector<Broadphase::SweepKeyPair> gridGains, gridLosses;
+      SceneTimings result;
+      std::array<std::vector<float>, 4> bounds;
+      for(size_t frame = 0; frame < frames; ++frame) {
+        for(auto& b : bounds) {
+          b.clear();
+        }
+        for(const SweepEntry& entry : scene.entries) {
+          bounds[0].push_back(entry.mNewBoundaryMin.x);
+          bounds[1].push_back(entry.mNewBoundaryMax.x);
+          bounds[2].push_back(entry.mNewBoundaryMin.y);
+          bounds[3].push_back(entry.mNewBoundaryMax.y);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        Broadphase::AABBTree::updateBoundaries(tree.tree, bounds[0].data(), bounds[1].data(), bounds[2].data(), bounds[3].data(), treeKeys.data(), count);
+        tree.gained.clear();
+        tree.lost.clear();
+        Broadphase::SwapLog log{ tree.gained, tree.lost };
+        Broadphase::AABBTree::recomputePairs(tree.tree, log);
+        //Skip the first frame where everything is inserted
+        if(frame) {
+          result.tree += std::chrono::steady_clock::now() - start;
+        }
+
+        start = std::chrono::steady_clock::now();
+        Broadphase::SweepGrid::updateBoundaries(grid, bounds[0].data(), bounds[1].data(), bounds[2].data(), bounds[3].data(), gridKeys.data(), count);
+        updateGrid(grid, gridGains, gridLosses);
+        if(frame) {
+          result.grid += std::chrono::steady_clock::now() - start;
+        }
+
+        start = std::chrono::steady_clock::now();
+        Broadphase::SweepGrid::updateBoundaries(soaGrid, bounds[0].data(), bounds[1].data(), bounds[2].data(), bounds[3].data(), soaGridKeys.data(), count);
+        updateGrid(soaGrid, gridGains, gridLosses);
+        if(frame) {
+          result.soaGrid += std::chrono::steady_clock::now() - start;
+        }
+
+        if(verify) {
+          Assert::IsTrue(Broadphase::Debug::isValidTree(tree.tree));
+          Assert::IsTrue(trackedPairs(tree.tree.objects, tree.tree.pairs) == bruteForcePairs(scene.entries));
+          Assert::IsTrue(trackedPairs(soaGrid.objects, soaGrid.pairs) == trackedPairs(grid.objects, grid.pairs));
+        }
+
+        scene.move();
+      }
+      return result;
+    }
+
+    //Tree with no margin should track exactly the overlapping pairs
+    TEST_METHOD(AABBTree_MatchesBruteForce) {
+      runScene(1000, 20, 0.0f, 0.0f, true);
+    }
+
+    //Objects move between cells so the SweepSoA cells have to keep pairs that are only dropped by one cell
+    TEST_METHOD(SweepSoAGrid_MatchesSweep2DGrid) {
+      runScene(1000, 20, 0.0f, 1.0f, true);
+    }
+
+    TEST_METHOD(AABBTree_BenchmarkAgainstGrid) {
+      constexpr size_t COUNT = 10000;
+      constexpr size_t FRAMES = 30;
+      const float margin = Broadphase::AABBTree::Tree{}.margin;
+      const SceneTimings timings = runScene(COUNT, FRAMES, margin, 0.0f, false);
+      const SceneTimings fatGrid = runScene(COUNT, FRAMES, margin, margin, false);
+      Logger::WriteMessage(std::format("Broadphase {} objects average frame: tree {}us grid {}us grid with margin {}us SweepSoA grid {}us SweepSoA grid with margin {}us\n",
+        COUNT,
+        std::chrono::duration_cast<std::chrono::microseconds>(timings.tree).count() / (FRAMES - 1),
+        std::chrono::duration_cast<std::chrono::microseconds>(timings.grid).count() / (FRAMES - 1),
+        std::chrono::duration_cast<std::chrono::microseconds>(fatGrid.grid).count() / (FRAMES - 1),
+        std::chrono::duration_cast<std::chrono::microseconds>(timings.soaGrid).count() / (FRAMES - 1),
+        std::chrono::duration_cast<std::chrono::microseconds>(fatGrid.soaGrid).count() / (FRAMES - 1)
+      ).c_str());
+    }
+    //Inserts the objects into a grid then erases every other one at once, returning the time to process the removals
+    static std::chrono::nanoseconds runMassRemoval(size_t count, bool verify) {
+      BenchmarkScene scene{ count, 11 };
+      Broadphase::SweepGrid::Grid grid;
+      //Smaller cells than the other benchmarks to keep the initial insertion sorting reasonable for large counts
+      grid.definition.bottomLeft = glm::vec2{ -100.0f };
+      grid.definition.cellSize = glm::vec2{ 5.0f };
+      grid.definition.cellsX = grid.definition.cellsY = 40;
+      Broadphase::SweepGrid::init(grid);
+
+      std::vector<Broadphase::UserKey> userKeys;
+      std::vector<Broadphase::BroadphaseKey> keys(count);
+      std::array<std::vector<float>, 4> bounds;
+      for(const SweepEntry& entry : scene.entries) {
+        userKeys.push_back(entry.mKey);
+        bounds[0].push_back(entry.mNewBoundaryMin.x);
+        bounds[1].push_back(entry.mNewBoundaryMax.x);
+        bounds[2].push_back(entry.mNewBoundaryMin.y);
+        bounds[3].push_back(entry.mNewBoundaryMax.y);
+      }
+      Broadphase::SweepGrid::insertRange(grid, userKeys.data(), keys.data(), count);
+      Broadphase::SweepGrid::updateBoundaries(grid, bounds[0].data(), bounds[1].data(), bounds[2].data(), bounds[3].data(), keys.data(), count);
+      std::vector<Broadphase::SweepKeyPair> gains, losses;
+      updateGrid(grid, gains, losses);
+
+      std::vector<Broadphase::BroadphaseKey> toRemove;
+      std::vector<SweepEntry> remaining;
+      for(size_t i = 0; i < count; ++i) {
+        if(i % 2) {
+          toRemove.push_back(keys[i]);
+        }
+        else {
+          remaining.push_back(scene.entries[i]);
+        }
+      }
+      const auto start = std::chrono::steady_clock::now();
+      Broadphase::SweepGrid::eraseRange(grid, toRemove.data(), toRemove.size());
+      updateGrid(grid, gains, losses);
+      const std::chrono::nanoseconds result = std::chrono::steady_clock::now() - start;
+
+      if(verify) {
+        Assert::IsTrue(trackedPairs(grid.objects, grid.pairs) == bruteForcePairs(remaining));
+        std::sort(grid.objects.freeList.begin(), grid.objects.freeList.end());
+        Assert::IsTrue(grid.objects.freeList == toRemove);
+      }
+      return result;
+    }
+
+    TEST_METHOD(SweepGrid_MassRemoval) {
+      const std::chrono::nanoseconds small = runMassRemoval(10000, true);
+      const std::chrono::nanoseconds large = runMassRemoval(100000, false);
+      Logger::WriteMessage(std::format("Broadphase removal of half of the objects: 10000 objects {}us 100000 objects {}us\n",
+        std::chrono::duration_cast<std::chrono::microseconds>(small).count(),
+        std::chrono::duration_cast<std::chrono::microseconds>(large).count()
+      ).c_str());
+    }
+
+    TEST_METHOD(PendingRemovals_DuplicateErase) {
+      Broadphase::SweepGrid::Grid grid;
+      grid.definition.cellSize = glm::vec2{ 10.0f };
+      grid.definition.cellsX = grid.definition.cellsY = 1;
+      Broadphase::SweepGrid::init(grid);
+      StableElementMappings mappings;
+      SweepEntry a = createEntry(glm::vec2{ 0.0f }, glm::vec2{ 1.0f });
+      SweepEntry b = createEntry(glm::vec2{ 0.5f }, glm::vec2{ 1.5f });
+      a.mKey = mappings.createKey();
+      b.mKey = mappings.createKey();
+      Broadphase::SweepGrid::insertRange(grid, &a.mKey, &a.broadphaseKey, 1);
+      Broadphase::SweepGrid::insertRange(grid, &b.mKey, &b.broadphaseKey, 1);
+      Broadphase::SweepGrid::updateBoundaries(grid, &a.mNewBoundaryMin.x, &a.mNewBoundaryMax.x, &a.mNewBoundaryMin.y, &a.mNewBoundaryMax.y, &a.broadphaseKey, 1);
+      Broadphase::SweepGrid::updateBoundaries(grid, &b.mNewBoundaryMin.x, &b.mNewBoundaryMax.x, &b.mNewBoundaryMin.y, &b.mNewBoundaryMax.y, &b.broadphaseKey, 1);
+      std::vector<Broadphase::SweepKeyPair> gains, losses;
+      updateGrid(grid, gains, losses);
+      Assert::AreEqual(size_t(1), grid.pairs.trackedPairs.size());
+
+      //Erasing both, with one of them twice, should lose the pair once and free each key once
+      const std::array<Broadphase::BroadphaseKey, 3> toRemove{ a.broadphaseKey, b.broadphaseKey, a.broadphaseKey };
+      Broadphase::SweepGrid::eraseRange(grid, toRemove.data(), toRemove.size());
+      updateGrid(grid, gains, losses);
+      Assert::IsTrue(grid.pairs.trackedPairs.empty());
+      Assert::AreEqual(size_t(2), grid.objects.freeList.size());
+      Assert::IsTrue(grid.objects.freeList[0] != grid.objects.freeList[1]);
+    }
+
+    struct SweepTimings {
+      std::chrono::nanoseconds sweep2D{};
+      std::chrono::nanoseconds soa{};
+    };
+
+    //Moves the same objects through a single Sweep2D and a SweepSoA, erasing some halfway through
+    //Optionally verifies the SweepSoA's pairs against brute force
+    static SweepTimings runSweepScene(size_t count, size_t frames, bool verify) {
+      BenchmarkScene scene{ count, 13 };
+      TestSweep sweep;
+      Broadphase::ObjectDB soaObjects;
+      Broadphase::PairTracker soaPairs;
+      Broadphase::SweepSoA::Sweep soa;
+
+      std::vector<Broadphase::UserKey> userKeys;
+      std::vector<Broadphase::BroadphaseKey> sweepKeys(count), soaKeys(count);
+      for(const SweepEntry& entry : scene.entries) {
+        userKeys.push_back(entry.mKey);
+      }
+      Broadphase::insertRange(sweep.objects, userKeys.data(), sweepKeys.data(), count);
+      Broadphase::SweepNPrune::insertRange(sweep.sweep, sweepKeys.data(), count);
+      Broadphase::insertRange(soaObjects, userKeys.data(), soaKeys.data(), count);
+      Broadphase::SweepSoA::insertRange(soa, soaKeys.data(), count);
+
+      std::vector<Broadphase::SweepCollisionPair> gained, lost;
+      std::vector<Broadphase::SweepKeyPair> keyGains, keyLosses;
+      SweepTimings result;
+      std::array<std::vector<float>, 4> bounds;
+      for(size_t frame = 0; frame < frames; ++frame) {
+        if(frame == frames / 2) {
+          std::vector<Broadphase::BroadphaseKey> sweepRemove, soaRemove;
+          std::vector<SweepEntry> remaining;
+          std::vector<Broadphase::BroadphaseKey> remainingSweep, remainingSoA;
+          for(size_t i = 0; i < scene.entries.size(); ++i) {
+            if(i % 10) {
+              remaining.push_back(scene.entries[i]);
+              remainingSweep.push_back(sweepKeys[i]);
+              remainingSoA.push_back(soaKeys[i]);
+            }
+            else {
+              sweepRemove.push_back(sweepKeys[i]);
+              soaRemove.push_back(soaKeys[i]);
+            }
+          }
+          Broadphase::eraseRange(sweep.objects, sweepRemove.data(), sweepRemove.size());
+          Broadphase::eraseRange(soaObjects, soaRemove.data(), soaRemove.size());
+          scene.entries = std::move(remaining);
+          sweepKeys = std::move(remainingSweep);
+          soaKeys = std::move(remainingSoA);
+        }
+        const size_t size = scene.entries.size();
+        for(auto& b : bounds) {
+          b.clear();
+        }
+        for(const SweepEntry& entry : scene.entries) {
+          bounds[0].push_back(entry.mNewBoundaryMin.x);
+          bounds[1].push_back(entry.mNewBoundaryMax.x);
+          bounds[2].push_back(entry.mNewBoundaryMin.y);
+          bounds[3].push_back(entry.mNewBoundaryMax.y);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        Broadphase::updateBoundaries(sweep.objects, bounds[0].data(), bounds[1].data(), bounds[2].data(), bounds[3].data(), sweepKeys.data(), size);
+        gained.clear();
+        lost.clear();
+        Broadphase::SwapLog sweepLog{ gained, lost };
+        sweep.update(sweepLog);
+        //Skip the first frame where everything is inserted
+        if(frame) {
+          result.sweep2D += std::chrono::steady_clock::now() - start;
+        }
+
+        start = std::chrono::steady_clock::now();
+        Broadphase::updateBoundaries(soaObjects, bounds[0].data(), bounds[1].data(), bounds[2].data(), bounds[3].data(), soaKeys.data(), size);
+        gained.clear();
+        lost.clear();
+        keyGains.clear();
+        keyLosses.clear();
+        Broadphase::IntermediateLog log{ keyGains, keyLosses };
+        Broadphase::SwapLog soaLog{ gained, lost };
+        Broadphase::SweepSoA::recomputePairs(soa, soaObjects, log);
+        Broadphase::logPendingRemovals(soaObjects, log, soaPairs);
+        Broadphase::logChangedPairs(soaObjects, soaPairs, Broadphase::ConstIntermediateLog{ keyGains, keyLosses }, soaLog);
+        Broadphase::processPendingRemovals(soaObjects);
+        if(frame) {
+          result.soa += std::chrono::steady_clock::now() - start;
+        }
+
+        if(verify) {
+          Assert::IsTrue(trackedPairs(soaObjects, soaPairs) == bruteForcePairs(scene.entries));
+        }
+
+        scene.move();
+      }
+      return result;
+    }
+
+    TEST_METHOD(SweepSoA_MatchesBruteForce) {
+      runSweepScene(1000, 20, true);
+    }
+
+    TEST_METHOD(SweepSoA_BenchmarkAgainstSweep2D) {
+      constexpr size_t COUNT = 10000;
+      constexpr size_t FRAMES = 30;
+      const SweepTimings timings = runSweepScene(COUNT, FRAMES, false);
+      Logger::WriteMessage(std::format("Single sweep {} objects average frame: Sweep2D {}us SweepSoA {}us\n",
+        COUNT,
+        std::chrono::duration_cast<std::chrono::microseconds>(timings.sweep2D).count() / (FRAMES - 1),
+        std::chrono::duration_cast<std::chrono::microseconds>(timings.soa).count() / (FRAMES - 1)
+      ).c_str());
+    }
+
+    struct TestGrid {
+      TestGrid(float margin, float predictionFrames) {
+        grid.definition.cellSize = glm::vec2{ 10.0f };
+        grid.definition.cellsX = grid.definition.cellsY = 1;
+        grid.margin = margin;
+        grid.predictionFrames = predictionFrames;
+        Broadphase::SweepGrid::init(grid);
+      }
+
+      void insert(SweepEntry& entry) {
+        entry.mKey = mappings.createKey();
+        Broadphase::SweepGrid::insertRange(grid, &entry.mKey, &entry.broadphaseKey, 1);
+        updateBoundaries(entry);
+      }
+
+      void updateBoundaries(const SweepEntry& entry) {
+        Broadphase::SweepGrid::updateBoundaries(grid, &entry.mNewBoundaryMin.x, &entry.mNewBoundaryMax.x, &entry.mNewBoundaryMin.y, &entry.mNewBoundaryMax.y, &entry.broadphaseKey, 1);
+      }
+
+      void update() {
+        std::vector<Broadphase::SweepCollisionPair> g, l;
+        Broadphase::SwapLog log{ g, l };
+        gains.clear();
+        losses.clear();
+        Broadphase::IntermediateLog temp{ keyGains, keyLosses };
+        keyGains.clear();
+        keyLosses.clear();
+        Broadphase::SweepNPrune::recomputePairs(grid.cells[0], grid.objects, grid.pairs, temp);
+        Broadphase::logPendingRemovals(grid.objects, temp, grid.pairs);
+        Broadphase::logChangedPairs(grid.objects, grid.pairs, Broadphase::ConstIntermediateLog{ keyGains, keyLosses }, log);
+        Broadphase::processPendingRemovals(grid.objects);
+        gains = std::move(g);
+        losses = std::move(l);
+      }
+
+      std::pair<float, float> boundsX(const SweepEntry& entry) const {
+        return grid.objects.bounds[0][entry.broadphaseKey.value];
+      }
+
+      Broadphase::SweepGrid::Grid grid;
+      StableElementMappings mappings;
+      std::vector<Broadphase::SweepKeyPair> keyGains, keyLosses;
+      std::vector<Broadphase::SweepCollisionPair> gains, losses;
+    };
+
+    TEST_METHOD(SweepGrid_FatBounds_SkipSmallMovements) {
+      TestGrid grid{ 0.5f, 0.0f };
+      SweepEntry a = createEntry(glm::vec2{ 0.0f }, glm::vec2{ 1.0f });
+      SweepEntry b = createEntry(glm::vec2{ 1.5f, 0.0f }, glm::vec2{ 2.5f, 1.0f });
+      grid.insert(a);
+      grid.insert(b);
+      grid.update();
+      //Fat bounds touch even though the objects don't
+      assertPairsMatch(grid.gains, { sweepPair(a, b) });
+      Assert::IsTrue(grid.boundsX(a) == std::make_pair(-0.5f, 1.5f));
+
+      //Movement within the margin leaves the bounds seen by the sweep axes alone
+      a.mNewBoundaryMin.x += 0.25f;
+      a.mNewBoundaryMax.x += 0.25f;
+      grid.updateBoundaries(a);
+      Assert::IsTrue(grid.boundsX(a) == std::make_pair(-0.5f, 1.5f));
+      grid.update();
+      assertPairsMatch(grid.gains, {});
+      assertPairsMatch(grid.losses, {});
+
+      //Escaping the margin updates them
+      a.mNewBoundaryMin.x -= 5.0f;
+      a.mNewBoundaryMax.x -= 5.0f;
+      grid.updateBoundaries(a);
+      Assert::IsTrue(grid.boundsX(a) == std::make_pair(-5.25f, -3.25f));
+      grid.update();
+      assertPairsMatch(grid.gains, {});
+      assertPairsMatch(grid.losses, { sweepPair(a, b) });
+    }
+
+    TEST_METHOD(SweepGrid_PredictiveBounds_ExtendTowardsMovement) {
+      TestGrid grid{ 0.0f, 2.0f };
+      SweepEntry a = createEntry(glm::vec2{ 0.0f }, glm::vec2{ 1.0f });
+      SweepEntry b = createEntry(glm::vec2{ 2.25f, 0.0f }, glm::vec2{ 3.25f, 1.0f });
+      grid.insert(a);
+      grid.insert(b);
+      grid.update();
+      assertPairsMatch(grid.gains, {});
+
+      //Moving right by 0.5 predicts another 1.0 to the right, reaching b before the object itself does
+      a.mNewBoundaryMin.x += 0.5f;
+      a.mNewBoundaryMax.x += 0.5f;
+      grid.updateBoundaries(a);
+      Assert::IsTrue(grid.boundsX(a) == std::make_pair(0.5f, 2.5f));
+      grid.update();
+      assertPairsMatch(grid.gains, { sweepPair(a, b) });
+
+      //Stopping shrinks the bounds back down and loses the pair
+      grid.updateBoundaries(a);
+      Assert::IsTrue(grid.boundsX(a) == std::make_pair(0.5f, 1.5f));
+      grid.update();
+      assertPairsMatch(grid.losses, { sweepPair(a, b) });
+    }
   };
 }
\ No newline at end of file
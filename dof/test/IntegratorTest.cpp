@@ -0,0 +1,120 @@
+#include "Precompile.h"
+#include "CppUnitTest.h"
+
+#include "AppBuilder.h"
+#include "Physics.h"
+#include <TestGame.h>
+#include <PhysicsTableBuilder.h>
+#include <math/AxisFlags.h>
+#include <TableName.h>
+#include <generics/Container.h>
+#include <NotifyingTableModifier.h>
+#include <transform/TransformModule.h>
+#include <transform/TransformResolver.h>
+#include <random>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Test {
+  TEST_CLASS(IntegratorTest) {
+    static constexpr float E = 0.0001f;
+    struct BodyTag : TagRow {};
+
+    struct TestModule : IAppModule {
+      void createDatabase(RuntimeDatabaseArgs& args) final {
+        StorageTableBuilder table;
+        PhysicsTableBuilder::addVelocity(table, math::AxisFlags::XYZA());
+        PhysicsTableBuilder::addAcceleration(table, math::AxisFlags::XYZ());
+        Transform::addTransform25D(table);
+        table.setStable().addRows<BodyTag>().setTableName({ "bodies" });
+        table.finalize(args);
+      }
+    };
+
+    static Config::PhysicsConfig createConfig() {
+      Config::PhysicsConfig result;
+      result.linearDragMultiplier = 0.5f;
+      result.angularDragMultiplier = 0.25f;
+      return result;
+    }
+
+    TEST_METHOD(AccelerationAndDamping) {
+      TestGame game{
+        GameConstructArgs{
+          .physics = createConfig(),
+          .modules = gnx::Container::makeVector<std::unique_ptr<IAppModule>>(std::make_unique<TestModule>())
+        }
+      };
+      auto& task = game.builder();
+      const TableID table = task.query<BodyTag>()[0];
+      auto [vx, vy, vz, va, ax, ay, az] = task.query<VelX, VelY, VelZ, VelA, AccelX, AccelY, AccelZ>(table).get(0);
+      Transform::Resolver transforms{ task, Transform::ResolveOps{} };
+      ElementRef body;
+      {
+        NotifyingTableModifier modifier{ task, table };
+        body = *modifier.addElements(1);
+      }
+
+      vx->at(0) = 1.0f;
+      ax->at(0) = 1.0f;
+      vy->at(0) = -2.0f;
+      vz->at(0) = 1.0f;
+      az->at(0) = -0.5f;
+      va->at(0) = 0.4f;
+      game.update();
+
+      //Acceleration is added before damping and Z is never damped
+      Assert::AreEqual(1.0f, vx->at(0), E);
+      Assert::AreEqual(-1.0f, vy->at(0), E);
+      Assert::AreEqual(0.5f, vz->at(0), E);
+      Assert::AreEqual(0.1f, va->at(0), E);
+      const Transform::PackedTransform t = transforms.resolve(body);
+      Assert::AreEqual(1.0f, t.tx, E);
+      Assert::AreEqual(-1.0f, t.ty, E);
+      Assert::AreEqual(0.5f, t.tz, E);
+      Assert::AreEqual(0.1f, std::atan2(t.ay, t.ax), E);
+    }
+
+    //Acceleration and damping as two passes over the velocity compared to the fused pass
+    TEST_METHOD(FusedVelocity_Benchmark) {
+      constexpr size_t COUNT = 1 << 22;
+      constexpr size_t FRAMES = 20;
+      std::mt19937 gen{ 3 };
+      std::uniform_real_distribution<float> dist{ -1.0f, 1.0f };
+      std::vector<float> acceleration(COUNT), separate(COUNT), fused(COUNT);
+      for(size_t i = 0; i < COUNT; ++i) {
+        acceleration[i] = dist(gen);
+        separate[i] = fused[i] = dist(gen);
+      }
+
+      auto measure = [](auto&& fn) {
+        const auto begin = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < FRAMES; ++i) {
+          fn();
+        }
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin);
+      };
+      const auto separateTime = measure([&] {
+        Physics::integrateVelocityAxis(separate.data(), acceleration.data(), 1.0f, COUNT);
+        Physics::integrateVelocityAxis(separate.data(), nullptr, 0.96f, COUNT);
+      });
+      const auto fusedTime = measure([&] {
+        Physics::integrateVelocityAxis(fused.data(), acceleration.data(), 0.96f, COUNT);
+      });
+
+      for(size_t i = 0; i < COUNT; i += COUNT / 64) {
+        Assert::AreEqual(separate[i], fused[i], E);
+      }
+      //Separate reads and writes velocity twice plus reading acceleration once, fused reads and writes it once
+      const size_t rowBytes = COUNT*sizeof(float);
+      Logger::WriteMessage(std::format("{} velocities over {} frames: separate {}us ({}MB/frame) fused {}us ({}MB/frame)\n",
+        COUNT,
+        FRAMES,
+        separateTime.count(),
+        5*rowBytes / (1024*1024),
+        fusedTime.count(),
+        3*rowBytes / (1024*1024)
+      ).c_str());
+    }
+  };
+}
@@ -2,6 +2,7 @@
 #include "CppUnitTest.h"
 
 #include "IslandGraph.h"
+#include <random>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -512,6 +513,167 @@ namespace Test {
       }
     }
 
+    //Flood fill of the graph to compare against the islands
+    static std::vector<uint32_t> getConnectedNodes(const IslandGraph::Graph& graph, uint32_t root) {
+      std::vector<uint32_t> result{ root };
+      std::unordered_set<uint32_t> visited{ root };
+      for(size_t i = 0; i < result.size(); ++i) {
+        for(uint32_t entry = graph.nodes[result[i]].edges; entry != IslandGraph::INVALID; entry = graph.edgeEntries[entry].nextEntry) {
+          const IslandGraph::Edge& edge = graph.edges[graph.edgeEntries[entry].edge];
+          const uint32_t other = edge.nodeA == result[i] ? edge.nodeB : edge.nodeA;
+          if(graph.nodes[other].propagation && visited.insert(other).second) {
+            result.push_back(other);
+          }
+        }
+      }
+      return result;
+    }
+
+    static void assertIslandsMatchConnectivity(IslandGraph::Graph& graph) {
+      for(uint32_t i = 0; i < graph.nodes.addressableSize(); ++i) {
+        if(!graph.nodes.isValid(i) || !graph.nodes[i].propagation) {
+          continue;
+        }
+        const std::vector<uint32_t> connected = getConnectedNodes(graph, i);
+        const IslandGraph::Island& island = graph.islands[graph.nodes[i].islandIndex];
+        Assert::AreEqual(static_cast<uint32_t>(connected.size()), island.nodeCount, L"Island should contain exactly the connected nodes");
+        for(uint32_t n : connected) {
+          Assert::AreEqual(graph.nodes[i].islandIndex, graph.nodes[n].islandIndex);
+        }
+      }
+    }
+
+    TEST_METHOD(RandomChanges_MatchConnectivity) {
+      IslandGraph::Graph graph;
+      Keygen gen;
+      std::mt19937 random{ 5 };
+      std::vector<IslandGraph::NodeUserdata> nodes;
+      std::vector<std::pair<IslandGraph::NodeUserdata, IslandGraph::NodeUserdata>> edges;
+      auto pick = [&random](size_t size) {
+        return std::uniform_int_distribution<size_t>{ 0, size - 1 }(random);
+      };
+      for(int frame = 0; frame < 200; ++frame) {
+        for(int change = 0; change < 20; ++change) {
+          switch(pick(8)) {
+            case 0:
+            case 1: {
+              nodes.push_back(gen);
+              IslandGraph::addNode(graph, nodes.back(), pick(8) ? IslandGraph::PROPAGATE_ALL : IslandGraph::PROPAGATE_NONE);
+              break;
+            }
+            case 2: {
+              if(nodes.size()) {
+                const size_t i = pick(nodes.size());
+                IslandGraph::removeNode(graph, nodes[i]);
+                std::erase_if(edges, [&](const auto& e) { return e.first == nodes[i] || e.second == nodes[i]; });
+                nodes.erase(nodes.begin() + i);
+              }
+              break;
+            }
+            case 3:
+            case 4:
+            case 5: {
+              if(nodes.size() > 1) {
+                const IslandGraph::NodeUserdata a = nodes[pick(nodes.size())];
+                const IslandGraph::NodeUserdata b = nodes[pick(nodes.size())];
+                if(a != b && graph.findEdge(a, b) == graph.edgesEnd()) {
+                  IslandGraph::addEdge(graph, a, b, gen.genEdge());
+                  edges.emplace_back(a, b);
+                }
+              }
+              break;
+            }
+            case 6: {
+              if(edges.size()) {
+                const size_t i = pick(edges.size());
+                IslandGraph::removeEdge(graph, edges[i].first, edges[i].second);
+                edges.erase(edges.begin() + i);
+              }
+              break;
+            }
+            case 7: {
+              if(nodes.size()) {
+                IslandGraph::setPropagation(graph, graph.findNode(nodes[pick(nodes.size())]), IslandGraph::PropagationOps{
+                  pick(2) ? IslandGraph::PROPAGATE_ALL : IslandGraph::PROPAGATE_NONE
+                });
+              }
+              break;
+            }
+          }
+        }
+        rebuildIslands(graph);
+        assertIslandsMatchConnectivity(graph);
+      }
+    }
+
+    //Grid where each node is connected to its right and bottom neighbors
+    static std::vector<IslandGraph::NodeUserdata> createGrid(IslandGraph::Graph& graph, Keygen& gen, size_t size) {
+      std::vector<IslandGraph::NodeUserdata> nodes;
+      for(size_t i = 0; i < size*size; ++i) {
+        nodes.push_back(gen);
+        IslandGraph::addNode(graph, nodes.back());
+      }
+      for(size_t y = 0; y < size; ++y) {
+        for(size_t x = 0; x < size; ++x) {
+          if(x + 1 < size) {
+            IslandGraph::addEdge(graph, nodes[x + y*size], nodes[x + 1 + y*size], gen.genEdge());
+          }
+          if(y + 1 < size) {
+            IslandGraph::addEdge(graph, nodes[x + y*size], nodes[x + (y + 1)*size], gen.genEdge());
+          }
+        }
+      }
+      return nodes;
+    }
+
+    static std::chrono::nanoseconds timeRebuild(IslandGraph::Graph& graph) {
+      const auto start = std::chrono::steady_clock::now();
+      IslandGraph::rebuildIslands(graph);
+      return std::chrono::steady_clock::now() - start;
+    }
+
+    static size_t countIslands(IslandGraph::Graph& graph) {
+      return static_cast<size_t>(std::count_if(graph.begin(), graph.end(), [](const IslandGraph::Island& island) { return island.size() > 0; }));
+    }
+
+    TEST_METHOD(LargeIsland_RemovalTiming) {
+      constexpr size_t SIZE = 200;
+      IslandGraph::Graph graph;
+      Keygen gen;
+      const std::vector<IslandGraph::NodeUserdata> nodes = createGrid(graph, gen, SIZE);
+      const auto build = timeRebuild(graph);
+      Assert::AreEqual(size_t(1), countIslands(graph));
+
+      //Losing a contact in the middle doesn't split anything and the searches meet around it
+      IslandGraph::removeEdge(graph, nodes[SIZE/2 + (SIZE/2)*SIZE], nodes[SIZE/2 + 1 + (SIZE/2)*SIZE]);
+      const auto noSplit = timeRebuild(graph);
+      Assert::AreEqual(size_t(1), countIslands(graph));
+
+      //Cutting off the corner only needs to search the corner
+      IslandGraph::removeEdge(graph, nodes[0], nodes[1]);
+      IslandGraph::removeEdge(graph, nodes[0], nodes[SIZE]);
+      const auto splitCorner = timeRebuild(graph);
+      Assert::AreEqual(size_t(2), countIslands(graph));
+      Assert::AreEqual(uint32_t(1), graph.islands[graph.nodes[graph.findNode(nodes[0]).node].islandIndex].size());
+
+      //Cutting the grid in half searches both halves until the smaller one runs out
+      for(size_t y = 0; y < SIZE; ++y) {
+        IslandGraph::removeEdge(graph, nodes[SIZE/4 + y*SIZE], nodes[SIZE/4 + 1 + y*SIZE]);
+      }
+      const auto splitQuarter = timeRebuild(graph);
+      Assert::AreEqual(size_t(3), countIslands(graph));
+      Assert::IsTrue(IslandGraph::Debug::validateIslands(graph));
+      assertIslandsMatchConnectivity(graph);
+
+      Logger::WriteMessage(std::format("Grid of {} nodes: build {}us, removal without split {}us, corner split {}us, quarter split {}us\n",
+        SIZE*SIZE,
+        std::chrono::duration_cast<std::chrono::microseconds>(build).count(),
+        std::chrono::duration_cast<std::chrono::microseconds>(noSplit).count(),
+        std::chrono::duration_cast<std::chrono::microseconds>(splitCorner).count(),
+        std::chrono::duration_cast<std::chrono::microseconds>(splitQuarter).count()
+      ).c_str());
+    }
+
     TEST_METHOD(NodeReuse) {
       Keygen gen;
       const IslandGraph::NodeUserdata one{ gen };
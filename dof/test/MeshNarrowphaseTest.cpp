@@ -4,8 +4,10 @@
 #include <MeshNarrowphase.h>
 #include <glm/vec2.hpp>
 #include <shapes/ShapeRegistry.h>
+#include <shapes/TriangleBVH.h>
 #include <SpatialPairsStorage.h>
 #include <transform/Transform.h>
+#include <random>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -14,10 +16,15 @@ namespace Test {
     struct TestMesh {
       operator ShapeRegistry::Mesh() const {
         inverse = transform.inverse();
+        if(useNormals) {
+          Narrowphase::computeEdgeNormals(points, normals);
+        }
         return ShapeRegistry::Mesh{
           .modelToWorld = &transform,
           .worldToModel = &inverse,
           .points = points,
+          .normals = useNormals ? std::span<const glm::vec2>{ normals } : std::span<const glm::vec2>{},
+          .radius = radius
         };
       }
 
@@ -63,9 +70,20 @@ namespace Test {
         transform = Transform::PackedTransform::build(parts);
       }
 
+      void pushRegularPolygon(size_t verts, float radius) {
+        const float inc = Constants::TAU/static_cast<float>(verts);
+        for(size_t i = 0; i < verts; ++i) {
+          const float angle = static_cast<float>(i)*inc;
+          points.push_back(glm::vec2{ std::cos(angle), std::sin(angle) }*radius);
+        }
+      }
+
       std::vector<glm::vec2> points;
       Transform::PackedTransform transform;
       mutable Transform::PackedTransform inverse;
+      mutable std::vector<glm::vec2> normals;
+      bool useNormals{};
+      float radius{};
     };
 
     struct TestPair {
@@ -140,6 +158,31 @@ namespace Test {
       });
     }
 
+    //Collinear points make plateaus in the support search. B starts the search in the middle of its far side
+    TEST_METHOD(QuadQuad_CollinearPoints) {
+      TestPair pair;
+      const float s = 0.5f;
+      pair.a.pushQuad({}, glm::vec2{ s });
+      pair.b.points = {
+        glm::vec2{ -s, 0 },
+        glm::vec2{ -s, -s },
+        glm::vec2{ 0, -s },
+        glm::vec2{ s, -s },
+        glm::vec2{ s, 0 },
+        glm::vec2{ s, s },
+        glm::vec2{ 0, s },
+        glm::vec2{ -s, s }
+      };
+      pair.b.setPos(glm::vec2{ s*2.f - noCollisionSpace, 0.f });
+
+      pair.generateContacts();
+      Assert::IsTrue(pair.manifold.size > 0, L"Overlapping shapes should collide regardless of where the support search starts");
+      for(uint32_t i = 0; i < pair.manifold.size; ++i) {
+        Assert::AreEqual(1.0f, std::abs(pair.manifold[i].normal.x), 0.001f);
+        Assert::AreEqual(noCollisionSpace, pair.manifold[i].overlap, 0.001f);
+      }
+    }
+
     TEST_METHOD(TriTri) {
       TestPair pair;
       pair.a.pushRightTriangle({}, glm::vec2{ 1.f });
@@ -174,5 +217,115 @@ namespace Test {
         glm::vec2{ 0.722595f, 0.678174f }
       });
     }
+
+    TEST_METHOD(RoundedPointQuad) {
+      TestPair pair;
+      const float radius = 0.25f;
+      pair.a.pushQuad({}, glm::vec2{ 0.5f });
+      pair.b.points.push_back(glm::vec2{ 0 });
+      pair.b.radius = radius;
+
+      //Against the right face
+      pair.b.setPos(glm::vec2{ 0.7f, 0.0f });
+      pair.generateContactsAndAssertPoints({ glm::vec2{ 0.45f, 0.0f } });
+      Assert::AreEqual(0.05f, pair.manifold[0].overlap, 0.001f);
+      Assert::IsTrue(Geo::near(glm::vec2{ -1.0f, 0.0f }, pair.manifold[0].normal));
+
+      //Past the corner the normal points away from it rather than from the face
+      const float diagonal = 0.65f;
+      pair.b.setPos(glm::vec2{ diagonal });
+      pair.generateContacts();
+      Assert::AreEqual(uint32_t{ 1 }, pair.manifold.size);
+      const float cornerDistance = glm::length(glm::vec2{ diagonal - 0.5f });
+      Assert::AreEqual(radius - cornerDistance, pair.manifold[0].overlap, 0.001f);
+      Assert::IsTrue(Geo::near(-glm::normalize(glm::vec2{ 1.0f }), pair.manifold[0].normal));
+
+      //Within radius of both faces but not of the corner
+      pair.b.setPos(glm::vec2{ 0.7f });
+      pair.generateContactsAndAssertPoints({});
+
+      //Same when the point is A
+      std::swap(pair.a, pair.b);
+      pair.a.setPos(glm::vec2{ 0.7f, 0.0f });
+      pair.generateContacts();
+      Assert::AreEqual(uint32_t{ 1 }, pair.manifold.size);
+      Assert::AreEqual(0.05f, pair.manifold[0].overlap, 0.001f);
+      Assert::IsTrue(Geo::near(glm::vec2{ 1.0f, 0.0f }, pair.manifold[0].normal));
+    }
+
+    TEST_METHOD(CachedNormals_MatchComputed) {
+      std::mt19937 gen{ 5 };
+      std::uniform_real_distribution<float> pos{ -2.0f, 2.0f };
+      std::uniform_real_distribution<float> rot{ 0.0f, Constants::TAU };
+      std::uniform_real_distribution<float> scale{ 0.5f, 2.0f };
+      std::uniform_int_distribution<size_t> verts{ 3, 12 };
+      auto randomize = [&](TestMesh& m) {
+        m.points.clear();
+        m.pushRegularPolygon(verts(gen), 1.0f);
+        m.setPos(glm::vec2{ pos(gen), pos(gen) });
+        m.setRot(rot(gen));
+        m.setScale(glm::vec2{ scale(gen), scale(gen) });
+      };
+      for(size_t i = 0; i < 1000; ++i) {
+        TestPair pair;
+        randomize(pair.a);
+        randomize(pair.b);
+        pair.generateContacts();
+        const SP::ContactManifold computed = pair.manifold;
+        pair.a.useNormals = pair.b.useNormals = true;
+        pair.generateContacts();
+
+        Assert::AreEqual(computed.size, pair.manifold.size);
+        for(uint32_t p = 0; p < computed.size; ++p) {
+          Assert::IsTrue(Geo::near(computed[p].normal, pair.manifold[p].normal));
+          Assert::IsTrue(Geo::near(computed[p].centerToContactA, pair.manifold[p].centerToContactA));
+          Assert::AreEqual(computed[p].overlap, pair.manifold[p].overlap, 0.001f);
+        }
+      }
+    }
+
+    TEST_METHOD(TriangleBVH_QueryMatchesBruteForce) {
+      std::mt19937 gen{ 3 };
+      std::uniform_real_distribution<float> jitter{ -0.3f, 0.3f };
+      std::uniform_real_distribution<float> pos{ -1.0f, 21.0f };
+      std::uniform_real_distribution<float> size{ 0.1f, 3.0f };
+      //Grid of triangles with alternating winding and a degenerate one at the end
+      std::vector<glm::vec2> triangles;
+      for(int x = 0; x < 20; ++x) {
+        for(int y = 0; y < 20; ++y) {
+          glm::vec2 a{ x + jitter(gen), y + jitter(gen) };
+          glm::vec2 b{ x + 1 + jitter(gen), y + jitter(gen) };
+          glm::vec2 c{ x + 1 + jitter(gen), y + 1 + jitter(gen) };
+          if((x + y) % 2) {
+            std::swap(b, c);
+          }
+          triangles.insert(triangles.end(), { a, b, c });
+        }
+      }
+      triangles.insert(triangles.end(), { glm::vec2{ 0 }, glm::vec2{ 1 }, glm::vec2{ 2 } });
+
+      const Shapes::TriangleBVH bvh = Shapes::buildTriangleBVH(triangles);
+
+      Assert::AreEqual(size_t{ 400 }, bvh.triangleCount());
+      for(size_t i = 0; i < bvh.triangleCount(); ++i) {
+        const auto t = bvh.getTriangle(i);
+        Assert::IsTrue(Geo::cross(t[1] - t[0], t[2] - t[0]) > 0.0f, L"Triangles should be counterclockwise");
+      }
+      for(size_t q = 0; q < 1000; ++q) {
+        const glm::vec2 min{ pos(gen), pos(gen) };
+        const Geo::AABB bounds{ min, min + glm::vec2{ size(gen), size(gen) } };
+        std::vector<uint32_t> expected, actual;
+        for(uint32_t i = 0; i < bvh.triangleCount(); ++i) {
+          const auto t = bvh.getTriangle(i);
+          if(Geo::AABB::build({ t[0], t[1], t[2] }).overlaps(bounds)) {
+            expected.push_back(i);
+          }
+        }
+        bvh.query(bounds, [&](uint32_t i) { actual.push_back(i); });
+        std::sort(actual.begin(), actual.end());
+
+        Assert::IsTrue(expected == actual);
+      }
+    }
   };
 }
\ No newline at end of file
@@ -8,11 +8,13 @@
 #include "GameScheduler.h"
 #include "SpatialPairsStorage.h"
 #include "TableAdapters.h"
+#include "config/Config.h"
 #include <math/Geometric.h>
 #include "TestApp.h"
 #include "Physics.h"
 #include "Clip.h"
 #include "BoxBox.h"
+#include "NarrowphaseBatch.h"
 #include "shapes/ShapeRegistry.h"
 #include "shapes/Rectangle.h"
 #include "shapes/Circle.h"
@@ -28,6 +30,7 @@
 #include <PhysicsTableBuilder.h>
 #include <Game.h>
 #include <generics/Container.h>
+#include <random>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -275,6 +278,125 @@ namespace Test {
       Assert::AreEqual(uint32_t{ 0 }, manifold.size);
     }
 
+    TEST_METHOD(ManifoldReuse) {
+      NarrowphaseDB db;
+      auto& task = db.builder();
+      NarrowphaseTableIds tables{ task };
+      NotifyingTableModifier modifier{ task, tables.circles };
+      const ElementRef* ref = modifier.addElements(2);
+      auto [stable, mask, circles, transforms] = task.query<
+        StableIDRow,
+        Narrowphase::CollisionMaskRow,
+        Shapes::CircleRow,
+        Transform::WorldTransformRow
+      >(tables.circles).get(0);
+      Config::PhysicsConfig* config = TableAdapters::getPhysicsConfigMutable(task);
+      const SP::ManifoldCacheStats* stats = task.query<const SP::ManifoldCacheStatsRow>().tryGetSingletonElement();
+      auto queries = SpatialQuery::createReader(task);
+      const size_t a = ref->getMapping()->getElementIndex();
+      const size_t b = (ref + 1)->getMapping()->getElementIndex();
+      mask->at(a) = mask->at(b) = 1;
+      Transform::PackedTransform& transformA = transforms->at(a);
+      Transform::PackedTransform& transformB = transforms->at(b);
+      auto getABManifold = [&] {
+        return getManifold(*queries, stable->at(a), stable->at(b));
+      };
+      auto assertManifoldEq = [](const SP::ContactManifold& expected, const SP::ContactManifold& actual) {
+        Assert::AreEqual(expected.size, actual.size);
+        for(uint32_t i = 0; i < expected.size; ++i) {
+          assertEq(expected[i].normal, actual[i].normal);
+          assertEq(expected[i].centerToContactA, actual[i].centerToContactA);
+          assertEq(expected[i].centerToContactB, actual[i].centerToContactB);
+          Assert::AreEqual(expected[i].overlap, actual[i].overlap, E);
+        }
+      };
+      config->manifoldReuseTolerance = 0.001f;
+      transformA = Shapes::toTransform(ShapeRegistry::Circle{ .pos = { 1, 2 }, .radius = 1.0f });
+      transformB = Shapes::toTransform(ShapeRegistry::Circle{ .pos = { 3.5f, 2.5f }, .radius = 2.0f });
+      db.update();
+      db.doNarrowphase();
+      Assert::AreEqual(uint32_t{ 1 }, getABManifold().size);
+
+      //Move and rotate the pair together, the cached manifold should be used and match what would have been generated
+      const Transform::PackedTransform move = Transform::PackedTransform::build(Transform::Parts{
+        .rot = glm::normalize(glm::vec2{ 1, 1 }),
+        .translate = glm::vec3{ 5, -3, 0 }
+      });
+      transformA = move * transformA;
+      transformB = move * transformB;
+      db.doNarrowphase();
+      const SP::ContactManifold reused = getABManifold();
+      Assert::AreEqual(uint32_t{ 1 }, stats->reused.load());
+      Assert::AreEqual(uint32_t{ 0 }, stats->generated.load());
+
+      config->manifoldReuseTolerance = 0.0f;
+      db.doNarrowphase();
+      Assert::AreEqual(uint32_t{ 0 }, stats->reused.load());
+      Assert::AreEqual(uint32_t{ 1 }, stats->generated.load());
+      assertManifoldEq(getABManifold(), reused);
+
+      //Relative motion past the tolerance regenerates
+      config->manifoldReuseTolerance = 0.001f;
+      transformB.tx += 0.1f;
+      db.doNarrowphase();
+      Assert::AreEqual(uint32_t{ 0 }, stats->reused.load());
+      Assert::AreEqual(uint32_t{ 1 }, stats->generated.load());
+    }
+
+    TEST_METHOD(ManifoldReuseNewPairInOldSlot) {
+      NarrowphaseDB db;
+      auto& task = db.builder();
+      NarrowphaseTableIds tables{ task };
+      NotifyingTableModifier modifier{ task, tables.circles };
+      const ElementRef* ref = modifier.addElements(3);
+      auto [stable, mask, transforms] = task.query<
+        StableIDRow,
+        Narrowphase::CollisionMaskRow,
+        Transform::WorldTransformRow
+      >(tables.circles).get(0);
+      auto [objA, objB] = task.query<SP::ObjA, SP::ObjB>().get(0);
+      Config::PhysicsConfig* config = TableAdapters::getPhysicsConfigMutable(task);
+      const SP::ManifoldCacheStats* stats = task.query<const SP::ManifoldCacheStatsRow>().tryGetSingletonElement();
+      auto queries = SpatialQuery::createReader(task);
+      const size_t a = ref->getMapping()->getElementIndex();
+      const size_t b = (ref + 1)->getMapping()->getElementIndex();
+      const size_t c = (ref + 2)->getMapping()->getElementIndex();
+      mask->at(a) = mask->at(b) = mask->at(c) = 1;
+      auto findSlot = [&](size_t l, size_t r) {
+        for(size_t i = 0; i < objA->size(); ++i) {
+          if((objA->at(i) == stable->at(l) && objB->at(i) == stable->at(r)) || (objA->at(i) == stable->at(r) && objB->at(i) == stable->at(l))) {
+            return i;
+          }
+        }
+        return objA->size();
+      };
+      config->manifoldReuseTolerance = 0.001f;
+      transforms->at(a) = Shapes::toTransform(ShapeRegistry::Circle{ .pos = { 1, 2 }, .radius = 1.0f });
+      transforms->at(b) = Shapes::toTransform(ShapeRegistry::Circle{ .pos = { 3.5f, 2.5f }, .radius = 2.0f });
+      transforms->at(c) = Shapes::toTransform(ShapeRegistry::Circle{ .pos = { 20, 20 }, .radius = 1.8f });
+      db.update();
+      const size_t slot = findSlot(a, b);
+      Assert::IsTrue(slot < objA->size());
+      Assert::AreEqual(uint32_t{ 1 }, getManifold(*queries, stable->at(a), stable->at(b)).size);
+
+      //Remove the pair then put a different shape where the old one was so the new pair takes over the same slot
+      transforms->at(b) = Shapes::toTransform(ShapeRegistry::Circle{ .pos = { -20, -20 }, .radius = 2.0f });
+      db.update();
+      db.update();
+      Assert::AreEqual(objA->size(), findSlot(a, b));
+      transforms->at(c) = Shapes::toTransform(ShapeRegistry::Circle{ .pos = { 3.5f, 2.5f }, .radius = 1.8f });
+      db.update();
+      Assert::AreEqual(slot, findSlot(a, c));
+
+      //The previous pair's manifold must not be reused even though the slot is the same
+      Assert::AreEqual(uint32_t{ 0 }, stats->reused.load());
+      Assert::AreEqual(uint32_t{ 1 }, stats->generated.load());
+      const SP::ContactManifold manifold = getManifold(*queries, stable->at(a), stable->at(c));
+      Assert::AreEqual(uint32_t{ 1 }, manifold.size);
+      //Distance between centers is sqrt(2.5^2 + 0.5^2) and the radii add up to 2.8, the old pair would have had 3
+      Assert::AreEqual(2.8f - std::sqrt(6.5f), manifold[0].overlap, E);
+    }
+
     static void assertHasPoints(const SP::ContactManifold& manifold, std::initializer_list<SP::ContactPoint> expected) {
       Assert::AreEqual(static_cast<uint32_t>(expected.size()), manifold.size);
       for(auto&& e : expected) {
@@ -935,5 +1057,107 @@ namespace Test {
         }
       }
     }
+
+    static void assertManifoldsMatch(const SP::ContactManifold& expected, const SP::ContactManifold& actual) {
+      Assert::AreEqual(expected.size, actual.size);
+      for(uint32_t i = 0; i < expected.size; ++i) {
+        Assert::IsTrue(Geo::near(expected[i].normal, actual[i].normal));
+        Assert::IsTrue(Geo::near(expected[i].centerToContactA, actual[i].centerToContactA));
+        Assert::IsTrue(Geo::near(expected[i].centerToContactB, actual[i].centerToContactB));
+        Assert::AreEqual(expected[i].overlap, actual[i].overlap, 0.001f);
+      }
+    }
+
+    static glm::vec2 randomRotation(std::mt19937& generator) {
+      const float angle = std::uniform_real_distribution<float>(0.0f, Constants::TAU)(generator);
+      return { std::cos(angle), std::sin(angle) };
+    }
+
+    struct BatchTimings {
+      std::chrono::nanoseconds perPair{};
+      std::chrono::nanoseconds batched{};
+    };
+
+    static BatchTimings compareBoxBoxBatch(size_t count, size_t seed) {
+      std::mt19937 generator(static_cast<uint32_t>(seed));
+      std::uniform_real_distribution<float> pos(-2.0f, 2.0f);
+      std::uniform_real_distribution<float> scale(0.1f, 1.5f);
+      std::vector<Narrowphase::BoxPair> pairs(count);
+      for(Narrowphase::BoxPair& pair : pairs) {
+        pair.a = { { pos(generator), pos(generator) }, randomRotation(generator), { scale(generator), scale(generator) } };
+        pair.b = { { pos(generator), pos(generator) }, randomRotation(generator), { scale(generator), scale(generator) } };
+      }
+      std::vector<SP::ContactManifold> expected(count), actual(count);
+      BatchTimings result;
+
+      auto start = std::chrono::steady_clock::now();
+      for(size_t i = 0; i < count; ++i) {
+        Narrowphase::boxBox(expected[i], pairs[i]);
+      }
+      result.perPair = std::chrono::steady_clock::now() - start;
+
+      start = std::chrono::steady_clock::now();
+      Narrowphase::BoxBoxBatch batch;
+      for(size_t i = 0; i < count; ++i) {
+        batch.push(pairs[i], actual[i]);
+      }
+      Narrowphase::generateContacts(batch);
+      result.batched = std::chrono::steady_clock::now() - start;
+
+      for(size_t i = 0; i < count; ++i) {
+        assertManifoldsMatch(expected[i], actual[i]);
+      }
+      return result;
+    }
+
+    static BatchTimings compareCircleCircleBatch(size_t count, size_t seed) {
+      std::mt19937 generator(static_cast<uint32_t>(seed));
+      std::uniform_real_distribution<float> pos(-2.0f, 2.0f);
+      std::uniform_real_distribution<float> radius(0.1f, 1.5f);
+      std::vector<std::pair<ShapeRegistry::Circle, ShapeRegistry::Circle>> pairs(count);
+      for(size_t i = 0; i < count; ++i) {
+        pairs[i].first = { { pos(generator), pos(generator) }, radius(generator) };
+        pairs[i].second = { { pos(generator), pos(generator) }, radius(generator) };
+        //Include some that are exactly on top of each-other
+        if(i % 50 == 0) {
+          pairs[i].second.pos = pairs[i].first.pos;
+        }
+      }
+      std::vector<SP::ContactManifold> expected(count), actual(count);
+      BatchTimings result;
+
+      auto start = std::chrono::steady_clock::now();
+      for(size_t i = 0; i < count; ++i) {
+        Narrowphase::circleCircle(expected[i], pairs[i].first, pairs[i].second);
+      }
+      result.perPair = std::chrono::steady_clock::now() - start;
+
+      start = std::chrono::steady_clock::now();
+      Narrowphase::CircleCircleBatch batch;
+      for(size_t i = 0; i < count; ++i) {
+        batch.push(pairs[i].first, pairs[i].second, actual[i]);
+      }
+      Narrowphase::generateContacts(batch);
+      result.batched = std::chrono::steady_clock::now() - start;
+
+      for(size_t i = 0; i < count; ++i) {
+        assertManifoldsMatch(expected[i], actual[i]);
+      }
+      return result;
+    }
+
+    TEST_METHOD(BoxBoxBatch_MatchesPerPair) {
+      const BatchTimings timings = compareBoxBoxBatch(100000, 3);
+      Logger::WriteMessage(std::format("Box box per pair {}us batched {}us\n",
+        std::chrono::duration_cast<std::chrono::microseconds>(timings.perPair).count(),
+        std::chrono::duration_cast<std::chrono::microseconds>(timings.batched).count()).c_str());
+    }
+
+    TEST_METHOD(CircleCircleBatch_MatchesPerPair) {
+      const BatchTimings timings = compareCircleCircleBatch(100000, 5);
+      Logger::WriteMessage(std::format("Circle circle per pair {}us batched {}us\n",
+        std::chrono::duration_cast<std::chrono::microseconds>(timings.perPair).count(),
+        std::chrono::duration_cast<std::chrono::microseconds>(timings.batched).count()).c_str());
+    }
   };
 }
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "Precompile.h"
+#include "CppUnitTest.h"
+
+#include "RayPacket.h"
+#include "SpatialQueries.h"
+#include "TestGame.h"
+#include <math/Geometric.h>
+#include <transform/TransformRows.h>
+#include "glm/glm.hpp"
+#include <random>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Test {
+  TEST_CLASS(RayPacketTest) {
+    static constexpr float E = 0.0001f;
+
+    static void assertEq(const glm::vec2& l, const glm::vec2& r) {
+      Assert::AreEqual(l.x, r.x, E);
+      Assert::AreEqual(l.y, r.y, E);
+    }
+
+    TEST_METHOD(Box) {
+      RayPacket::Rays rays;
+      //Straight on from the left
+      rays.push_back({ -3, 0 }, { 2, 0 });
+      //Misses above
+      rays.push_back({ -3, 2 }, { 1, 0 });
+      //Starts inside
+      rays.push_back({ 0, 0 }, { 0, 1 });
+      //Points away
+      rays.push_back({ 0, -3 }, { 0, -1 });
+      //Down onto the top but too short to reach it
+      rays.push_back({ 0, 3 }, { 0, -1 });
+      RayPacket::Hits hits;
+      //Box 2 wide and 1 tall centered on the origin
+      RayPacket::intersectBox(rays, glm::vec2{ 0 }, glm::vec2{ 2, 0 }, glm::vec2{ 0, 1 }, 2.0f, hits);
+
+      Assert::IsTrue(hits.isHit(0));
+      Assert::AreEqual(1.0f, hits.tIn[0], E);
+      Assert::AreEqual(2.0f, hits.tOut[0], E);
+      assertEq({ -1, 0 }, glm::normalize(hits.getNormal(0)));
+
+      Assert::IsFalse(hits.isHit(1));
+
+      Assert::IsTrue(hits.isHit(2));
+      Assert::AreEqual(0.0f, hits.tIn[2], E);
+      Assert::AreEqual(0.5f, hits.tOut[2], E);
+
+      Assert::IsFalse(hits.isHit(3));
+      Assert::IsFalse(hits.isHit(4));
+    }
+
+    TEST_METHOD(RotatedBox) {
+      RayPacket::Rays rays;
+      rays.push_back({ 0, -5 }, { 0, 1 });
+      RayPacket::Hits hits;
+      //Unit square rotated 45 degrees, the bottom corner is at -sqrt(2)/2
+      const glm::vec2 right = glm::normalize(glm::vec2{ 1, 1 });
+      RayPacket::intersectBox(rays, glm::vec2{ 0 }, right, Geo::orthogonal(right), 10.0f, hits);
+
+      Assert::IsTrue(hits.isHit(0));
+      const float corner = std::sqrt(2.0f)*0.5f;
+      Assert::AreEqual(5.0f - corner, hits.tIn[0], E);
+      Assert::AreEqual(5.0f + corner, hits.tOut[0], E);
+      //Entered on one of the bottom faces
+      const glm::vec2 normal = glm::normalize(hits.getNormal(0));
+      Assert::IsTrue(normal.y < 0.0f);
+      Assert::AreEqual(corner, std::abs(normal.x), E);
+    }
+
+    TEST_METHOD(Circle) {
+      RayPacket::Rays rays;
+      rays.push_back({ 1, 5 }, { 0, -1 });
+      rays.push_back({ 3.5f, 5 }, { 0, -1 });
+      rays.push_back({ 1, 0.5f }, { 1, 0 });
+      RayPacket::Hits hits;
+      RayPacket::intersectCircle(rays, glm::vec2{ 1, 0 }, 2.0f, 10.0f, hits);
+
+      Assert::IsTrue(hits.isHit(0));
+      Assert::AreEqual(3.0f, hits.tIn[0], E);
+      Assert::AreEqual(7.0f, hits.tOut[0], E);
+      assertEq({ 0, 1 }, glm::normalize(hits.getNormal(0)));
+
+      Assert::IsFalse(hits.isHit(1));
+
+      Assert::IsTrue(hits.isHit(2));
+      Assert::AreEqual(0.0f, hits.tIn[2], E);
+    }
+
+    //Batched raycasts against casting the same rays one at a time, both through the immediate queries of a scene
+    //populated with fragments so the timings include broadphase traversal as well as the shape tests
+    TEST_METHOD(RayPacket_Benchmark) {
+      constexpr size_t FRAMES = 5;
+      constexpr size_t SIDE = 20;
+      constexpr float SPACING = 2.0f;
+      GameArgs args;
+      args.fragmentCount = SIDE*SIDE;
+      TestGame game{ args };
+      Transform::WorldTransformRow& transforms = game.builder().query<Transform::WorldTransformRow>(game.tables.fragments).get<0>(0);
+      Assert::AreEqual(SIDE*SIDE, transforms.size());
+      for(size_t i = 0; i < transforms.size(); ++i) {
+        transforms.at(i).setPos(glm::vec2{ static_cast<float>(i % SIDE), static_cast<float>(i / SIDE) }*SPACING);
+      }
+      game.update();
+      game.update();
+
+      const Narrowphase::CollisionMask all = Narrowphase::CollisionMask(~0);
+      auto immediate = SpatialQuery::createImmediate(game.builder());
+      std::mt19937 gen{ 5 };
+      const float extent = static_cast<float>(SIDE)*SPACING;
+      std::uniform_real_distribution<float> pos{ -2.0f, extent + 2.0f };
+      std::uniform_real_distribution<float> dir{ -8.0f, 8.0f };
+      for(size_t count : { size_t(1000), size_t(10000) }) {
+        std::vector<SpatialQuery::Raycast> rays;
+        for(size_t i = 0; i < count; ++i) {
+          const glm::vec2 start{ pos(gen), pos(gen) };
+          rays.push_back(SpatialQuery::Raycast{ start, start + glm::vec2{ dir(gen), dir(gen) } });
+        }
+
+        auto measure = [](auto&& fn) {
+          const auto begin = std::chrono::steady_clock::now();
+          for(size_t i = 0; i < FRAMES; ++i) {
+            fn();
+          }
+          return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin);
+        };
+        std::vector<std::vector<SpatialQuery::RaycastResult>> single(count);
+        const auto singleTime = measure([&] {
+          for(size_t i = 0; i < count; ++i) {
+            single[i].clear();
+            immediate->raycast(rays[i], all, single[i]);
+          }
+        });
+        SpatialQuery::BatchRaycastResults batch;
+        const auto batchTime = measure([&] {
+          immediate->raycast(rays, all, batch);
+        });
+
+        //Rays grazing a corner may land differently between the packet kernel and the narrowphase
+        size_t hitCount = 0;
+        size_t mismatches = 0;
+        for(size_t i = 0; i < count; ++i) {
+          const SpatialQuery::RaycastResult* batchHit = batch.tryGetFirstHit(i);
+          if(single[i].empty() != !batchHit) {
+            ++mismatches;
+          }
+          else if(batchHit) {
+            Assert::AreEqual(single[i].front().point.x, batchHit->point.x, 0.001f);
+            Assert::AreEqual(single[i].front().point.y, batchHit->point.y, 0.001f);
+            ++hitCount;
+          }
+        }
+        Assert::IsTrue(hitCount > 0);
+        Assert::IsTrue(mismatches <= count/1000);
+        Logger::WriteMessage(std::format("{} rays against {} fragments over {} frames with {} hits: single {}us batch {}us\n",
+          count,
+          SIDE*SIDE,
+          FRAMES,
+          hitCount,
+          singleTime.count(),
+          batchTime.count()
+        ).c_str());
+      }
+    }
+  };
+}
@@ -13,10 +13,12 @@
 #include "ConstraintSolver.h"
 #include "TestApp.h"
 #include "Physics.h"
+#include "PhysicsLOD.h"
 #include "Dynamics.h"
 #include <module/MassModule.h>
 #include <module/PhysicsEvents.h>
 #include <TestGame.h>
+#include <random>
 #include <PhysicsTableBuilder.h>
 #include <math/AxisFlags.h>
 #include <TableName.h>
@@ -38,9 +40,10 @@ namespace Test {
         : dynamicBodies{ task.query<DynamicTag>()[0] }
         , staticBodies{ task.query<StaticTag>()[0] }
         , spatialPairs{ task.query<SP::ManifoldRow>()[0] }
+        , regions{ task.query<PhysicsLOD::RegionOfInterestRow>()[0] }
       {}
 
-      TableID dynamicBodies, staticBodies, spatialPairs;
+      TableID dynamicBodies, staticBodies, spatialPairs, regions;
     };
 
     static StorageTableBuilder createDynamicTable() {
@@ -66,17 +69,26 @@ namespace Test {
       return table;
     }
 
+    static StorageTableBuilder createRegionTable() {
+      StorageTableBuilder table;
+      Transform::addTransform2D(table);
+      table.setStable().addRows<PhysicsLOD::RegionOfInterestRow>().setTableName({ "c" });
+      return table;
+    }
+
     struct TestModule : IAppModule {
       void createDatabase(RuntimeDatabaseArgs& args) final {
         createDynamicTable().finalize(args);
         createStaticTable().finalize(args);
+        createRegionTable().finalize(args);
       }
     };
 
     struct SolverApp : TestGame {
-      SolverApp()
+      SolverApp(Config::PhysicsConfig physics = {})
         : TestGame{
             GameConstructArgs{
+              .physics = std::move(physics),
               .modules = gnx::Container::makeVector<std::unique_ptr<IAppModule>>(std::make_unique<TestModule>())
             }
           }
@@ -253,6 +265,367 @@ namespace Test {
       Assert::IsTrue(relativeVelocity > 0.0f, L"Objects should be separating if they were overlapping");
     }
 
+    static size_t countSleepingPairs(RuntimeDatabaseTaskBuilder& task) {
+      size_t result{};
+      for(uint8_t isSleeping : task.query<const SP::IsSleepingRow>().get<0>(0)) {
+        result += isSleeping ? 1 : 0;
+      }
+      return result;
+    }
+
+    static Config::PhysicsConfig createSleepConfig(size_t frames) {
+      Config::PhysicsConfig result;
+      result.sleep.frames = frames;
+      return result;
+    }
+
+    TEST_METHOD(IslandSleep) {
+      constexpr size_t SLEEP_FRAMES = 5;
+      SolverApp app{ createSleepConfig(SLEEP_FRAMES) };
+      auto& task = app.builder();
+      const TableIds tables{ task };
+      auto [dvx, dvy] = task.query<VelX, VelY>(tables.dynamicBodies).get(0);
+      auto ids = task.getIDResolver();
+      auto res = ids->getRefResolver();
+      Transform::Resolver transforms{ task, Transform::ResolveOps{}.addWrite() };
+
+      app.createInTable(tables.staticBodies);
+      const ElementRef dynamicB = app.createInTable(tables.dynamicBodies);
+      app.update();
+      const size_t ib = res.uncheckedUnpack(dynamicB).getElementIndex();
+      //Resting against the static body, slightly overlapping so there is a contact
+      Transform::PackedTransform dyt = transforms.resolve(dynamicB);
+      dyt.tx = -0.99f;
+      transforms.write(dynamicB, dyt);
+      app.update();
+      Assert::AreEqual(size_t(0), countSleepingPairs(task), L"Island should start awake");
+
+      for(size_t i = 0; i < SLEEP_FRAMES*4; ++i) {
+        app.update();
+      }
+      Assert::AreEqual(size_t(1), countSleepingPairs(task), L"Resting island should fall asleep");
+
+      //Any velocity written to a sleeping body wakes the island no matter how small
+      dvy->at(ib) = 0.001f;
+      app.update();
+      Assert::AreEqual(size_t(0), countSleepingPairs(task), L"Small velocity should wake the island");
+
+      for(size_t i = 0; i < SLEEP_FRAMES*4; ++i) {
+        app.update();
+      }
+      Assert::AreEqual(size_t(1), countSleepingPairs(task));
+
+      //Moving the body directly without changing its pairs also wakes it so the manifold isn't left stale
+      dyt = transforms.resolve(dynamicB);
+      dyt.ty += 0.1f;
+      transforms.write(dynamicB, dyt);
+      app.update();
+      Assert::AreEqual(size_t(0), countSleepingPairs(task), L"Teleport should wake the island");
+
+      for(size_t i = 0; i < SLEEP_FRAMES*4; ++i) {
+        app.update();
+      }
+      Assert::AreEqual(size_t(1), countSleepingPairs(task));
+      const float restingX = transforms.resolve(dynamicB).tx;
+
+      //Impulse away from the static body should wake the island and move the body
+      dvx->at(ib) = -0.5f;
+      app.update();
+      Assert::AreEqual(size_t(0), countSleepingPairs(task), L"Impulse should wake the island");
+      Assert::IsTrue(transforms.resolve(dynamicB).tx < restingX);
+    }
+
+    //A body without any pairs is an island of one node that has no solver bodies
+    TEST_METHOD(IslandSleepSingleBody) {
+      constexpr size_t SLEEP_FRAMES = 5;
+      SolverApp app{ createSleepConfig(SLEEP_FRAMES) };
+      auto& task = app.builder();
+      const TableIds tables{ task };
+      VelX& dvx = task.query<VelX>(tables.dynamicBodies).get<0>(0);
+      auto ids = task.getIDResolver();
+      auto res = ids->getRefResolver();
+      Transform::Resolver transforms{ task, Transform::ResolveOps{}.addWrite() };
+
+      const ElementRef body = app.createInTable(tables.dynamicBodies);
+      app.update();
+      const size_t i = res.uncheckedUnpack(body).getElementIndex();
+
+      //Below the sleep velocity so it falls asleep and stops rather than drifting forever
+      dvx.at(i) = 0.001f;
+      for(size_t f = 0; f < SLEEP_FRAMES*2; ++f) {
+        app.update();
+      }
+      Assert::AreEqual(0.0f, dvx.at(i), L"Single body island should fall asleep");
+      const float restingX = transforms.resolve(body).tx;
+
+      dvx.at(i) = 0.001f;
+      app.update();
+      Assert::IsTrue(transforms.resolve(body).tx > restingX, L"Velocity should wake the single body island");
+    }
+
+    //Immobile bounds are only recomputed for transforms flagged as updated, which writing through the resolver does
+    TEST_METHOD(MovedImmobileBounds) {
+      SolverApp app;
+      auto& task = app.builder();
+      const TableIds tables{ task };
+      Transform::Resolver transforms{ task, Transform::ResolveOps{}.addWrite() };
+      auto spatial = SpatialQuery::createReader(task);
+
+      const ElementRef staticA = app.createInTable(tables.staticBodies);
+      const ElementRef dynamicB = app.createInTable(tables.dynamicBodies);
+      app.update();
+      Transform::PackedTransform dyt = transforms.resolve(dynamicB);
+      dyt.tx = 5.99f;
+      transforms.write(dynamicB, dyt);
+      app.update();
+      spatial->begin(dynamicB);
+      Assert::IsNull(spatial->tryIterate(), L"Bodies should start far apart");
+
+      Transform::PackedTransform st = transforms.resolve(staticA);
+      st.tx = 5.0f;
+      transforms.write(staticA, st);
+      app.update();
+      spatial->begin(dynamicB);
+      const SpatialQuery::Result* hit = spatial->tryIterate();
+      Assert::IsNotNull(hit, L"Moved static body should be found at its new location");
+      Assert::IsTrue(hit->other == staticA);
+    }
+
+    TEST_METHOD(LevelOfDetail) {
+      Config::PhysicsConfig config;
+      config.linearDragMultiplier = 1.0f;
+      config.lod.enabled = true;
+      config.lod.reducedDistance = 10.0f;
+      config.lod.frozenDistance = 20.0f;
+      config.lod.reducedInterval = 4;
+      SolverApp app{ config };
+      auto& task = app.builder();
+      const TableIds tables{ task };
+      auto [dvx, dvy, dva] = task.query<VelX, VelY, VelA>(tables.dynamicBodies).get(0);
+      auto res = task.getIDResolver()->getRefResolver();
+      Transform::Resolver transforms{ task, Transform::ResolveOps{}.addWrite() };
+      auto getX = [&](const ElementRef& e) { return transforms.resolve(e).tx; };
+      auto setX = [&](const ElementRef& e, float x) {
+        Transform::PackedTransform t = transforms.resolve(e);
+        t.tx = x;
+        transforms.write(e, t);
+      };
+
+      const ElementRef region = app.createInTable(tables.regions);
+      const ElementRef full = app.createInTable(tables.dynamicBodies);
+      const ElementRef reduced = app.createInTable(tables.dynamicBodies);
+      const ElementRef frozen = app.createInTable(tables.dynamicBodies);
+      app.update();
+      setX(reduced, 15.0f);
+      setX(frozen, 30.0f);
+      //Let the islands from all of them starting on top of each other split up
+      app.update();
+      app.update();
+      for(const ElementRef& e : { full, reduced, frozen }) {
+        const size_t i = res.uncheckedUnpack(e).getElementIndex();
+        dvx->at(i) = 0.1f;
+        dvy->at(i) = dva->at(i) = 0.0f;
+      }
+      const float fullStart = getX(full);
+      const float reducedStart = getX(reduced);
+      const float frozenStart = getX(frozen);
+
+      constexpr size_t FRAMES = 8;
+      size_t reducedSteps{};
+      for(size_t i = 0; i < FRAMES; ++i) {
+        const float before = getX(reduced);
+        app.update();
+        reducedSteps += getX(reduced) != before ? 1 : 0;
+      }
+
+      Assert::AreEqual(0.8f, getX(full) - fullStart, E, L"Nearby body should step every tick");
+      Assert::AreEqual(FRAMES / config.lod.reducedInterval, reducedSteps, L"Reduced body should only step every interval");
+      const float reducedMoved = getX(reduced) - reducedStart;
+      Assert::IsTrue(reducedMoved >= 0.5f - E && reducedMoved <= 0.8f + E, L"Reduced steps should include the skipped ticks");
+      Assert::AreEqual(frozenStart, getX(frozen), L"Frozen body shouldn't move");
+      Assert::AreEqual(0.1f, dvx->at(res.uncheckedUnpack(frozen).getElementIndex()), E, L"Frozen body should keep its velocity");
+      const PhysicsLOD::Stats* stats = task.query<const PhysicsLOD::StatsRow>().tryGetSingletonElement();
+      Assert::AreEqual(uint32_t(1), stats->full);
+      Assert::AreEqual(uint32_t(1), stats->reduced);
+      Assert::AreEqual(uint32_t(1), stats->frozen);
+
+      //Moving the region of interest to the frozen body promotes it back to full rate with its old velocity
+      setX(region, frozenStart);
+      app.update();
+      Assert::AreEqual(frozenStart + 0.1f, getX(frozen), E);
+      Assert::AreEqual(uint32_t(1), stats->full);
+      Assert::AreEqual(uint32_t(1), stats->frozen, L"Body near the old region should be frozen now");
+    }
+
+    //With damping the velocity differs on every skipped tick, so a reduced body should end up where a full one does
+    TEST_METHOD(LevelOfDetailDamped) {
+      Config::PhysicsConfig config;
+      config.linearDragMultiplier = 0.8f;
+      config.lod.enabled = true;
+      config.lod.reducedDistance = 10.0f;
+      config.lod.frozenDistance = 100.0f;
+      config.lod.reducedInterval = 4;
+      SolverApp app{ config };
+      auto& task = app.builder();
+      const TableIds tables{ task };
+      auto [dvx, dvy, dva] = task.query<VelX, VelY, VelA>(tables.dynamicBodies).get(0);
+      auto res = task.getIDResolver()->getRefResolver();
+      Transform::Resolver transforms{ task, Transform::ResolveOps{}.addWrite() };
+      auto getX = [&](const ElementRef& e) { return transforms.resolve(e).tx; };
+      auto setX = [&](const ElementRef& e, float x) {
+        Transform::PackedTransform t = transforms.resolve(e);
+        t.tx = x;
+        transforms.write(e, t);
+      };
+
+      app.createInTable(tables.regions);
+      const ElementRef full = app.createInTable(tables.dynamicBodies);
+      const ElementRef reduced = app.createInTable(tables.dynamicBodies);
+      app.update();
+      setX(reduced, 15.0f);
+      auto setVelocity = [&](float x) {
+        for(const ElementRef& e : { full, reduced }) {
+          const size_t i = res.uncheckedUnpack(e).getElementIndex();
+          dvx->at(i) = x;
+          dvy->at(i) = dva->at(i) = 0.0f;
+        }
+      };
+      //Stop whatever motion came from them starting on top of each other and let a whole interval pass so nothing is pending
+      setVelocity(0.0f);
+      for(size_t i = 0; i < config.lod.reducedInterval; ++i) {
+        app.update();
+      }
+      setVelocity(1.0f);
+      const float fullStart = getX(full);
+      const float reducedStart = getX(reduced);
+
+      size_t reducedSteps{};
+      for(size_t i = 0; i < 8; ++i) {
+        const float before = getX(reduced);
+        app.update();
+        if(getX(reduced) != before) {
+          ++reducedSteps;
+          Assert::AreEqual(getX(full) - fullStart, getX(reduced) - reducedStart, E, L"Reduced step should cover the damped motion of the skipped ticks");
+        }
+      }
+      Assert::AreEqual(size_t(2), reducedSteps);
+    }
+
+    //Grid of bodies slightly overlapping so every neighbor has a contact
+    static void createPile(SolverApp& app, size_t sideCount) {
+      auto& task = app.builder();
+      const TableIds tables{ task };
+      Transform::Resolver transforms{ task, Transform::ResolveOps{}.addWrite() };
+      std::vector<ElementRef> bodies;
+      {
+        NotifyingTableModifier modifier{ task, tables.dynamicBodies };
+        const ElementRef* added = modifier.addElements(sideCount*sideCount);
+        bodies.assign(added, added + sideCount*sideCount);
+      }
+      app.update();
+      for(size_t x = 0; x < sideCount; ++x) {
+        for(size_t y = 0; y < sideCount; ++y) {
+          const ElementRef& body = bodies[x*sideCount + y];
+          Transform::PackedTransform t = transforms.resolve(body);
+          t.tx = static_cast<float>(x)*0.99f;
+          t.ty = static_cast<float>(y)*0.99f;
+          transforms.write(body, t);
+        }
+      }
+      app.update();
+    }
+
+    //Pile of resting bodies that all fall asleep, compared against the same pile with sleeping disabled
+    static std::chrono::nanoseconds runRestingPile(size_t sleepFrames, size_t sideCount, size_t frames, size_t& sleepingPairs) {
+      SolverApp app{ createSleepConfig(sleepFrames) };
+      auto& task = app.builder();
+      createPile(app, sideCount);
+
+      const auto start = std::chrono::steady_clock::now();
+      for(size_t i = 0; i < frames; ++i) {
+        app.update();
+      }
+      const auto result = std::chrono::steady_clock::now() - start;
+      sleepingPairs = countSleepingPairs(task);
+      return result;
+    }
+
+    TEST_METHOD(IslandSleep_RestingPileBenchmark) {
+      constexpr size_t SIDE = 20;
+      constexpr size_t FRAMES = 200;
+      constexpr size_t SLEEP_FRAMES = 60;
+      size_t awakePairs{}, sleepingPairs{};
+      const auto awake = runRestingPile(0, SIDE, FRAMES, awakePairs);
+      const auto sleeping = runRestingPile(SLEEP_FRAMES, SIDE, FRAMES, sleepingPairs);
+
+      Assert::AreEqual(size_t(0), awakePairs, L"Nothing should sleep when disabled");
+      Assert::IsTrue(sleepingPairs > 0, L"Resting pile should fall asleep");
+      Logger::WriteMessage(std::format("Resting pile of {} bodies over {} frames: awake {}ms sleeping {}ms\n",
+        SIDE*SIDE,
+        FRAMES,
+        std::chrono::duration_cast<std::chrono::milliseconds>(awake).count(),
+        std::chrono::duration_cast<std::chrono::milliseconds>(sleeping).count()
+      ).c_str());
+    }
+
+    //Pile pushed towards its center so every contact has work to do, solved with either the scalar or wide solver
+    static std::chrono::nanoseconds runPushedPile(bool wide, size_t sideCount, size_t frames, std::vector<float>& velocities) {
+      Config::PhysicsConfig config;
+      config.wideSolver = wide;
+      SolverApp app{ config };
+      createPile(app, sideCount);
+      auto& task = app.builder();
+      const TableIds tables{ task };
+      auto [dvx, dvy, dva] = task.query<VelX, VelY, VelA>(tables.dynamicBodies).get(0);
+      const float center = static_cast<float>(sideCount)*0.5f;
+      for(size_t i = 0; i < dvx->size(); ++i) {
+        const float x = static_cast<float>(i / sideCount);
+        const float y = static_cast<float>(i % sideCount);
+        dvx->at(i) = (center - x)*0.01f;
+        dvy->at(i) = (center - y)*0.01f;
+      }
+
+      const auto start = std::chrono::steady_clock::now();
+      for(size_t i = 0; i < frames; ++i) {
+        app.update();
+      }
+      const auto result = std::chrono::steady_clock::now() - start;
+      velocities.clear();
+      for(size_t i = 0; i < dvx->size(); ++i) {
+        velocities.push_back(dvx->at(i));
+        velocities.push_back(dvy->at(i));
+        velocities.push_back(dva->at(i));
+      }
+      return result;
+    }
+
+    TEST_METHOD(WideSolver_MatchesScalarInScene) {
+      constexpr size_t SIDE = 10;
+      constexpr size_t FRAMES = 3;
+      std::vector<float> expected, actual;
+      runPushedPile(false, SIDE, FRAMES, expected);
+      runPushedPile(true, SIDE, FRAMES, actual);
+      Assert::AreEqual(expected.size(), actual.size());
+      for(size_t i = 0; i < expected.size(); ++i) {
+        //Fused multiply adds in the kernel compound over the frames so this is looser than the single range comparison
+        Assert::AreEqual(expected[i], actual[i], 0.001f + std::abs(expected[i])*0.001f);
+      }
+    }
+
+    TEST_METHOD(WideSolver_SceneBenchmark) {
+      constexpr size_t SIDE = 40;
+      constexpr size_t FRAMES = 100;
+      std::vector<float> velocities;
+      const auto scalar = runPushedPile(false, SIDE, FRAMES, velocities);
+      const auto wide = runPushedPile(true, SIDE, FRAMES, velocities);
+      Logger::WriteMessage(std::format("Pushed pile of {} bodies over {} frames: scalar {}ms wide {}ms\n",
+        SIDE*SIDE,
+        FRAMES,
+        std::chrono::duration_cast<std::chrono::milliseconds>(scalar).count(),
+        std::chrono::duration_cast<std::chrono::milliseconds>(wide).count()
+      ).c_str());
+    }
+
     TEST_METHOD(TwoBodiesLinearVelocity) {
       using namespace PGS;
       SolverStorage storage;
@@ -341,6 +714,233 @@ namespace Test {
       assertSolved();
     }
 
+    //Random constraints between bodies where body zero has infinite mass like in ConstraintSolver
+    struct ColoringScene {
+      ColoringScene(PGS::BodyIndex bodyCount, size_t constraintCount, uint32_t seed)
+        : bodies{ bodyCount } {
+        std::mt19937 gen{ seed };
+        std::uniform_int_distribution<PGS::BodyIndex> body{ 0, bodyCount - 1 };
+        std::uniform_real_distribution<float> value{ -1.0f, 1.0f };
+        while(pairs.size() < constraintCount) {
+          const PGS::BodyIndex a = body(gen);
+          const PGS::BodyIndex b = body(gen);
+          if(a != b && b != 0) {
+            pairs.emplace_back(a, b);
+            normals.push_back(glm::normalize(glm::vec2{ value(gen), value(gen) } + glm::vec2{ 0.01f }));
+          }
+        }
+        for(PGS::BodyIndex i = 0; i < bodyCount; ++i) {
+          velocities.emplace_back(value(gen), value(gen));
+        }
+      }
+
+      PGS::BodyIndex bodies{};
+      std::vector<std::pair<PGS::BodyIndex, PGS::BodyIndex>> pairs;
+      std::vector<glm::vec2> normals;
+      std::vector<glm::vec2> velocities;
+    };
+
+    //Constraint i is created from the scene's pair at order[i], or pair i if there is no order
+    static void fillSceneStorage(PGS::SolverStorage& storage, const ColoringScene& scene, const uint32_t* order) {
+      using namespace PGS;
+      storage.resize(scene.bodies, static_cast<ConstraintIndex>(scene.pairs.size()));
+      storage.setUniformMass(1, 1);
+      storage.setMass(0, 0, 0);
+      storage.setUniformLambdaBounds(0, SolverStorage::UNLIMITED_MAX);
+      for(BodyIndex i = 1; i < scene.bodies; ++i) {
+        storage.setVelocity(i, scene.velocities[i], 0);
+      }
+      for(size_t c = 0; c < scene.pairs.size(); ++c) {
+        const size_t source = order ? order[c] : c;
+        const auto [a, b] = scene.pairs[source];
+        const glm::vec2& n = scene.normals[source];
+        storage.setJacobian(static_cast<ConstraintIndex>(c), a, b, n, 0.1f, -n, -0.1f);
+        storage.setBias(static_cast<ConstraintIndex>(c), 0.1f);
+      }
+      storage.config.maxIterations = 10;
+      storage.config.maxLambda = 0.0f;
+      storage.premultiply();
+    }
+
+    //Solves the constraints in colored batches, distributing the batches of each color across the given number of threads
+    static std::vector<float> solveColored(const ColoringScene& scene, const PGS::BatchColoring& coloring, size_t threadCount) {
+      using namespace PGS;
+      SolverStorage storage;
+      //Constraints are stored in the colored order so each batch is a contiguous range
+      fillSceneStorage(storage, scene, coloring.order.data());
+
+      SolveContext context{ storage.createContext() };
+      SolveResult result;
+      do {
+        for(size_t color = 0; color < coloring.colorCount(); ++color) {
+          const size_t firstBatch = coloring.colorBegins[color];
+          const size_t endBatch = coloring.colorBegins[color + 1];
+          std::vector<float> threadErrors(threadCount);
+          std::vector<std::thread> threads;
+          for(size_t t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&, t] {
+              for(size_t batch = firstBatch + t; batch < endBatch; batch += threadCount) {
+                const SolveResult r = advancePGS(context, coloring.batchBegins[batch], coloring.batchBegins[batch + 1]);
+                threadErrors[t] = std::max(threadErrors[t], r.remainingError);
+              }
+            });
+          }
+          for(std::thread& thread : threads) {
+            thread.join();
+          }
+          for(float error : threadErrors) {
+            result.remainingError = std::max(result.remainingError, error);
+          }
+        }
+        advanceIteration(context, result);
+      } while(!result.isFinished);
+
+      std::vector<float> output = storage.bodies.velocity;
+      output.insert(output.end(), storage.constraints.lambda.begin(), storage.constraints.lambda.end());
+      return output;
+    }
+
+    static void assertColoringIsValid(const ColoringScene& scene, const PGS::BatchColoring& coloring) {
+      Assert::AreEqual(scene.pairs.size(), coloring.order.size());
+      Assert::AreEqual(scene.pairs.size(), coloring.batchBegins.back());
+      Assert::AreEqual(coloring.batchCount(), coloring.colorBegins.back());
+      std::vector<bool> seen(scene.pairs.size());
+      for(uint32_t i : coloring.order) {
+        Assert::IsFalse(seen[i], L"Each constraint should appear once");
+        seen[i] = true;
+      }
+      //No dynamic body may be used twice within a color, except in the serially solved overflow color
+      for(size_t color = 0; color < std::min(coloring.colorCount(), PGS::BatchColoring::MAX_COLORS); ++color) {
+        std::vector<bool> used(scene.bodies);
+        const size_t begin = coloring.batchBegins[coloring.colorBegins[color]];
+        const size_t end = coloring.batchBegins[coloring.colorBegins[color + 1]];
+        for(size_t c = begin; c < end; ++c) {
+          const auto [a, b] = scene.pairs[coloring.order[c]];
+          for(PGS::BodyIndex body : { a, b }) {
+            if(body) {
+              Assert::IsFalse(used[body], L"Constraints of the same color should not share a dynamic body");
+              used[body] = true;
+            }
+          }
+        }
+      }
+    }
+
+    TEST_METHOD(ColoredBatches_NoSharedBodies) {
+      const ColoringScene scene{ 500, 3000, 3 };
+      PGS::BatchColoring coloring;
+      PGS::colorBatches(coloring, scene.pairs.data(), scene.pairs.size(), scene.bodies, 100, 0);
+
+      assertColoringIsValid(scene, coloring);
+      Assert::IsTrue(coloring.colorCount() < PGS::BatchColoring::MAX_COLORS, L"Random scene should fit in the available colors");
+      Assert::IsTrue(coloring.batchCount() > coloring.colorCount(), L"Colors should be split into multiple batches");
+    }
+
+    TEST_METHOD(ColoredBatches_Overflow) {
+      //Every constraint shares body 1 so each needs its own color until they run out
+      ColoringScene scene{ 200, 0, 0 };
+      for(PGS::BodyIndex i = 2; i < scene.bodies; ++i) {
+        scene.pairs.emplace_back(1, i);
+      }
+      PGS::BatchColoring coloring;
+      PGS::colorBatches(coloring, scene.pairs.data(), scene.pairs.size(), scene.bodies, 100, 0);
+
+      assertColoringIsValid(scene, coloring);
+      Assert::AreEqual(PGS::BatchColoring::MAX_COLORS + 1, coloring.colorCount());
+      const size_t overflowColor = PGS::BatchColoring::MAX_COLORS;
+      Assert::AreEqual(size_t(1), coloring.colorBegins[overflowColor + 1] - coloring.colorBegins[overflowColor], L"Overflow should be a single batch");
+    }
+
+    TEST_METHOD(ColoredBatches_DeterministicAcrossThreadCounts) {
+      const ColoringScene scene{ 500, 3000, 7 };
+      PGS::BatchColoring coloring;
+      PGS::colorBatches(coloring, scene.pairs.data(), scene.pairs.size(), scene.bodies, 50, 0);
+
+      const std::vector<float> expected = solveColored(scene, coloring, 1);
+      for(size_t threads : { 2, 3, 8 }) {
+        Assert::IsTrue(expected == solveColored(scene, coloring, threads), L"Result should be identical regardless of thread count");
+      }
+    }
+
+    //Solves all constraints as a single range, either one row at a time or grouped into independent rows
+    static std::vector<float> solveRange(const ColoringScene& scene, bool wide, std::chrono::nanoseconds* elapsed = nullptr) {
+      using namespace PGS;
+      SolverStorage storage;
+      fillSceneStorage(storage, scene, nullptr);
+      SolveContext context{ storage.createContext() };
+      const auto start = std::chrono::steady_clock::now();
+      IndependentRows rows;
+      if(wide) {
+        std::vector<uint32_t> bodyLevels(scene.bodies);
+        groupIndependentRows(rows, context, 0, context.constraints, bodyLevels);
+      }
+      SolveResult result;
+      do {
+        result = wide ? advancePGSWide(context, rows) : advancePGS(context, 0, context.constraints);
+        advanceIteration(context, result);
+      } while(!result.isFinished);
+      if(elapsed) {
+        *elapsed = std::chrono::steady_clock::now() - start;
+      }
+
+      std::vector<float> output = storage.bodies.velocity;
+      output.insert(output.end(), storage.constraints.lambda.begin(), storage.constraints.lambda.end());
+      return output;
+    }
+
+    TEST_METHOD(IndependentRows_LevelsPreserveOrder) {
+      const ColoringScene scene{ 100, 1000, 11 };
+      PGS::SolverStorage storage;
+      fillSceneStorage(storage, scene, nullptr);
+      PGS::SolveContext context{ storage.createContext() };
+      PGS::IndependentRows rows;
+      std::vector<uint32_t> bodyLevels(scene.bodies);
+      PGS::groupIndependentRows(rows, context, 0, context.constraints, bodyLevels);
+
+      Assert::AreEqual(scene.pairs.size(), rows.rows.size());
+      Assert::IsTrue(std::all_of(bodyLevels.begin(), bodyLevels.end(), [](uint32_t l) { return l == 0; }), L"Scratch should be cleared");
+      std::vector<int64_t> lastRow(scene.bodies, -1);
+      std::vector<uint32_t> usedInLevel(scene.bodies, std::numeric_limits<uint32_t>::max());
+      for(uint32_t level = 0; level < rows.levelCount(); ++level) {
+        for(uint32_t r = rows.levelBegins[level]; r < rows.levelBegins[level + 1]; ++r) {
+          const PGS::ConstraintIndex row = rows.rows[r];
+          const auto [a, b] = scene.pairs[row];
+          for(PGS::BodyIndex body : { a, b }) {
+            //Body zero has infinite mass and may be shared
+            if(body) {
+              Assert::AreNotEqual(level, usedInLevel[body], L"Rows of a level should not share a dynamic body");
+              Assert::IsTrue(lastRow[body] < static_cast<int64_t>(row), L"Rows of a body should stay in their original order");
+              usedInLevel[body] = level;
+              lastRow[body] = row;
+            }
+          }
+        }
+      }
+    }
+
+    TEST_METHOD(WideSolver_MatchesScalar) {
+      const ColoringScene scene{ 300, 2000, 5 };
+      const std::vector<float> expected = solveRange(scene, false);
+      const std::vector<float> actual = solveRange(scene, true);
+      Assert::AreEqual(expected.size(), actual.size());
+      for(size_t i = 0; i < expected.size(); ++i) {
+        //Same operations in the same order, only allowing for the compiler choosing to contract into fused multiply adds
+        Assert::AreEqual(expected[i], actual[i], 0.0001f + std::abs(expected[i])*0.0001f);
+      }
+    }
+
+    TEST_METHOD(WideSolver_Benchmark) {
+      const ColoringScene scene{ 20000, 60000, 13 };
+      std::chrono::nanoseconds scalar{}, wide{};
+      solveRange(scene, false, &scalar);
+      solveRange(scene, true, &wide);
+      Logger::WriteMessage(std::format("{} rows over 10 iterations: scalar {}us wide {}us\n",
+        scene.pairs.size(),
+        std::chrono::duration_cast<std::chrono::microseconds>(scalar).count(),
+        std::chrono::duration_cast<std::chrono::microseconds>(wide).count()
+      ).c_str());
+    }
+
     TEST_METHOD(LargeCounts) {
       using namespace PGS;
       SolverStorage storage;
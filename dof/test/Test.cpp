@@ -766,8 +766,8 @@ namespace Test {
     size_t trackedCellPairs(const Broadphase::SweepGrid::Grid& grid, size_t cellIndex) {
       const Broadphase::Sweep2D& cell = grid.cells[cellIndex];
       return std::count_if(grid.pairs.trackedPairs.begin(), grid.pairs.trackedPairs.end(), [&](const auto& pair) {
-        return cell.containedKeys.count(Broadphase::BroadphaseKey{ pair.a }) &&
-          cell.containedKeys.count(Broadphase::BroadphaseKey{ pair.b });
+        return cell.containedKeys.contains(pair.first.a) &&
+          cell.containedKeys.contains(pair.first.b);
       });
     }
 
@@ -1190,6 +1190,30 @@ namespace Test {
       Assert::AreEqual(size_t(0), cmd->size());
     }
 
+    //Fragments that collide with nothing, like those seeking home, are still pushed by area forces
+    TEST_METHOD(GlobalPointForceWithoutCollisionMask) {
+      GameArgs args;
+      args.fragmentCount = 1;
+      GameConstructArgs construct;
+      TestStatInfo test;
+      construct.updateConfig.injectGameplayTasks = addGlobalPointForce(test);
+      TestGame game{ std::move(construct) };
+      game.init(args);
+
+      auto [fragmentTransform, fvx, mask] = game.builder().query<Transform::WorldTransformRow, VelX, Narrowphase::CollisionMaskRow>(game.tables.fragments).get(0);
+      fragmentTransform->at(0).tx = 5.f;
+      mask->at(0) = Narrowphase::CollisionMask(0);
+
+      test.shouldRun = true;
+      game.update();
+      test.shouldRun = false;
+      game.update();
+      game.update();
+      game.update();
+
+      Assert::IsTrue(fvx->at(0) > 0.0f);
+    }
+
     TEST_METHOD(Config) {
       GameConfig gameConfig;
       gameConfig.fragment.fragmentColumns = 5;
@@ -1302,6 +1326,68 @@ namespace Test {
       Assert::IsNull(reader->tryIterate());
     }
 
+    TEST_METHOD(ImmediateSpatialQueries) {
+      GameArgs args;
+      args.fragmentCount = 1;
+      TestGame game{ args };
+      auto [fs, objTransforms] = game.builder().query<StableIDRow, Transform::WorldTransformRow>(game.tables.fragments).get(0);
+      const ElementRef objID = fs->at(0);
+      const Narrowphase::CollisionMask all = Narrowphase::CollisionMask(~0);
+      auto immediate = SpatialQuery::createImmediate(game.builder());
+      std::vector<SpatialQuery::Result> overlaps;
+      std::vector<SpatialQuery::RaycastResult> hits;
+      auto overlapsObject = [&] {
+        return std::any_of(overlaps.begin(), overlaps.end(), [&](const SpatialQuery::Result& r) { return r.other == objID; });
+      };
+      auto hitsObject = [&] {
+        return std::any_of(hits.begin(), hits.end(), [&](const SpatialQuery::RaycastResult& r) { return r.id == objID; });
+      };
+
+      //Results are available as soon as the broadphase has seen the object, no query elements involved
+      objTransforms->at(0).setPos(glm::vec2{ 2.5f });
+      game.update();
+      immediate->overlap({ SpatialQuery::AABB{ glm::vec2(2.0f), glm::vec2(3.5f) } }, all, overlaps);
+      Assert::IsTrue(overlapsObject());
+      overlaps.clear();
+      immediate->overlap({ SpatialQuery::Circle{ glm::vec2(0, 5), 1.5f } }, all, overlaps);
+      Assert::IsFalse(overlapsObject());
+      immediate->raycast(SpatialQuery::Raycast{ glm::vec2(-1.0f), glm::vec2(2.0f, -1.0f) }, all, hits);
+      Assert::IsFalse(hitsObject());
+
+      objTransforms->at(0).setPos(glm::vec2(2.f, -1.f));
+      game.update();
+      immediate->overlap({ SpatialQuery::Circle{ glm::vec2(2, -1), 0.5f } }, all, overlaps);
+      Assert::IsTrue(overlapsObject());
+      immediate->raycast(SpatialQuery::Raycast{ glm::vec2(-1.0f), glm::vec2(2.0f, -1.0f) }, all, hits);
+      Assert::IsTrue(hitsObject());
+      //Hit is on the near side of the object
+      Assert::IsTrue(hits.front().point.x < 2.0f);
+      //Normal is the outward normal of the face that was hit, facing back towards the ray
+      Assert::AreEqual(-1.0f, hits.front().normal.x, 0.001f);
+      Assert::AreEqual(0.0f, hits.front().normal.y, 0.001f);
+
+      //Batched rays find the same first hit as casting them one at a time
+      const std::array batch{
+        SpatialQuery::Raycast{ glm::vec2(5.0f), glm::vec2(6.0f) },
+        SpatialQuery::Raycast{ glm::vec2(-1.0f), glm::vec2(2.0f, -1.0f) }
+      };
+      SpatialQuery::BatchRaycastResults batchHits;
+      immediate->raycast(batch, all, batchHits);
+      Assert::IsNull(batchHits.tryGetFirstHit(0));
+      const SpatialQuery::RaycastResult* firstHit = batchHits.tryGetFirstHit(1);
+      Assert::IsNotNull(firstHit);
+      Assert::IsTrue(firstHit->id == objID);
+      Assert::AreEqual(hits.front().point.x, firstHit->point.x, 0.001f);
+      Assert::AreEqual(hits.front().point.y, firstHit->point.y, 0.001f);
+      Assert::AreEqual(hits.front().normal.x, firstHit->normal.x, 0.001f);
+      Assert::AreEqual(hits.front().normal.y, firstHit->normal.y, 0.001f);
+
+      //Objects without a matching mask bit are skipped
+      hits.clear();
+      immediate->raycast(SpatialQuery::Raycast{ glm::vec2(-1.0f), glm::vec2(2.0f, -1.0f) }, Narrowphase::CollisionMask(0), hits);
+      Assert::IsTrue(hits.empty());
+    }
+
     TEST_METHOD(CollisionMasks) {
       GameArgs args;
       args.fragmentCount = 2;